@@ -0,0 +1,106 @@
+#include "ConnectionMetrics.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <numeric>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace ::sqlite_wrapper;
+
+// Measures the overhead that ConnectionMetrics adds to every operation: constructing and destroying a Scope,
+// alone and nested in an outer one (as the statements of a transaction are), on one thread and on threads
+// sharing the same metrics, as the threads sharing a Connection do. Reports ns per scope, the fastest of a few
+// repetitions so that preemptions don't count, and fails if any is over the budget.
+//
+// Usage: connection_metrics_bench [iterations] [threads] [budget ns]
+
+namespace
+{
+
+using Clock = std::chrono::steady_clock;
+
+// Returns the mean cost of a scope, in ns, over the threads; each thread times its own scopes, so the threads
+// must not outnumber the cores
+double run(int threadCount, std::size_t iterations, bool nested)
+{
+    ConnectionMetrics metrics;
+    std::vector<double> costs(static_cast<std::size_t>(threadCount));
+
+    const auto body = [&metrics, &costs, iterations, nested](std::size_t thread) {
+        std::optional<ConnectionMetrics::Scope> outer;
+        if (nested)
+        {
+            outer.emplace(metrics, ConnectionMetrics::Operation::BeginTransaction);
+        }
+
+        const auto start = Clock::now();
+        for (std::size_t i = 0; i < iterations; ++i)
+        {
+            ConnectionMetrics::Scope scope{metrics, ConnectionMetrics::Operation::Insert};
+            scope.rows(1);
+        }
+
+        costs[thread] = std::chrono::duration<double, std::nano>(Clock::now() - start).count()
+                        / static_cast<double>(iterations);
+    };
+
+    std::vector<std::thread> threads;
+    for (auto i = 1; i < threadCount; ++i)
+    {
+        threads.emplace_back(body, static_cast<std::size_t>(i));
+    }
+    body(0);
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+
+    return std::accumulate(costs.begin(), costs.end(), 0.0) / static_cast<double>(threadCount);
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    constexpr int kRepetitions = 10;
+
+    // more threads than cores would time each other's scopes
+    const auto cores = static_cast<int>(std::max(std::thread::hardware_concurrency(), 1u));
+
+    const std::size_t iterations = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1000000;
+    const int threadCount        = std::min(argc > 2 ? std::atoi(argv[2]) : 4, cores);
+    const double budgetNs        = argc > 3 ? std::strtod(argv[3], nullptr) : 50.0;
+
+    // calibrates CycleClock, once per process, outside of the measurements
+    run(1, 1000, false);
+
+    auto overBudget = false;
+    for (const auto threads : {1, threadCount})
+    {
+        for (const auto nested : {false, true})
+        {
+            auto ns = run(threads, iterations, nested);
+            for (auto i = 1; i < kRepetitions; ++i)
+            {
+                ns = std::min(ns, run(threads, iterations, nested));
+            }
+            overBudget = overBudget || ns > budgetNs;
+
+            const auto name = std::string(nested ? "nested scope" : "scope") + ", " + std::to_string(threads)
+                              + (threads == 1 ? " thread" : " threads");
+            std::printf("%-24s %8.1f ns/scope %s\n", name.c_str(), ns, ns <= budgetNs ? "" : "(over budget)");
+        }
+    }
+
+    if (overBudget)
+    {
+        std::printf("over the budget of %.1f ns/scope\n", budgetNs);
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
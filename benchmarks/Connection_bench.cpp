@@ -0,0 +1,519 @@
+#include "Connection.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <fstream>
+#include <functional>
+#include <future>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace ::sqlite_wrapper;
+
+// Measures the latency and throughput of every IConnection operation, across table sizes, thread counts,
+// a single shared Connection vs one Connection per thread, and autocommit vs explicit transactions.
+//
+// Usage: sqlite_wrapper_bench [--sizes=1000,...] [--threads=1,...] [--operations=select,...] [--ops=N]
+//                             [--options=default|durable|throughput] [--json=path]
+//
+// Each thread runs --ops operations per case. In transaction mode, they are grouped in transactions of
+// kOperationsPerTransaction operations; per-operation latencies exclude begin and commit, which are only
+// accounted for in the throughput. Results are printed, and written as JSON to --json.
+
+namespace
+{
+
+using Clock = std::chrono::steady_clock;
+
+const char* kTable                             = "bench_table";
+const std::size_t kBuckets                     = 1000; // count/sum/average/aggregate scan one bucket, via an index
+const std::size_t kRowsPerInsert               = 100;  // rows per insert(table, Rows) call
+const std::size_t kOperationsPerTransaction    = 100;
+const std::vector<std::size_t> kDefaultSizes   = {1000, 10000, 100000, 1000000, 10000000};
+const std::vector<std::size_t> kDefaultThreads = {1, 4, 16, 64};
+
+// reads first, so that they run on tables of the nominal size; writes then change it by a few rows per case
+const std::vector<std::string> kOperations
+    = {"select", "count", "sum", "average", "aggregate", "update", "insert", "insertRows", "delete"};
+
+struct Settings
+{
+    std::vector<std::size_t> sizes{kDefaultSizes};
+    std::vector<std::size_t> threads{kDefaultThreads};
+    std::vector<std::string> operations{kOperations};
+    std::size_t operationsPerThread{100};
+    std::string options{"throughput"};
+    std::string jsonPath{"sqlite_wrapper_bench.json"};
+};
+
+struct Case
+{
+    std::string operation;
+    std::size_t tableRows;
+    std::size_t threads;
+    bool multipleConnections;
+    bool transaction;
+};
+
+struct Result
+{
+    Case benchmark;
+    std::size_t operations{0};
+    std::size_t errors{0};
+    double seconds{0.0};
+    double operationsPerSecond{0.0};
+    double meanNs{0.0};
+    std::int64_t p50Ns{0};
+    std::int64_t p90Ns{0};
+    std::int64_t p99Ns{0};
+    std::int64_t maxNs{0};
+};
+
+// Runs one operation; the thread's random generator and index, and the operation index, pick its arguments
+using Operation = std::function<void(IConnection& connection, std::mt19937_64& random, std::size_t thread,
+                                     std::size_t index, bool transaction)>;
+
+template<typename T>
+std::vector<T> parseList(const std::string& text, const std::function<T(const std::string&)>& parse)
+{
+    std::vector<T> values;
+    std::istringstream stream{text};
+    std::string token;
+    while (std::getline(stream, token, ','))
+    {
+        if (!token.empty())
+        {
+            values.emplace_back(parse(token));
+        }
+    }
+
+    return values;
+}
+
+Settings parseArguments(int argc, char** argv)
+{
+    Settings settings;
+
+    const auto toSize   = [](const std::string& token) { return std::strtoull(token.c_str(), nullptr, 10); };
+    const auto toString = [](const std::string& token) { return token; };
+
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string argument{argv[i]};
+        const auto separator = argument.find('=');
+        const auto key       = argument.substr(0, separator);
+        const auto value     = separator == std::string::npos ? std::string{} : argument.substr(separator + 1);
+
+        if (key == "--sizes")
+        {
+            settings.sizes = parseList<std::size_t>(value, toSize);
+        }
+        else if (key == "--threads")
+        {
+            settings.threads = parseList<std::size_t>(value, toSize);
+        }
+        else if (key == "--operations")
+        {
+            settings.operations = parseList<std::string>(value, toString);
+        }
+        else if (key == "--ops")
+        {
+            settings.operationsPerThread = std::max<std::size_t>(toSize(value), 1);
+        }
+        else if (key == "--options")
+        {
+            settings.options = value;
+        }
+        else if (key == "--json")
+        {
+            settings.jsonPath = value;
+        }
+        else
+        {
+            std::cerr << "Unknown argument: " << argument << std::endl;
+            std::exit(EXIT_FAILURE);
+        }
+    }
+
+    return settings;
+}
+
+ConnectionOptions connectionOptions(const std::string& name)
+{
+    if (name == "durable")
+    {
+        return ConnectionOptions::Durable();
+    }
+
+    if (name == "throughput")
+    {
+        return ConnectionOptions::Throughput();
+    }
+
+    return {};
+}
+
+std::string databasePath(std::size_t tableRows)
+{
+    return "sqlite_wrapper_bench_" + std::to_string(tableRows) + ".db";
+}
+
+void removeDatabase(const std::string& path)
+{
+    std::remove(path.c_str());
+    std::remove((path + "-wal").c_str());
+    std::remove((path + "-shm").c_str());
+    std::remove((path + "-journal").c_str());
+}
+
+void fillTable(Connection& connection, std::size_t rowCount)
+{
+    connection.applySql("DROP TABLE IF EXISTS bench_table;");
+    connection.applySql("CREATE TABLE bench_table (id INTEGER PRIMARY KEY, bucket INTEGER, real REAL, string TEXT);");
+
+    // generated by SQLite itself, so that 10M rows do not have to be materialized first
+    connection.applySql("WITH RECURSIVE ids(id) AS (SELECT 1 UNION ALL SELECT id + 1 FROM ids WHERE id < "
+                        + std::to_string(rowCount)
+                        + ") INSERT INTO bench_table SELECT id, id % " + std::to_string(kBuckets)
+                        + ", id * 0.5, 'string value number ' || id FROM ids;");
+    connection.applySql("CREATE INDEX bench_table_bucket ON bench_table(bucket);");
+}
+
+Operation makeOperation(const std::string& name, std::size_t tableRows, const std::vector<PrimaryKeys>& deletable)
+{
+    const auto randomId = [tableRows](std::mt19937_64& random) {
+        return static_cast<PrimaryKey>(random() % tableRows + 1);
+    };
+    const auto randomBucket = [](std::mt19937_64& random) { return static_cast<std::int64_t>(random() % kBuckets); };
+
+    if (name == "select")
+    {
+        return [=](IConnection& connection, std::mt19937_64& random, std::size_t, std::size_t, bool) {
+            connection.select(kTable, KeyValues{{"id", randomId(random)}});
+        };
+    }
+
+    if (name == "count")
+    {
+        return [=](IConnection& connection, std::mt19937_64& random, std::size_t, std::size_t, bool) {
+            connection.count(kTable, KeyValues{{"bucket", randomBucket(random)}});
+        };
+    }
+
+    if (name == "sum")
+    {
+        return [=](IConnection& connection, std::mt19937_64& random, std::size_t, std::size_t, bool) {
+            connection.sum(kTable, "real", KeyValues{{"bucket", randomBucket(random)}});
+        };
+    }
+
+    if (name == "average")
+    {
+        return [=](IConnection& connection, std::mt19937_64& random, std::size_t, std::size_t, bool) {
+            connection.average(kTable, "real", KeyValues{{"bucket", randomBucket(random)}});
+        };
+    }
+
+    if (name == "aggregate")
+    {
+        // the work of count, sum and average, fused into one statement
+        return [=](IConnection& connection, std::mt19937_64& random, std::size_t, std::size_t, bool) {
+            KeyValues filters{{"bucket", randomBucket(random)}};
+            connection.aggregate(kTable, {Count(), Sum("real"), Avg("real")}, filters);
+        };
+    }
+
+    if (name == "update")
+    {
+        return [=](IConnection& connection, std::mt19937_64& random, std::size_t, std::size_t index, bool transaction) {
+            connection.update(kTable, {{"real", static_cast<double>(index)}}, {{"id", randomId(random)}}, transaction);
+        };
+    }
+
+    if (name == "insert")
+    {
+        return [=](IConnection& connection, std::mt19937_64& random, std::size_t, std::size_t, bool transaction) {
+            KeyValues keyValues{{"bucket", randomBucket(random)}, {"real", 0.5}, {"string", "inserted"}};
+            connection.insert(kTable, keyValues, transaction);
+        };
+    }
+
+    if (name == "insertRows")
+    {
+        return [=](IConnection& connection, std::mt19937_64& random, std::size_t, std::size_t, bool transaction) {
+            Rows rows;
+            rows.reserve(kRowsPerInsert);
+            for (std::size_t i = 0; i < kRowsPerInsert; ++i)
+            {
+                rows.emplace_back(Row{std::nullopt, std::to_string(randomBucket(random)), "0.5", "inserted"});
+            }
+
+            connection.insert(kTable, rows, transaction);
+        };
+    }
+
+    if (name == "delete")
+    {
+        // each thread deletes rows inserted for it beforehand, so that the table does not shrink across cases
+        return [&deletable](IConnection& connection,
+                            std::mt19937_64&,
+                            std::size_t thread,
+                            std::size_t index,
+                            bool transaction) {
+            connection.deleteRows(kTable, {{"id", deletable[thread][index]}}, transaction);
+        };
+    }
+
+    std::cerr << "Unknown operation: " << name << std::endl;
+    std::exit(EXIT_FAILURE);
+}
+
+Result run(const Case& benchmark, const Settings& settings)
+{
+    const auto path    = databasePath(benchmark.tableRows);
+    const auto options = connectionOptions(settings.options);
+
+    std::vector<std::unique_ptr<Connection>> connections;
+    for (std::size_t i = 0; i < (benchmark.multipleConnections ? benchmark.threads : 1); ++i)
+    {
+        auto& connection = connections.emplace_back(std::make_unique<Connection>(path, options));
+        if (!connection->open())
+        {
+            std::exit(EXIT_FAILURE);
+        }
+    }
+
+    std::vector<PrimaryKeys> deletable(benchmark.threads);
+    if (benchmark.operation == "delete")
+    {
+        Rows rows(settings.operationsPerThread, Row{std::nullopt, "0", "0.5", "to delete"});
+        for (auto& keys : deletable)
+        {
+            keys = connections[0]->insert(kTable, rows, false);
+        }
+    }
+
+    const auto operation = makeOperation(benchmark.operation, benchmark.tableRows, deletable);
+
+    std::vector<std::vector<std::int64_t>> latencies(benchmark.threads);
+    std::vector<std::size_t> errors(benchmark.threads, 0);
+
+    std::promise<void> go;
+    auto started = go.get_future().share();
+
+    std::vector<std::thread> threads;
+    for (std::size_t t = 0; t < benchmark.threads; ++t)
+    {
+        threads.emplace_back([&, t] {
+            auto& connection = *connections[benchmark.multipleConnections ? t : 0];
+            std::mt19937_64 random{t + 1};
+            latencies[t].reserve(settings.operationsPerThread);
+
+            started.wait();
+
+            for (std::size_t i = 0; i < settings.operationsPerThread; i += kOperationsPerTransaction)
+            {
+                const auto end = std::min(i + kOperationsPerTransaction, settings.operationsPerThread);
+                auto index     = i;
+
+                try
+                {
+                    if (benchmark.transaction)
+                    {
+                        connection.beginTransaction(true);
+                    }
+
+                    for (; index < end; ++index)
+                    {
+                        const auto start = Clock::now();
+                        operation(connection, random, t, index, benchmark.transaction);
+                        latencies[t].emplace_back(
+                            std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count());
+                    }
+
+                    if (benchmark.transaction)
+                    {
+                        connection.commitTransaction();
+                    }
+                }
+                catch (const sqlite::sqlite_exception&)
+                {
+                    // e.g. SQLITE_BUSY between connections: the rest of the batch is abandoned,
+                    // and in transaction mode, the operations already run are rolled back
+                    errors[t] += benchmark.transaction ? end - i : end - index;
+                    if (benchmark.transaction)
+                    {
+                        try
+                        {
+                            connection.rollbackTransaction();
+                        }
+                        catch (const sqlite::sqlite_exception&)
+                        {
+                        }
+                    }
+                }
+            }
+        });
+    }
+
+    const auto start = Clock::now();
+    go.set_value();
+
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+
+    Result result;
+    result.benchmark = benchmark;
+    result.seconds   = std::chrono::duration<double>(Clock::now() - start).count();
+
+    std::vector<std::int64_t> all;
+    for (std::size_t t = 0; t < benchmark.threads; ++t)
+    {
+        all.insert(all.end(), latencies[t].cbegin(), latencies[t].cend());
+        result.errors += errors[t];
+    }
+
+    result.operations = all.size();
+    if (all.empty())
+    {
+        return result;
+    }
+
+    std::sort(all.begin(), all.end());
+
+    double total = 0.0;
+    for (auto latency : all)
+    {
+        total += static_cast<double>(latency);
+    }
+
+    const auto percentile = [&all](double p) { return all[static_cast<std::size_t>(p * (all.size() - 1))]; };
+
+    result.operationsPerSecond = result.seconds > 0 ? result.operations / result.seconds : 0.0;
+    result.meanNs              = total / all.size();
+    result.p50Ns               = percentile(0.50);
+    result.p90Ns               = percentile(0.90);
+    result.p99Ns               = percentile(0.99);
+    result.maxNs               = all.back();
+    return result;
+}
+
+void print(const Result& result)
+{
+    const auto& benchmark = result.benchmark;
+    std::printf("%-10s %9zu rows %3zu threads %-8s %-11s %12.0f ops/s  p50 %9.1f us  p99 %9.1f us  errors %zu\n",
+                benchmark.operation.c_str(),
+                benchmark.tableRows,
+                benchmark.threads,
+                benchmark.multipleConnections ? "multiple" : "single",
+                benchmark.transaction ? "transaction" : "autocommit",
+                result.operationsPerSecond,
+                result.p50Ns / 1000.0,
+                result.p99Ns / 1000.0,
+                result.errors);
+    std::fflush(stdout);
+}
+
+void writeJson(const std::string& path, const Settings& settings, const std::vector<Result>& results)
+{
+    std::ofstream json{path};
+
+    char date[32];
+    const auto now = std::time(nullptr);
+    std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", std::localtime(&now));
+
+    json << "{\n";
+    json << "  \"context\": {\n";
+    json << "    \"date\": \"" << date << "\",\n";
+    json << "    \"sqlite_version\": \"" << sqlite3_libversion() << "\",\n";
+    json << "    \"hardware_concurrency\": " << std::thread::hardware_concurrency() << ",\n";
+    json << "    \"connection_options\": \"" << settings.options << "\",\n";
+    json << "    \"operations_per_thread\": " << settings.operationsPerThread << ",\n";
+    json << "    \"operations_per_transaction\": " << kOperationsPerTransaction << ",\n";
+    json << "    \"rows_per_insert_rows\": " << kRowsPerInsert << "\n";
+    json << "  },\n";
+    json << "  \"benchmarks\": [";
+
+    for (std::size_t i = 0; i < results.size(); ++i)
+    {
+        const auto& result    = results[i];
+        const auto& benchmark = result.benchmark;
+
+        json << (i == 0 ? "\n" : ",\n");
+        json << "    {\"operation\": \"" << benchmark.operation << "\", \"table_rows\": " << benchmark.tableRows
+             << ", \"threads\": " << benchmark.threads << ", \"connections\": \""
+             << (benchmark.multipleConnections ? "multiple" : "single") << "\", \"mode\": \""
+             << (benchmark.transaction ? "transaction" : "autocommit") << "\", \"operations\": " << result.operations
+             << ", \"errors\": " << result.errors << ", \"seconds\": " << result.seconds
+             << ", \"operations_per_second\": " << result.operationsPerSecond << ", \"latency_ns\": {\"mean\": "
+             << result.meanNs << ", \"p50\": " << result.p50Ns << ", \"p90\": " << result.p90Ns
+             << ", \"p99\": " << result.p99Ns << ", \"max\": " << result.maxNs << "}}";
+    }
+
+    json << "\n  ]\n}\n";
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    const auto settings = parseArguments(argc, argv);
+
+    std::vector<Result> results;
+
+    for (auto tableRows : settings.sizes)
+    {
+        const auto path = databasePath(tableRows);
+        removeDatabase(path);
+
+        {
+            Connection connection(path, connectionOptions(settings.options));
+            if (!connection.open())
+            {
+                return EXIT_FAILURE;
+            }
+
+            std::cout << "Filling " << tableRows << " rows..." << std::endl;
+            fillTable(connection, std::max<std::size_t>(tableRows, 1));
+        }
+
+        for (const auto& operation : settings.operations)
+        {
+            for (auto threads : settings.threads)
+            {
+                for (auto multipleConnections : {false, true})
+                {
+                    // a single thread cannot use multiple connections
+                    if (multipleConnections && threads == 1)
+                    {
+                        continue;
+                    }
+
+                    for (auto transaction : {false, true})
+                    {
+                        results.emplace_back(
+                            run({operation, tableRows, threads, multipleConnections, transaction}, settings));
+                        print(results.back());
+                    }
+                }
+            }
+        }
+
+        removeDatabase(path);
+    }
+
+    writeJson(settings.jsonPath, settings, results);
+    std::cout << "Results written to " << settings.jsonPath << std::endl;
+
+    return EXIT_SUCCESS;
+}
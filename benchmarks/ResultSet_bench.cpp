@@ -0,0 +1,97 @@
+#include "Connection.hpp"
+#include "ResultSet.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <string>
+
+using namespace ::sqlite_wrapper;
+
+// Compares materializing a large select into Rows, into a ResultSet, and streaming it through a RowCursor.
+//
+// Usage: result_set_bench [rows] [iterations]
+
+namespace
+{
+
+const std::string kDatabasePath = "result_set_bench.db";
+const char* kTable              = "bench_table";
+
+void fillTable(Connection& connection, std::size_t rowCount)
+{
+    connection.applySql("DROP TABLE IF EXISTS bench_table;");
+    connection.applySql("CREATE TABLE bench_table (id INTEGER PRIMARY KEY, number INTEGER, real REAL, string TEXT);");
+
+    Rows rows;
+    rows.reserve(rowCount);
+    for (std::size_t i = 0; i < rowCount; ++i)
+    {
+        auto number = std::to_string(i);
+        rows.emplace_back(Row{number, number, std::to_string(i * 0.5), "string value number " + number});
+    }
+
+    connection.beginTransaction(true);
+    connection.insert(kTable, rows, true);
+    connection.commitTransaction();
+}
+
+void run(const std::string& name, int iterations, const std::function<std::size_t()>& body)
+{
+    using Clock = std::chrono::steady_clock;
+
+    std::size_t rows  = 0;
+    const auto start = Clock::now();
+    for (auto i = 0; i < iterations; ++i)
+    {
+        rows += body();
+    }
+    const auto elapsed = std::chrono::duration<double, std::milli>(Clock::now() - start).count() / iterations;
+
+    std::printf("%-24s %10.2f ms/select %12.0f rows/s\n", name.c_str(), elapsed, rows / iterations / elapsed * 1000);
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    const std::size_t rowCount = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1000000;
+    const int iterations       = argc > 2 ? std::atoi(argv[2]) : 5;
+
+    std::remove(kDatabasePath.c_str());
+    Connection connection(kDatabasePath);
+    if (!connection.open())
+    {
+        return EXIT_FAILURE;
+    }
+
+    std::cout << "Filling " << rowCount << " rows..." << std::endl;
+    fillTable(connection, rowCount);
+
+    run("Rows", iterations, [&] { return connection.select(kTable, {}).size(); });
+
+    ResultSet resultSet;
+    run("ResultSet", iterations, [&] {
+        ResultSet fresh;
+        connection.select(fresh, kTable, {});
+        return fresh.size();
+    });
+    run("ResultSet (reused)", iterations, [&] {
+        connection.select(resultSet, kTable, {});
+        return resultSet.size();
+    });
+
+    run("RowCursor", iterations, [&] {
+        std::size_t rows = 0;
+        for (const auto& row : connection.selectCursor(kTable, {}))
+        {
+            rows += row.size() > 0 ? 1 : 0;
+        }
+        return rows;
+    });
+
+    std::remove(kDatabasePath.c_str());
+    return EXIT_SUCCESS;
+}
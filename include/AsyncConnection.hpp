@@ -0,0 +1,200 @@
+#pragma once
+
+#include "ConnectionOptions.hpp"
+#include "ConnectionPool.hpp"
+#include "SqliteTypes.hpp"
+#include "TaskQueue.hpp"
+
+#include <cstddef>
+#include <future>
+#include <memory>
+#include <optional>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace sqlite_wrapper
+{
+
+/**
+ * @class AsyncConnection
+ * @brief Non-blocking access to an on-disk SQLite database.
+ *
+ * Every operation is queued and returns immediately with a @c std::future for its result, so callers
+ * can pipeline many operations without waiting on locks, busy timeouts or commits. Failures are reported
+ * through the future, as the exception the equivalent @c IConnection call would have thrown.
+ *
+ * Mutations are executed in submission order by a single writer thread, which owns the write connection.
+ * Reads are served concurrently by a pool of reader threads, each using its own reader connection
+ * of an underlying WAL-mode @c ConnectionPool. A read submitted after a write is therefore not guaranteed
+ * to see it, unless the caller waits for the write's future first.
+ *
+ * Transactions are submitted as a whole, through @c transaction(), and also run on the writer thread.
+ */
+class AsyncConnection
+{
+public:
+    static constexpr std::size_t kDefaultReaderThreadCount = ConnectionPool::kDefaultReaderCount;
+
+    AsyncConnection(const std::string& databasePath,
+                    std::size_t readerThreadCount    = kDefaultReaderThreadCount,
+                    const ConnectionOptions& options = {});
+
+    /**
+     * Waits for all queued operations to complete.
+     */
+    ~AsyncConnection();
+
+    const std::string& getDatabasePath() const;
+
+    /**
+     * @brief Open all connections; must be called, and succeed, before submitting operations.
+     * @return True if successful, false otherwise.
+     */
+    bool open();
+    bool isOpen() const;
+
+    std::future<void> applySql(std::string sql);
+    std::future<bool> tableExists(std::string table);
+
+    std::future<Rows> select(std::string table, KeyValues filters = {});
+    std::future<Rows> select(std::string table, std::string col, KeyValues filters = {});
+
+    /**
+     * @brief Select into a caller-provided @c ResultSet, which must be kept alive until the future is ready.
+     */
+    std::future<void> select(ResultSet& result, std::string table, KeyValues filters = {});
+    std::future<void> select(ResultSet& result, std::string table, std::string col, KeyValues filters = {});
+
+    std::future<SqlRows> selectTyped(std::string table, KeyValues filters = {});
+    std::future<SqlRows> selectTyped(std::string table, std::string col, KeyValues filters = {});
+
+    std::future<PrimaryKey> insert(std::string table, KeyValues keyValues);
+    std::future<PrimaryKeys> insert(std::string table, Rows rows);
+    std::future<PrimaryKey> insertOrReplace(std::string table, KeyValues keyValues);
+    std::future<PrimaryKeys> insertOrReplace(std::string table, Rows rows);
+    std::future<PrimaryKey> upsert(std::string table,
+                                   KeyValues keyValues,
+                                   std::vector<std::string> conflictColumns,
+                                   std::vector<std::string> updateColumns);
+    std::future<PrimaryKeys> upsert(std::string table,
+                                    Rows rows,
+                                    std::vector<std::string> conflictColumns,
+                                    std::vector<std::string> updateColumns);
+    std::future<void> update(std::string table, KeyValues keyValues, KeyValues filters = {});
+    std::future<void> deleteRows(std::string table, KeyValues filters = {});
+
+    std::future<std::size_t> count(std::string table, KeyValues filters = {});
+    std::future<std::size_t> count(std::string table, std::string col, KeyValues filters = {});
+    std::future<double> sum(std::string table, std::string col, KeyValues filters = {});
+    std::future<double> average(std::string table, std::string col, KeyValues filters = {});
+    std::future<Rows> select(std::string table, Filter filter);
+    std::future<Rows> select(std::string table, std::string col, Filter filter);
+    std::future<Rows> query(std::string table, QueryOptions options, Filter filter = Filter::All());
+    std::future<Page> queryPage(std::string table,
+                                PageOptions options,
+                                Filter filter                  = Filter::All(),
+                                std::optional<PageToken> after = std::nullopt);
+    std::future<void> update(std::string table, KeyValues keyValues, Filter filter);
+    std::future<void> deleteRows(std::string table, Filter filter);
+    std::future<std::size_t> count(std::string table, Filter filter);
+    std::future<std::size_t> count(std::string table, std::string col, Filter filter);
+    std::future<double> sum(std::string table, std::string col, Filter filter);
+    std::future<double> average(std::string table, std::string col, Filter filter);
+
+    std::future<SqlRow> aggregate(std::string table, Aggregates aggregates, KeyValues filters = {});
+    std::future<SqlRows>
+    aggregate(std::string table, std::vector<std::string> groupBy, Aggregates aggregates, KeyValues filters = {});
+
+    /**
+     * @brief Run a function inside a transaction, on the writer thread.
+     * @param function Called with the connection to use; operations on it must pass @c transaction = true.
+     * @param enableForeignKeys Whether to enable foreign key constraints.
+     * @return The result of @arg function.
+     *
+     * The transaction is committed when @arg function returns, or rolled back if it throws,
+     * in which case the exception is reported through the future.
+     *
+     * Example:
+     *
+     *    auto key = connection.transaction([](IConnection& db) {
+     *        db.deleteRows("table", {{"id", 1}}, true);
+     *        return db.insert("table", KeyValues{{"id", 1}}, true);
+     *    });
+     */
+    template<typename F>
+    auto transaction(F&& function, bool enableForeignKeys = true)
+        -> std::future<std::invoke_result_t<std::decay_t<F>, IConnection&>>;
+
+    /**
+     * @brief Get the number of operations waiting for the writer thread.
+     */
+    std::size_t pendingWrites() const;
+
+    /**
+     * @brief Get the number of operations waiting for a reader thread.
+     */
+    std::size_t pendingReads() const;
+
+private:
+    template<typename F>
+    static auto enqueue(TaskQueue& queue, F&& function) -> std::future<std::invoke_result_t<std::decay_t<F>>>;
+
+    ConnectionPool mPool;
+    TaskQueue mWriter; // declared after mPool, so queued operations complete before connections close
+    TaskQueue mReaders;
+};
+
+template<typename F>
+auto AsyncConnection::transaction(F&& function, bool enableForeignKeys)
+    -> std::future<std::invoke_result_t<std::decay_t<F>, IConnection&>>
+{
+    using Result = std::invoke_result_t<std::decay_t<F>, IConnection&>;
+
+    return enqueue(mWriter, [this, function = std::forward<F>(function), enableForeignKeys]() mutable -> Result {
+        mPool.beginTransaction(enableForeignKeys);
+
+        try
+        {
+            if constexpr (std::is_void<Result>::value)
+            {
+                function(static_cast<IConnection&>(mPool));
+                mPool.commitTransaction();
+            }
+            else
+            {
+                auto result = function(static_cast<IConnection&>(mPool));
+                mPool.commitTransaction();
+                return result;
+            }
+        }
+        catch (...)
+        {
+            try
+            {
+                mPool.rollbackTransaction();
+            }
+            catch (...)
+            {
+                // report the original failure rather than the rollback one
+            }
+
+            throw;
+        }
+    });
+}
+
+template<typename F>
+auto AsyncConnection::enqueue(TaskQueue& queue, F&& function) -> std::future<std::invoke_result_t<std::decay_t<F>>>
+{
+    using Result = std::invoke_result_t<std::decay_t<F>>;
+
+    // std::function requires a copyable target, while std::packaged_task is move-only
+    auto task   = std::make_shared<std::packaged_task<Result()>>(std::forward<F>(function));
+    auto future = task->get_future();
+    queue.push([task] { (*task)(); });
+    return future;
+}
+
+} // namespace sqlite_wrapper
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "SqliteTypes.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace sqlite_wrapper
+{
+
+/**
+ * @struct BulkLoadOptions
+ * @brief Format of the delimited input of @c Connection::bulkLoad(), and how its rows are inserted.
+ *
+ * Each record is inserted as one row. An empty unquoted field is inserted as NULL, while a quoted one ("")
+ * is inserted as an empty string; all other fields are inserted as text, and converted by the column affinity.
+ */
+struct BulkLoadOptions
+{
+    static constexpr std::size_t kDefaultCommitInterval = 10000;
+
+    char delimiter{','}; // '\t' for TSV
+    char quote{'"'};
+
+    // If true, the first record names the columns to insert into, unless @c columns is also set
+    bool header{false};
+
+    // Columns to insert into, in field order; if empty, fields are inserted in table column order
+    std::vector<std::string> columns;
+
+    ConflictPolicy conflictPolicy{ConflictPolicy::Abort};
+
+    // Number of rows inserted per transaction
+    std::size_t commitInterval{kDefaultCommitInterval};
+};
+
+/**
+ * @struct BulkLoadStats
+ * @brief Outcome of a completed @c Connection::bulkLoad().
+ */
+struct BulkLoadStats
+{
+    std::size_t rows{0};     // records read and inserted, including the ones ignored on conflict
+    std::size_t commits{0};
+    std::chrono::nanoseconds elapsed{};
+    double rowsPerSecond{0.0};
+};
+
+} // namespace sqlite_wrapper
@@ -0,0 +1,110 @@
+#pragma once
+
+#include "sqlite_modern_cpp.h"
+
+#include "ConnectionMetrics.hpp"
+#include "ConnectionOptions.hpp"
+
+#include <sqlite3.h>
+
+#include <chrono>
+#include <optional>
+#include <string>
+
+namespace sqlite_wrapper
+{
+
+/**
+ * @struct BusyWait
+ * @brief An operation waiting for a lock held by another connection, as seen by a @c BusyPolicy.
+ */
+struct BusyWait
+{
+    std::optional<ConnectionMetrics::Operation> operation; // unset outside of operations, e.g. in open()
+    int retries{0};                                        // made so far by the operation, across its statements
+    std::chrono::nanoseconds elapsed{};                    // since the operation started
+};
+
+/**
+ * @class BusyPolicy
+ * @brief Decides, from SQLite's busy handler, whether and when a statement that found the DB locked is retried.
+ *
+ * The busy handler is called, and blocks the calling thread, each time a statement finds the DB locked by
+ * another connection. Once the policy gives up, the statement fails with SQLITE_BUSY, reported by the operation
+ * as a @c BusyTimeoutError.
+ */
+class BusyPolicy
+{
+public:
+    virtual ~BusyPolicy() = default;
+
+    /**
+     * @brief Get how long to wait before the next retry.
+     * @param wait The waiting operation. Called concurrently by the connections sharing the policy.
+     * @return The delay, or std::nullopt to give up.
+     */
+    virtual std::optional<std::chrono::nanoseconds> delay(const BusyWait& wait) = 0;
+};
+
+/**
+ * @class BackoffBusyPolicy
+ * @brief Default @c BusyPolicy: jittered exponential backoff, within a deadline and a retry budget per operation.
+ *
+ * Unlike sqlite3_busy_timeout(), whose timeout restarts with every statement, the deadline is counted from the
+ * start of the operation, so operations running several statements, e.g. inserts of many rows, cannot stall
+ * for several timeouts.
+ */
+class BackoffBusyPolicy : public BusyPolicy
+{
+public:
+    BackoffBusyPolicy(const BusyBackoffOptions& options, std::chrono::milliseconds timeout);
+
+    std::optional<std::chrono::nanoseconds> delay(const BusyWait& wait) override;
+
+private:
+    std::chrono::nanoseconds deadline(const BusyWait& wait) const;
+
+    const BusyBackoffOptions mOptions;
+    const std::chrono::milliseconds mTimeout;
+};
+
+/**
+ * @class BusyTimeoutError
+ * @brief Thrown by an operation whose @c BusyPolicy gave up waiting for another connection's lock.
+ *
+ * Derived from @c sqlite::errors::busy, so that handlers of the SQLITE_BUSY errors that SQLite reports
+ * without waiting, e.g. to avoid a deadlock between transactions, catch it too.
+ */
+class BusyTimeoutError : public sqlite::errors::busy
+{
+public:
+    BusyTimeoutError(const std::string& sql, const BusyWait& wait);
+
+    const BusyWait& wait() const;
+
+    /**
+     * @brief Record that the busy policy of a DB connection gave up, on the calling thread, whose statement
+     * is about to fail with SQLITE_BUSY.
+     */
+    static void GaveUp(sqlite3* db, const BusyWait& wait);
+
+    /**
+     * @brief Forget the give-up recorded on the calling thread, if any; called before each statement, so that one
+     * failing with SQLITE_BUSY without waiting is not reported with the wait of an earlier one.
+     */
+    static void Clear();
+
+    /**
+     * @brief Throw the exception for an SQLite result code: a @c BusyTimeoutError if it is SQLITE_BUSY and
+     * the busy policy of the DB connection just gave up on the calling thread, or else the matching
+     * @c sqlite::sqlite_exception.
+     */
+    [[noreturn]] static void Throw(sqlite3* db, int code, const std::string& sql);
+
+private:
+    static std::string Message(const BusyWait& wait);
+
+    BusyWait mWait;
+};
+
+} // namespace sqlite_wrapper
@@ -0,0 +1,147 @@
+#pragma once
+
+#include "ConnectionOptions.hpp"
+#include "SqliteTypes.hpp"
+
+#include <sqlite3.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <limits>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace sqlite_wrapper
+{
+
+/**
+ * @class ChangeStream
+ * @brief Streams the rows inserted, updated and deleted through a connection, once their transaction commits.
+ *
+ * Changes are reported by sqlite3_update_hook() and held back until their transaction commits, or dropped if
+ * sqlite3_rollback_hook() reports a rollback. As sqlite3_commit_hook() is called before the commit completes, and
+ * the commit may still fail, e.g. with SQLITE_BUSY, the changes it reports are only staged, then published by
+ * @c settle() once the statement that commits returned. Once committed, each change gets
+ * the next sequence number, and is kept in a history of the last @c ChangeStreamOptions::capacity changes.
+ * Consumers either poll the history from the last sequence number they processed, or subscribe to be called
+ * with each change as it commits; either way, they can resume after a restart from a persisted sequence number.
+ *
+ * Like the update hook, the stream does not see changes to WITHOUT ROWID tables, rows deleted to resolve
+ * a REPLACE conflict, nor, unless through @c Connection::deleteRows(), rows deleted all at once.
+ */
+class ChangeStream
+{
+public:
+    struct Change
+    {
+        enum class Operation
+        {
+            Insert,
+            Update,
+            Delete
+        };
+
+        std::uint64_t sequence{0}; // 1 for the first change committed, then increasing by 1
+        std::uint64_t commit{0};   // 1 for the first transaction committed with changes, then increasing by 1
+        Operation operation{Operation::Insert};
+        std::string table;
+        PrimaryKey rowid{0};
+    };
+
+    struct Poll
+    {
+        std::vector<Change> changes;
+        bool missed{false}; // changes following the requested sequence number were dropped from the history
+    };
+
+    using Callback = std::function<void(const Change& change)>;
+
+    explicit ChangeStream(const ChangeStreamOptions& options);
+
+    ChangeStream(const ChangeStream&)            = delete;
+    ChangeStream& operator=(const ChangeStream&) = delete;
+
+    /**
+     * @brief Record a change of the current transaction; called from sqlite3_update_hook().
+     * @param operation SQLITE_INSERT, SQLITE_UPDATE or SQLITE_DELETE.
+     * @param table The table changed.
+     * @param rowid The rowid of the row changed.
+     */
+    void record(int operation, const char* table, sqlite3_int64 rowid);
+
+    /**
+     * @brief Stage the changes of the current transaction, which is committing; called from sqlite3_commit_hook().
+     */
+    void commit();
+
+    /**
+     * @brief Publish the staged changes if their commit succeeded, or else make them pending again, as a failed
+     * commit leaves the transaction active; called once the statement that may have committed returned.
+     * @param committed Whether the commit succeeded, i.e. the connection is back in autocommit mode.
+     */
+    void settle(bool committed);
+
+    /**
+     * @brief Drop the changes of the current transaction, staged or not; called from sqlite3_rollback_hook().
+     */
+    void rollback();
+
+    /**
+     * @brief Get a mark of the changes of the current transaction, to drop those made after it on a partial rollback.
+     */
+    std::size_t savepoint() const;
+    void rollbackTo(std::size_t savepoint);
+
+    /**
+     * @brief Read the committed changes following a sequence number.
+     * @param after The sequence number of the last change already processed, 0 for none.
+     * @param max The maximum number of changes to return.
+     * @return The changes, in commit order, and whether some of the requested ones were dropped from the history.
+     */
+    Poll poll(std::uint64_t after, std::size_t max = std::numeric_limits<std::size_t>::max()) const;
+
+    /**
+     * @brief Get the sequence number of the last change committed, 0 for none.
+     */
+    std::uint64_t lastSequence() const;
+
+    /**
+     * @brief Call a function with every change committed after a sequence number.
+     * @param callback The function; called after the commit, on the committing thread, while that thread holds the
+     *                 connection's write access, so it must neither block nor use the connection, which would
+     *                 deadlock on the write mutex.
+     * @param after The sequence number of the last change already processed; changes after it that are still
+     *              in the history are delivered before this returns.
+     * @return The subscription ID, for @c unsubscribe().
+     */
+    std::uint64_t subscribe(Callback callback, std::uint64_t after);
+    void unsubscribe(std::uint64_t id);
+
+private:
+    struct Subscriber
+    {
+        std::uint64_t id;
+        Callback callback;
+        std::uint64_t delivered; // sequence number of the last change delivered
+    };
+
+    void deliver(Subscriber& subscriber, const std::vector<Change>& changes);
+
+    const ChangeStreamOptions mOptions;
+
+    mutable std::mutex mMutex;
+    std::vector<Change> mPending;    // changes of the current transaction
+    std::vector<Change> mCommitting; // changes of the transaction committing, until its commit returns
+    std::deque<Change> mHistory;  // committed changes, oldest first
+    std::uint64_t mSequence{0};
+    std::uint64_t mCommits{0};
+
+    std::mutex mSubscribersMutex; // held while delivering, so that each subscriber sees changes in order
+    std::vector<Subscriber> mSubscribers;
+    std::uint64_t mNextSubscriberId{1};
+};
+
+} // namespace sqlite_wrapper
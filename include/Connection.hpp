@@ -2,11 +2,36 @@
 
 #include "sqlite_modern_cpp.h"
 
+#include "BulkLoadOptions.hpp"
+#include "BusyPolicy.hpp"
+#include "ChangeStream.hpp"
+#include "ConnectionMetrics.hpp"
+#include "ConnectionOptions.hpp"
+#include "GroupCommit.hpp"
 #include "IConnection.hpp"
+#include "IndexAdvisor.hpp"
+#include "QueryPlan.hpp"
+#include "QueryProfiler.hpp"
+#include "ResultCache.hpp"
+#include "RowMapping.hpp"
+#include "SqliteTraits.hpp"
+#include "StatementCache.hpp"
+#include "Table.hpp"
 #include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <istream>
+#include <limits>
 #include <memory>
 #include <mutex>
+#include <optional>
+#include <ostream>
 #include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
 namespace sqlite_wrapper
 {
@@ -24,27 +49,69 @@ namespace sqlite_wrapper
  * - Transactions and individual writes in the same connection from multiple threads are possible
  *   by protecting any writes (individual operations and full-transaction) with the same mutex.
  * - Between connections where mutex instance are not shared, the concurrency handling is
- *   achieved using sqlite3_busy_timeout().
+ *   achieved using a busy handler, which retries as decided by a @c BusyPolicy: by default, with a jittered
+ *   exponential backoff, until @c ConnectionOptions::busyTimeout after the start of the operation. Operations
+ *   whose policy gives up fail with a @c BusyTimeoutError.
+ *
+ * Open flags and PRAGMAs are configured through @c ConnectionOptions, and applied by @c open().
+ *
+ * Inserting several rows at once runs a single cached INSERT statement, re-bound for each row, so keys are
+ * returned in the order of the rows; every chunk of @c kInsertChunkRows rows is committed atomically.
+ *
+ * Prepared statements are kept in a per-connection @c StatementCache and reused across calls with the same SQL.
+ *
+ * When @c ConnectionOptions::groupCommit is set, non-transactional inserts, updates and deletes issued
+ * concurrently are committed together by a @c GroupCommit, each in its own savepoint, so that a failing write
+ * does not affect the others in its batch.
  */
 class Connection : public IConnection
 {
 public:
-    Connection(const std::string& databasePath);
+    Connection(const std::string& databasePath, const ConnectionOptions& options = {});
 
     const std::string& getDatabasePath() const override;
+    const ConnectionOptions& getOptions() const;
     bool open() override;
     bool isOpen() const override;
     void applySql(const std::string& sql) override;
     bool tableExists(const std::string& table) override;
     void beginTransaction(bool enableForeignKeys) override;
+    void beginTransaction(TransactionMode mode, bool enableForeignKeys) override;
     void commitTransaction() override;
+
+    /**
+     * @brief Commit the current transaction, and call a function once it committed, before the connection's write
+     * access is released; it isn't called if the commit fails, which leaves the transaction active.
+     */
+    void commitTransaction(const std::function<void()>& committed);
+
     void rollbackTransaction() override;
+    void savepoint(const std::string& name) override;
+    void releaseSavepoint(const std::string& name) override;
+    void rollbackToSavepoint(const std::string& name) override;
     Rows select(const std::string& table, const KeyValues& filters) override;
     Rows select(const std::string& table, const std::string& col, const KeyValues& filters) override;
+    void select(ResultSet& result, const std::string& table, const KeyValues& filters) override;
+    void
+    select(ResultSet& result, const std::string& table, const std::string& col, const KeyValues& filters) override;
+    SqlRows selectTyped(const std::string& table, const KeyValues& filters) override;
+    SqlRows selectTyped(const std::string& table, const std::string& col, const KeyValues& filters) override;
+    RowCursor selectCursor(const std::string& table, const KeyValues& filters) override;
+    RowCursor selectCursor(const std::string& table, const std::string& col, const KeyValues& filters) override;
     PrimaryKey insert(const std::string& table, const KeyValues& keyValues, bool transaction) override;
     PrimaryKeys insert(const std::string& table, const Rows& rows, bool transaction) override;
     PrimaryKey insertOrReplace(const std::string& table, const KeyValues& keyValues, bool transaction) override;
     PrimaryKeys insertOrReplace(const std::string& table, const Rows& rows, bool transaction) override;
+    PrimaryKey upsert(const std::string& table,
+                      const KeyValues& keyValues,
+                      const std::vector<std::string>& conflictColumns,
+                      const std::vector<std::string>& updateColumns,
+                      bool transaction) override;
+    PrimaryKeys upsert(const std::string& table,
+                       const Rows& rows,
+                       const std::vector<std::string>& conflictColumns,
+                       const std::vector<std::string>& updateColumns,
+                       bool transaction) override;
     void
     update(const std::string& table, const KeyValues& keyValues, const KeyValues& filters, bool transaction) override;
     void deleteRows(const std::string& table, const KeyValues& filters, bool transaction) override;
@@ -52,23 +119,442 @@ public:
     std::size_t count(const std::string& table, const std::string& col, const KeyValues& filters) override;
     double sum(const std::string& table, const std::string& col, const KeyValues& filters) override;
     double average(const std::string& table, const std::string& col, const KeyValues& filters) override;
+    Rows select(const std::string& table, const Filter& filter) override;
+    Rows select(const std::string& table, const std::string& col, const Filter& filter) override;
+    Rows query(const std::string& table, const QueryOptions& options, const Filter& filter) override;
+    Page queryPage(const std::string& table,
+                   const PageOptions& options,
+                   const Filter& filter,
+                   const std::optional<PageToken>& after) override;
+    void update(const std::string& table, const KeyValues& keyValues, const Filter& filter, bool transaction) override;
+    void deleteRows(const std::string& table, const Filter& filter, bool transaction) override;
+    std::size_t count(const std::string& table, const Filter& filter) override;
+    std::size_t count(const std::string& table, const std::string& col, const Filter& filter) override;
+    double sum(const std::string& table, const std::string& col, const Filter& filter) override;
+    double average(const std::string& table, const std::string& col, const Filter& filter) override;
+    SqlRow aggregate(const std::string& table, const Aggregates& aggregates, const KeyValues& filters) override;
+    SqlRows aggregate(const std::string& table,
+                      const std::vector<std::string>& groupBy,
+                      const Aggregates& aggregates,
+                      const KeyValues& filters) override;
+
+    /**
+     * @brief Insert the records of delimited text (CSV, TSV, ...) into a table, as they are read.
+     * @param table The table to insert into.
+     * @param input The delimited text; see @c BulkLoadOptions for its format.
+     * @param options The input format, conflict policy and commit interval.
+     * @param transaction True if called within a transaction of the calling thread, see @c beginTransaction().
+     * @return The number of rows loaded, and the load rate.
+     *
+     * Records are streamed from @arg input and bound to a single prepared INSERT statement, so memory use does
+     * not depend on the input size. Every @c BulkLoadOptions::commitInterval rows are inserted in their own
+     * transaction, during which the connection's other writers wait. Within the caller's transaction, which
+     * holds the connection's write lock already, each batch is a savepoint instead, committed with the caller's
+     * transaction; calling with @arg transaction false from within it would deadlock.
+     *
+     * If a record cannot be parsed or inserted, the transaction, or savepoint, of its batch is rolled back and the
+     * exception rethrown, while the batches inserted before remain. Parse errors are thrown as @c std::runtime_error.
+     */
+    BulkLoadStats bulkLoad(const std::string& table,
+                           std::istream& input,
+                           const BulkLoadOptions& options = {},
+                           bool transaction               = false);
+
+    /**
+     * @brief Insert the records of a delimited text file into a table, as they are read.
+     * @param path The file to read; a @c std::runtime_error is thrown if it cannot be opened.
+     *
+     * See the @c std::istream overload.
+     */
+    BulkLoadStats bulkLoad(const std::string& table,
+                           const std::string& path,
+                           const BulkLoadOptions& options = {},
+                           bool transaction               = false);
+
+    /**
+     * @brief Get a snapshot of the per-operation latencies and counters, and of the lock wait times.
+     * @return The connection metrics, accumulated since construction.
+     */
+    ConnectionMetrics::Stats stats() const;
+
+    /**
+     * @brief Get a snapshot of the prepared-statement cache counters.
+     * @return The cache statistics.
+     */
+    StatementCache::Stats statementCacheStats() const;
+
+    /**
+     * @brief Get a snapshot of the group commit counters.
+     * @return The group commit statistics, or std::nullopt if group commit is not enabled.
+     */
+    std::optional<GroupCommit::Stats> groupCommitStats() const;
+
+    /**
+     * @brief Get a snapshot of the statement profiling counters.
+     * @return The profiler statistics, or std::nullopt if profiling is not enabled.
+     */
+    std::optional<QueryProfiler::Stats> profilerStats() const;
+
+    /**
+     * @brief Get the slow-query log.
+     * @return The most recent slow statements, oldest first; empty if profiling is not enabled.
+     */
+    std::vector<QueryProfiler::Entry> slowQueries() const;
+
+    /**
+     * @brief Write the slow-query log, one statement per line, oldest first.
+     */
+    void dumpSlowQueries(std::ostream& out) const;
+
+    /**
+     * @brief Get the plan SQLite would use for @c select(table, filters).
+     * @param table The target table.
+     * @param filters The target filters, if any.
+     * @return The plan, telling e.g. whether the table is scanned, or searched through an index.
+     */
+    QueryPlan explain(const std::string& table, const KeyValues& filters = {});
+    QueryPlan explain(const std::string& table, const Filter& filter);
+
+    /**
+     * @brief Get the plan SQLite would use for a statement.
+     */
+    QueryPlan explain(const ParameterizedSql& sql);
+
+    /**
+     * @brief Get the indexes recommended by the index advisor.
+     * @return The recommended indexes, the most needed first; empty if the advisor is not enabled.
+     */
+    std::vector<IndexAdvisor::Advice> indexAdvice() const;
+
+    /**
+     * @brief Create the indexes recommended by the index advisor, and start over advising.
+     * @return The number of indexes created.
+     */
+    std::size_t createAdvisedIndexes();
+
+    /**
+     * @brief Get a snapshot of the result cache counters.
+     * @return The result cache statistics, or std::nullopt if result caching is not enabled.
+     */
+    std::optional<ResultCache::Stats> resultCacheStats() const;
+
+    /**
+     * @brief Drop all cached results, and reset the result cache counters.
+     */
+    void clearResultCache();
+
+    /**
+     * @brief Read the changes committed through this connection after a sequence number.
+     * @param after The sequence number of the last change already processed, 0 for none.
+     * @param max The maximum number of changes to return.
+     * @return The changes, in commit order; empty if the change stream is not enabled.
+     */
+    ChangeStream::Poll
+    pollChanges(std::uint64_t after, std::size_t max = std::numeric_limits<std::size_t>::max()) const;
+
+    /**
+     * @brief Call a function with every change committed through this connection after a sequence number.
+     * @param callback The function; called after the commit, on the committing thread, while that thread holds this
+     *                 connection's write access, so it must neither block nor use this connection, which would
+     *                 deadlock on the write mutex.
+     * @param after The sequence number of the last change already processed; 0 replays all changes kept.
+     * @return The subscription ID, for @c unsubscribeChanges().
+     *
+     * Throws a @c std::runtime_error if the change stream is not enabled.
+     */
+    std::uint64_t subscribeChanges(ChangeStream::Callback callback, std::uint64_t after = 0);
+    void unsubscribeChanges(std::uint64_t id);
+
+    /**
+     * @brief Insert a row into a table with a compile-time schema.
+     * @tparam TTable The table, deriving from @c Table.
+     * @param row The column values, in the order the table lists its columns.
+     * @param transaction Set to true if the operation is part of a transaction.
+     * @return The primary key of the row inserted.
+     */
+    template<typename TTable>
+    PrimaryKey insert(const typename TTable::Row& row, bool transaction = false);
+
+    /**
+     * @brief Select the rows of a table with a compile-time schema, matching every column of @arg where.
+     * @tparam TTable The table, deriving from @c Table.
+     * @tparam TResult @c TTable::Row, or a struct with a member per column, in the order the table lists them.
+     * @param where The columns to filter on, and their values; every row if empty.
+     * @return The rows selected.
+     */
+    template<typename TTable, typename TResult = typename TTable::Row, typename... TWhere>
+    std::vector<TResult> select(const Where<TWhere...>& where = {});
+
+    /**
+     * @brief Update the rows of a table with a compile-time schema, matching every column of @arg where.
+     * @tparam TTable The table, deriving from @c Table.
+     * @param set The columns to update, and their new values.
+     * @param where The columns to filter on, and their values; every row if empty.
+     * @param transaction Set to true if the operation is part of a transaction.
+     * @return The number of rows updated.
+     */
+    template<typename TTable, typename... TSet, typename... TWhere>
+    std::uint64_t update(const Set<TSet...>& set, const Where<TWhere...>& where, bool transaction = false);
+
+    /**
+     * @brief Delete the rows of a table with a compile-time schema, matching every column of @arg where.
+     * @tparam TTable The table, deriving from @c Table.
+     * @param where The columns to filter on, and their values; every row if empty.
+     * @param transaction Set to true if the operation is part of a transaction.
+     * @return The number of rows deleted.
+     */
+    template<typename TTable, typename... TWhere>
+    std::uint64_t deleteRows(const Where<TWhere...>& where, bool transaction = false);
+
+    /**
+     * @brief Select rows into structs declared by @c RowMapping<T>, reading each column straight into its member.
+     * @param table The target table.
+     * @param filters The target filters, if any.
+     * @return The structs read, one per row.
+     */
+    template<typename T, typename = std::enable_if_t<kHasRowMapping<T>>>
+    std::vector<T> select(const std::string& table, const KeyValues& filters = {});
+    template<typename T, typename = std::enable_if_t<kHasRowMapping<T>>>
+    std::vector<T> select(const std::string& table, const Filter& filter);
+
+    /**
+     * @brief Insert structs declared by @c RowMapping<T>, binding each member straight to its column.
+     * @param table The target table.
+     * @param values The structs to insert, in a single transaction unless already part of one.
+     * @param transaction Set to true if the operation is part of a transaction.
+     * @return The primary keys of the rows inserted, in order.
+     */
+    template<typename T, typename = std::enable_if_t<kHasRowMapping<T>>>
+    PrimaryKeys insert(const std::string& table, const std::vector<T>& values, bool transaction = false);
 
 private:
-    void connectionHook();
+    static constexpr int kReturningMinVersion     = 3035000; // first SQLite release supporting RETURNING
+    static constexpr std::size_t kInsertChunkRows = 4096;    // rows of insert(table, Rows) committed at once
+
+    bool connectionHook();
+    static int BusyHandler(void* context, int retries);
+    static void UpdateHook(void* context, int operation, const char* database, const char* table, sqlite3_int64 rowid);
+    static void RollbackHook(void* context);
+    static int CommitHook(void* context);
+
+    using Savepoints = std::vector<std::pair<std::string, std::size_t>>;
+
+    static void CheckSavepointName(const std::string& name);
+    static void CheckUpsert(const std::vector<std::string>& conflictColumns,
+                            const std::vector<std::string>& updateColumns);
+    Savepoints::iterator findSavepoint(const std::string& name);
+
+    // report a call to the index advisor, if enabled
+    void
+    adviseIndex(const std::string& table, const std::string& col, const ParameterizedSql& sql, const Filter& filter);
+    void adviseIndex(const std::string& table,
+                     const std::string& col,
+                     const ParameterizedSql& sql,
+                     const KeyValues& filters);
+
+    Statement prepare(const std::string& sql);
+    Statement prepare(const ParameterizedSql& sql);
 
-    void lockWriteAccess(bool partOfTransaction);
+    // return the time spent waiting for the write mutex
+    std::chrono::nanoseconds lockWriteAccess(bool partOfTransaction);
     void unlockWriteAccess(bool partOfTransaction);
+    std::chrono::nanoseconds acquireWriteMutex();
 
-    PrimaryKey insertRow(const std::string& table, const KeyValues& keyValues, bool transaction, bool replace);
+    // read all columns, or the first column, of every result row, or the single value of an aggregate query,
+    // through the result cache if enabled
+    Rows selectRows(const std::string& table, const ParameterizedSql& sql, ConnectionMetrics::Scope& scope);
+    Rows selectColumn(const std::string& table, const ParameterizedSql& sql, ConnectionMetrics::Scope& scope);
+    std::int64_t selectInt64(const std::string& table, const ParameterizedSql& sql, ConnectionMetrics::Scope& scope);
+    double selectDouble(const std::string& table, const ParameterizedSql& sql, ConnectionMetrics::Scope& scope);
+
+    template<typename TResult, typename TRead>
+    TResult
+    readThrough(const std::string& table, const ParameterizedSql& sql, ConnectionMetrics::Scope& scope, TRead&& read);
+    std::int64_t dataVersion();
+
+    // bind the parameters of a statement
+    using Binder = std::function<void(Statement&)>;
+
+    PrimaryKey executeInsert(const ParameterizedSql& sql, bool transaction, ConnectionMetrics::Scope* scope);
+    PrimaryKey
+    executeInsert(const std::string& sql, const Binder& bind, bool transaction, ConnectionMetrics::Scope* scope);
+    // step an INSERT, and return the rowid of its RETURNING row if any, or else of the last row inserted
+    PrimaryKey executeAndGetRowid(Statement& statement);
+    std::uint64_t executeWrite(const ParameterizedSql& sql, bool transaction, ConnectionMetrics::Scope* scope);
+    std::uint64_t
+    executeWrite(const std::string& sql, const Binder& bind, bool transaction, ConnectionMetrics::Scope* scope);
+    // run a DELETE from table, and keep the result cache and the change stream informed even if it deletes every row
+    std::uint64_t executeDelete(const std::string& table,
+                                const ParameterizedSql& sql,
+                                bool transaction,
+                                ConnectionMetrics::Scope* scope);
+    std::uint64_t executeDelete(const std::string& table,
+                                const std::string& sql,
+                                const Binder& bind,
+                                bool transaction,
+                                ConnectionMetrics::Scope* scope);
     PrimaryKeys insertRows(const std::string& table, const Rows& rows, bool transaction, bool replace);
-    PrimaryKey executePPS(sqlite::database_binder& pps, const Row& row);
 
-    static const int kBusyTimeoutMs = 60000;
+    // run a single-row INSERT for rowCount rows, binding the placeholders of each row with bindRow(statement, row);
+    // every rowsPerChunk rows are inserted atomically, in a savepoint
+    using RowBinder = std::function<void(Statement&, std::size_t)>;
+    PrimaryKeys insertRows(const std::string& sql,
+                           std::size_t rowCount,
+                           const RowBinder& bindRow,
+                           bool transaction,
+                           std::size_t rowsPerChunk);
+
+    // run a statement, reporting SQLITE_BUSY as a BusyTimeoutError if the busy policy gave up on it
+    void execute(const std::string& sql);
+    // run a statement that may commit a transaction, e.g. "commit;", then settle the changes its commit staged
+    void executeCommit(const std::string& sql);
+    // publish the changes staged by the commit hook if their commit succeeded, or else make them pending again
+    void settleChanges();
+    // roll back to a savepoint of the connection's own and release it, with the result cache and change stream
+    void undoSavepoint(const std::string& name, std::size_t changes);
+    void commitBatch(const GroupCommit::Batch& batch);
 
     std::string mDatabasePath;
+    ConnectionOptions mOptions;
     sqlite::database mDatabase;
+    StatementCache mStatementCache; // declared after mDatabase, so statements are finalized first
     std::mutex mWriteMutex;
     std::atomic<bool> mInTransaction;
+    std::optional<bool> mForeignKeys; // as last set by beginTransaction(), guarded by mWriteMutex
+
+    Savepoints mSavepoints; // of the active transaction, innermost last, with the change stream mark at each
+    std::unique_ptr<GroupCommit> mGroupCommit;
+    ConnectionMetrics mMetrics;
+    std::shared_ptr<BusyPolicy> mBusyPolicy;
+    std::unique_ptr<QueryProfiler> mProfiler;
+    std::unique_ptr<IndexAdvisor> mIndexAdvisor;
+    std::unique_ptr<ResultCache> mResultCache;
+    std::unique_ptr<ChangeStream> mChangeStream;
 };
 
+template<typename TTable>
+PrimaryKey Connection::insert(const typename TTable::Row& row, bool transaction)
+{
+    ConnectionMetrics::Scope scope{mMetrics, ConnectionMetrics::Operation::Insert};
+
+    const auto& sql = TTable::template Sql<typename TTable::Insert>();
+    auto key = executeInsert(
+        sql, [&row](Statement& statement) { TTable::Bind(statement, 1, row); }, transaction, &scope);
+    scope.rows(1);
+    return key;
+}
+
+template<typename TTable, typename TResult, typename... TWhere>
+std::vector<TResult> Connection::select(const Where<TWhere...>& where)
+{
+    ConnectionMetrics::Scope scope{mMetrics, ConnectionMetrics::Operation::SelectTyped};
+
+    auto statement = prepare(TTable::template Sql<typename TTable::template Select<TWhere...>>());
+    TTable::Bind(statement, 1, where.values);
+    scope.prepared();
+
+    std::vector<TResult> rows;
+    while (statement.step())
+    {
+        rows.emplace_back(TTable::template Read<TResult>(statement));
+    }
+
+    scope.rows(rows.size());
+    return rows;
+}
+
+template<typename TTable, typename... TSet, typename... TWhere>
+std::uint64_t Connection::update(const Set<TSet...>& set, const Where<TWhere...>& where, bool transaction)
+{
+    ConnectionMetrics::Scope scope{mMetrics, ConnectionMetrics::Operation::Update};
+
+    const auto& sql = TTable::template Sql<typename TTable::template Update<Set<TSet...>, Where<TWhere...>>>();
+    auto changes    = executeWrite(
+        sql,
+        [&set, &where](Statement& statement)
+        {
+            TTable::Bind(statement, 1, set.values);
+            TTable::Bind(statement, static_cast<int>(sizeof...(TSet)) + 1, where.values);
+        },
+        transaction,
+        &scope);
+    scope.rows(changes);
+    return changes;
+}
+
+template<typename TTable, typename... TWhere>
+std::uint64_t Connection::deleteRows(const Where<TWhere...>& where, bool transaction)
+{
+    ConnectionMetrics::Scope scope{mMetrics, ConnectionMetrics::Operation::DeleteRows};
+
+    const auto& sql = TTable::template Sql<typename TTable::template Delete<TWhere...>>();
+    auto changes    = executeDelete(
+        std::string{TTable::kName},
+        sql,
+        [&where](Statement& statement) { TTable::Bind(statement, 1, where.values); },
+        transaction,
+        &scope);
+    scope.rows(changes);
+    return changes;
+}
+
+template<typename T, typename>
+std::vector<T> Connection::select(const std::string& table, const KeyValues& filters)
+{
+    ConnectionMetrics::Scope scope{mMetrics, ConnectionMetrics::Operation::SelectTyped};
+
+    auto&& sql = SqliteTraits::SqlSelectParameterized(table, RowMapper<T>::ColumnList(), filters);
+    adviseIndex(table, RowMapper<T>::ColumnList(), sql, filters);
+
+    auto statement = prepare(sql);
+    scope.prepared();
+
+    std::vector<T> values;
+    while (statement.step())
+    {
+        values.emplace_back(RowMapper<T>::Read(statement));
+    }
+
+    scope.rows(values.size());
+    return values;
+}
+
+template<typename T, typename>
+std::vector<T> Connection::select(const std::string& table, const Filter& filter)
+{
+    ConnectionMetrics::Scope scope{mMetrics, ConnectionMetrics::Operation::SelectTyped};
+
+    auto&& sql = SqliteTraits::SqlSelectParameterized(table, RowMapper<T>::ColumnList(), filter);
+    adviseIndex(table, RowMapper<T>::ColumnList(), sql, filter);
+
+    auto statement = prepare(sql);
+    scope.prepared();
+
+    std::vector<T> values;
+    while (statement.step())
+    {
+        values.emplace_back(RowMapper<T>::Read(statement));
+    }
+
+    scope.rows(values.size());
+    return values;
+}
+
+template<typename T, typename>
+PrimaryKeys Connection::insert(const std::string& table, const std::vector<T>& values, bool transaction)
+{
+    ConnectionMetrics::Scope scope{mMetrics, ConnectionMetrics::Operation::InsertRows};
+
+    const auto& columns = RowMapper<T>::Columns();
+
+    auto keys = insertRows(
+        SqliteTraits::SqlInsertWithPlaceholders(table, columns, columns.size(), ConflictPolicy::Abort),
+        values.size(),
+        [&values](Statement& statement, std::size_t row) { RowMapper<T>::Bind(statement, values[row]); },
+        transaction,
+        values.size());
+    scope.rows(keys.size());
+    return keys;
+}
+
 } // namespace sqlite_wrapper
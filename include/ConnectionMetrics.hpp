@@ -0,0 +1,313 @@
+#pragma once
+
+#include "CycleClock.hpp"
+#include "LatencyHistogram.hpp"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <unordered_map>
+
+namespace sqlite_wrapper
+{
+
+/**
+ * @class ConnectionMetrics
+ * @brief Lock-free counters describing where the time of a @c Connection goes.
+ *
+ * For each operation: calls, failed calls, rows returned or affected, a @c LatencyHistogram of the call durations,
+ * and the statements that found the DB locked by another connection, with the busy handler's retries, waits and
+ * timeouts. Across operations: time spent building SQL and preparing statements, waiting for the connection's
+ * write mutex, and in the busy handler, as well as the bytes of result values materialized.
+ *
+ * Calls are timed with a @c CycleClock. The counters updated on every call are kept per thread, written with plain
+ * relaxed loads and stores by their thread only, and summed by @c snapshot(); the others, updated on waits, are
+ * shared relaxed atomics. The @c Scope of a call must cost less than 50 ns, against the microseconds of a statement;
+ * benchmarks/ConnectionMetrics_bench.cpp checks it.
+ */
+class ConnectionMetrics
+{
+public:
+    using Clock = std::chrono::steady_clock; // times waits, which are too long for CycleClock to matter
+
+    enum class Operation
+    {
+        ApplySql,
+        BeginTransaction,
+        CommitTransaction,
+        RollbackTransaction,
+        Select, // also counts the selects made by tableExists()
+        SelectResultSet,
+        SelectTyped,
+        SelectCursor,
+        Query,
+        QueryPage,
+        Insert,
+        InsertRows,
+        InsertOrReplace,
+        InsertOrReplaceRows,
+        Upsert,
+        UpsertRows,
+        Update,
+        DeleteRows,
+        Count,
+        Sum,
+        Average,
+        Aggregate,
+        BulkLoad
+    };
+
+    static constexpr std::size_t kOperationCount = static_cast<std::size_t>(Operation::BulkLoad) + 1;
+
+    static const char* ToString(Operation operation);
+
+    ConnectionMetrics();
+
+    struct OperationStats
+    {
+        std::uint64_t calls{0};
+        std::uint64_t errors{0};
+        std::uint64_t rows{0}; // returned by reads, affected by writes
+        LatencyHistogram::Snapshot latency;
+
+        std::uint64_t busyEvents{0};   // statements that found the DB locked by another connection
+        std::uint64_t busyRetries{0};  // retries made after waiting in the busy handler
+        std::chrono::nanoseconds busyWaitTime{};
+        std::uint64_t busyTimeouts{0}; // calls failed with a BusyTimeoutError
+    };
+
+    struct Stats
+    {
+        std::array<OperationStats, kOperationCount> operations;
+
+        std::chrono::nanoseconds prepareTime{}; // building SQL, and preparing and binding statements
+        std::uint64_t writeLockWaits{0};        // write mutex acquisitions that had to wait
+        std::chrono::nanoseconds writeLockWaitTime{};
+        std::uint64_t busyEvents{0};            // also counting those outside of operations, e.g. in open()
+        std::uint64_t busyRetries{0};           // busy handler invocations, due to locks of other connections
+        std::chrono::nanoseconds busyWaitTime{};
+        std::uint64_t busyTimeouts{0};
+        std::uint64_t bytesMaterialized{0};     // size of the values copied into results
+
+        const OperationStats& operator[](Operation operation) const;
+    };
+
+private:
+    struct Shard;
+
+public:
+    /**
+     * @class Scope
+     * @brief Records one call of an operation: its latency when destroyed, and as failed if unwinding.
+     *
+     * Scopes of a thread are chained, so that the busy handler finds the operation it is waiting for.
+     */
+    class Scope
+    {
+    public:
+        Scope(ConnectionMetrics& metrics, Operation operation);
+        ~Scope();
+
+        Scope(const Scope&)            = delete;
+        Scope& operator=(const Scope&) = delete;
+
+        /**
+         * @brief Mark the end of SQL building and statement preparation.
+         * @param excluded Time spent meanwhile on something else, i.e. waiting for the write mutex.
+         */
+        void prepared(std::chrono::nanoseconds excluded = {});
+
+        void rows(std::uint64_t rows);
+        void bytes(std::uint64_t bytes);
+
+        Operation operation() const;
+        std::chrono::nanoseconds elapsed() const;
+
+        // retries made by the busy handler within the call, across its statements
+        int busyRetries() const;
+        void busyRetried();
+
+        /**
+         * @brief Get the outermost call in progress on the calling thread, for the given metrics.
+         * @return The scope of the call, or nullptr outside of any.
+         */
+        static Scope* Current(const ConnectionMetrics& metrics);
+
+    private:
+        static Scope*& Innermost();
+
+        ConnectionMetrics& mMetrics;
+        Shard& mShard;
+        const Operation mOperation;
+        const int mUncaughtExceptions;
+        const std::uint64_t mStart;
+        Scope* const mOuter; // the previous innermost scope of the thread
+        int mBusyRetries{0};
+    };
+
+    void recordWriteLockWait(std::chrono::nanoseconds wait);
+
+    // the operation is unset for statements run outside of any, e.g. by open()
+    void recordBusy(std::optional<Operation> operation);
+    void recordBusyWait(std::optional<Operation> operation, std::chrono::nanoseconds wait);
+    void recordBusyTimeout(std::optional<Operation> operation);
+
+    Stats snapshot() const;
+
+private:
+    // counters of the calls of a thread, written by that thread only
+    struct Shard
+    {
+        struct OperationCounters
+        {
+            std::atomic<std::uint64_t> errors{0};
+            std::atomic<std::uint64_t> rows{0};
+            LatencyHistogram latency;
+        };
+
+        std::array<OperationCounters, kOperationCount> operations;
+        std::atomic<std::uint64_t> prepareTime{0};
+        std::atomic<std::uint64_t> bytesMaterialized{0};
+    };
+
+    struct BusyCounters
+    {
+        std::atomic<std::uint64_t> events{0};
+        std::atomic<std::uint64_t> retries{0};
+        std::atomic<std::uint64_t> waitTime{0};
+        std::atomic<std::uint64_t> timeouts{0};
+    };
+
+    // shards recently used by the thread, so that finding one doesn't take the registry mutex
+    struct CachedShard
+    {
+        std::uint64_t metricsId{0};
+        Shard* shard{nullptr};
+    };
+
+    static constexpr std::size_t kCachedShards = 8;
+
+    static std::array<CachedShard, kCachedShards>& CachedShards();
+
+    // adds to a counter that no other thread writes, without a read-modify-write operation
+    static void Add(std::atomic<std::uint64_t>& counter, std::uint64_t value);
+
+    Shard& shard();
+    Shard& registerShard();
+    BusyCounters& busyCounters(Operation operation);
+
+    const std::uint64_t mId; // unique for the process, unlike addresses, to tell the metrics of cached shards apart
+
+    mutable std::mutex mShardsMutex;
+    std::unordered_map<std::thread::id, std::unique_ptr<Shard>> mShards; // kept after their thread exits
+
+    std::array<BusyCounters, kOperationCount> mBusyOperations;
+    std::atomic<std::uint64_t> mWriteLockWaits{0};
+    std::atomic<std::uint64_t> mWriteLockWaitTime{0};
+    std::atomic<std::uint64_t> mBusyEvents{0};
+    std::atomic<std::uint64_t> mBusyRetries{0};
+    std::atomic<std::uint64_t> mBusyWaitTime{0};
+    std::atomic<std::uint64_t> mBusyTimeouts{0};
+};
+
+inline ConnectionMetrics::Scope::Scope(ConnectionMetrics& metrics, Operation operation)
+    : mMetrics{metrics}
+    , mShard{metrics.shard()}
+    , mOperation{operation}
+    , mUncaughtExceptions{std::uncaught_exceptions()}
+    , mStart{CycleClock::Now()}
+    , mOuter{Innermost()}
+{
+    Innermost() = this;
+}
+
+inline ConnectionMetrics::Scope::~Scope()
+{
+    Innermost() = mOuter;
+
+    auto& counters = mShard.operations[static_cast<std::size_t>(mOperation)];
+    counters.latency.recordExclusive(CycleClock::ToDuration(CycleClock::Now() - mStart));
+
+    if (std::uncaught_exceptions() > mUncaughtExceptions)
+    {
+        Add(counters.errors, 1);
+    }
+}
+
+inline void ConnectionMetrics::Scope::prepared(std::chrono::nanoseconds excluded)
+{
+    const auto elapsed = CycleClock::ToDuration(CycleClock::Now() - mStart) - excluded;
+    Add(mShard.prepareTime, static_cast<std::uint64_t>(elapsed.count()));
+}
+
+inline void ConnectionMetrics::Scope::rows(std::uint64_t rows)
+{
+    if (rows > 0)
+    {
+        Add(mShard.operations[static_cast<std::size_t>(mOperation)].rows, rows);
+    }
+}
+
+inline void ConnectionMetrics::Scope::bytes(std::uint64_t bytes)
+{
+    Add(mShard.bytesMaterialized, bytes);
+}
+
+inline ConnectionMetrics::Operation ConnectionMetrics::Scope::operation() const
+{
+    return mOperation;
+}
+
+inline std::chrono::nanoseconds ConnectionMetrics::Scope::elapsed() const
+{
+    return CycleClock::ToDuration(CycleClock::Now() - mStart);
+}
+
+inline int ConnectionMetrics::Scope::busyRetries() const
+{
+    return mBusyRetries;
+}
+
+inline void ConnectionMetrics::Scope::busyRetried()
+{
+    ++mBusyRetries;
+}
+
+inline ConnectionMetrics::Scope*& ConnectionMetrics::Scope::Innermost()
+{
+    thread_local Scope* innermost = nullptr;
+    return innermost;
+}
+
+inline std::array<ConnectionMetrics::CachedShard, ConnectionMetrics::kCachedShards>& ConnectionMetrics::CachedShards()
+{
+    thread_local std::array<CachedShard, kCachedShards> cachedShards{};
+    return cachedShards;
+}
+
+inline void ConnectionMetrics::Add(std::atomic<std::uint64_t>& counter, std::uint64_t value)
+{
+    counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+}
+
+inline ConnectionMetrics::Shard& ConnectionMetrics::shard()
+{
+    for (const auto& cached : CachedShards())
+    {
+        if (cached.metricsId == mId)
+        {
+            return *cached.shard;
+        }
+    }
+
+    return registerShard();
+}
+
+} // namespace sqlite_wrapper
@@ -0,0 +1,202 @@
+#pragma once
+
+#include "ConnectionMetrics.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace sqlite_wrapper
+{
+
+class BusyPolicy;
+
+/**
+ * @struct BusyBackoffOptions
+ * @brief How long the default @c BusyPolicy waits between retries while another connection holds a lock.
+ *
+ * The n-th retry of an operation waits min(initialDelay * multiplier^n, maxDelay), shortened at random by up to
+ * @c jitter of it, so that connections waiting for the same lock do not all retry at once.
+ */
+struct BusyBackoffOptions
+{
+    std::chrono::milliseconds initialDelay{1};
+    std::chrono::milliseconds maxDelay{100};
+    double multiplier{2.0};
+    double jitter{0.5};                      // in [0, 1]
+    std::optional<std::uint32_t> maxRetries; // retry budget of each operation; unlimited if unset
+
+    // Deadlines of the given operations, instead of @c ConnectionOptions::busyTimeout, e.g. shorter for reads
+    std::map<ConnectionMetrics::Operation, std::chrono::milliseconds> deadlines;
+};
+
+/**
+ * @struct GroupCommitOptions
+ * @brief Window within which concurrent non-transactional writes are committed together.
+ *
+ * A batch is committed once it holds @c maxBatchSize writes, or @c maxDelay after its first write arrived,
+ * whichever comes first.
+ */
+struct GroupCommitOptions
+{
+    std::size_t maxBatchSize{64};
+    std::chrono::microseconds maxDelay{1000};
+};
+
+/**
+ * @struct ProfilerOptions
+ * @brief Which profiled statements are kept in the slow-query log of a @c QueryProfiler.
+ */
+struct ProfilerOptions
+{
+    std::chrono::microseconds slowQueryThreshold{100000}; // statements taking at least this long are logged
+    std::size_t slowQueryLogSize{128};                    // how many of the most recent ones are kept
+    bool expandSql{true};                                 // log the SQL with bound values substituted in
+};
+
+/**
+ * @struct IndexAdvisorOptions
+ * @brief When an @c IndexAdvisor recommends an index for a statement shape that scans a table in full.
+ */
+struct IndexAdvisorOptions
+{
+    std::uint64_t minFullScans{10}; // calls of the shape needed before it is reported
+};
+
+/**
+ * @struct ResultCacheOptions
+ * @brief Size of the @c ResultCache of a connection, and how it detects writes made elsewhere.
+ */
+struct ResultCacheOptions
+{
+    std::size_t maxBytes{16 * 1024 * 1024}; // estimated memory use above which the least recently used are evicted
+    bool checkDataVersion{true}; // detect commits by other connections, with a PRAGMA data_version per cached read
+};
+
+/**
+ * @struct ChangeStreamOptions
+ * @brief How many committed changes a @c ChangeStream keeps, for consumers to read or resume from.
+ */
+struct ChangeStreamOptions
+{
+    std::size_t capacity{4096}; // the oldest changes are dropped beyond this
+};
+
+/**
+ * @struct ConnectionOptions
+ * @brief Settings applied once, when a @c Connection is opened.
+ *
+ * Settings left unset keep SQLite's (or the DB file's) defaults.
+ * See https://www.sqlite.org/pragma.html for the meaning of each PRAGMA.
+ */
+struct ConnectionOptions
+{
+    static constexpr int kDefaultBusyTimeoutMs              = 60000;
+    static constexpr std::size_t kDefaultStatementCacheSize = 64;
+
+    enum class ThreadingMode
+    {
+        Serialized,  // SQLITE_OPEN_FULLMUTEX: the connection can be shared between threads
+        MultiThread, // SQLITE_OPEN_NOMUTEX: the connection must only be used by one thread at a time
+    };
+
+    enum class JournalMode
+    {
+        Delete,
+        Truncate,
+        Persist,
+        Memory,
+        Wal,
+        Off,
+    };
+
+    enum class Synchronous
+    {
+        Off,
+        Normal,
+        Full,
+        Extra,
+    };
+
+    enum class TempStore
+    {
+        Default,
+        File,
+        Memory,
+    };
+
+    enum class LockingMode
+    {
+        Normal,
+        Exclusive,
+    };
+
+    bool readOnly{false};
+    bool create{true}; // create the DB file if it does not exist; ignored if read-only
+    ThreadingMode threadingMode{ThreadingMode::Serialized};
+
+    std::optional<JournalMode> journalMode;
+    std::optional<Synchronous> synchronous;
+    std::optional<std::int64_t> cacheSize; // pages if positive, KiB if negative
+    std::optional<std::int64_t> mmapSize;  // bytes
+    std::optional<TempStore> tempStore;
+    std::optional<std::int64_t> pageSize; // bytes; only effective before the DB is created, and not in WAL mode
+    std::optional<LockingMode> lockingMode;
+
+    // Deadline of each operation waiting for locks held by other connections, counted from the operation's start
+    std::chrono::milliseconds busyTimeout{kDefaultBusyTimeoutMs};
+    BusyBackoffOptions busyBackoff;
+
+    // If set, decides how long to wait for other connections' locks, instead of busyTimeout and busyBackoff;
+    // it may be shared by several connections; see @c BusyPolicy
+    std::shared_ptr<BusyPolicy> busyPolicy;
+
+    std::size_t statementCacheSize{kDefaultStatementCacheSize}; // 0 disables the statement cache
+
+    // If set, non-transactional writes are coalesced into shared transactions; see @c GroupCommit
+    std::optional<GroupCommitOptions> groupCommit;
+
+    // If set, every statement is profiled, and slow ones are logged; see @c QueryProfiler
+    std::optional<ProfilerOptions> profiler;
+
+    // If set, the query plans of filtered reads and writes are checked for full scans; see @c IndexAdvisor
+    std::optional<IndexAdvisorOptions> indexAdvisor;
+
+    // If set, the results of selects, counts, sums and averages are kept until their table changes; see @c ResultCache
+    std::optional<ResultCacheOptions> resultCache;
+
+    // If set, the rows inserted, updated and deleted by committed transactions are streamed; see @c ChangeStream
+    std::optional<ChangeStreamOptions> changeStream;
+
+    /**
+     * @brief Get the PRAGMAs corresponding to the options that are set, in the order they must be applied.
+     * @return Pairs of PRAGMA name and value.
+     */
+    std::vector<std::pair<std::string, std::string>> pragmas() const;
+
+    /**
+     * @brief Every committed transaction survives a power loss: WAL with a sync on each commit.
+     */
+    static ConnectionOptions Durable();
+
+    /**
+     * @brief Favors write and read throughput: WAL synced at checkpoints only, large page cache,
+     * memory-mapped I/O and in-memory temporary tables. A power loss may roll back the last commits,
+     * but cannot corrupt the database.
+     */
+    static ConnectionOptions Throughput();
+
+    /**
+     * @brief Read-only connection for large scans: very large page cache, memory-mapped I/O
+     * and in-memory temporary tables (sorting, grouping).
+     */
+    static ConnectionOptions ReadOnlyAnalytics();
+};
+
+} // namespace sqlite_wrapper
@@ -0,0 +1,170 @@
+#pragma once
+
+#include "Connection.hpp"
+#include "IConnection.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace sqlite_wrapper
+{
+
+/**
+ * @class ConnectionPool
+ * @brief Implements @c IConnection on top of a single writer connection and a pool of reader connections.
+ *
+ * The database is switched to WAL mode when the writer is opened, so readers do not block the writer
+ * and vice versa. Each read (@c select, @c count, @c sum, @c average, ...) checks out an idle reader
+ * connection for the duration of the call and runs in parallel with other reads; if all readers are busy,
+ * the caller waits for one to be returned. Writes and transactions all go to the writer connection,
+ * whose write mutex serializes them as in @c Connection.
+ *
+ * Reads issued by the thread that owns an active transaction are served by the writer, so that they see
+ * the transaction's uncommitted changes.
+ */
+class ConnectionPool : public IConnection
+{
+public:
+    static constexpr std::size_t kDefaultReaderCount = 4;
+
+    struct Stats
+    {
+        std::size_t readers{0};
+        std::size_t readersInUse{0};
+        std::uint64_t acquisitions{0};       // reader check-outs
+        std::uint64_t waits{0};              // check-outs that had to wait for a reader
+        std::chrono::nanoseconds waitTime{}; // total time spent waiting for a reader
+        std::chrono::nanoseconds maxWaitTime{};
+        double utilization{0.0}; // fraction of reader time spent checked out, since open()
+    };
+
+    /**
+     * @param databasePath The DB file.
+     * @param readerCount The number of reader connections.
+     * @param options Options for all connections. The journal mode is always WAL, and readers are opened
+     *                in multi-thread mode since each one is only used by one thread at a time.
+     */
+    ConnectionPool(const std::string& databasePath,
+                   std::size_t readerCount          = kDefaultReaderCount,
+                   const ConnectionOptions& options = {});
+
+    const std::string& getDatabasePath() const override;
+    bool open() override;
+    bool isOpen() const override;
+    void applySql(const std::string& sql) override;
+    bool tableExists(const std::string& table) override;
+    void beginTransaction(bool enableForeignKeys) override;
+    void beginTransaction(TransactionMode mode, bool enableForeignKeys) override;
+    void commitTransaction() override;
+    void rollbackTransaction() override;
+    void savepoint(const std::string& name) override;
+    void releaseSavepoint(const std::string& name) override;
+    void rollbackToSavepoint(const std::string& name) override;
+    Rows select(const std::string& table, const KeyValues& filters) override;
+    Rows select(const std::string& table, const std::string& col, const KeyValues& filters) override;
+    void select(ResultSet& result, const std::string& table, const KeyValues& filters) override;
+    void
+    select(ResultSet& result, const std::string& table, const std::string& col, const KeyValues& filters) override;
+    SqlRows selectTyped(const std::string& table, const KeyValues& filters) override;
+    SqlRows selectTyped(const std::string& table, const std::string& col, const KeyValues& filters) override;
+    RowCursor selectCursor(const std::string& table, const KeyValues& filters) override;
+    RowCursor selectCursor(const std::string& table, const std::string& col, const KeyValues& filters) override;
+    PrimaryKey insert(const std::string& table, const KeyValues& keyValues, bool transaction) override;
+    PrimaryKeys insert(const std::string& table, const Rows& rows, bool transaction) override;
+    PrimaryKey insertOrReplace(const std::string& table, const KeyValues& keyValues, bool transaction) override;
+    PrimaryKeys insertOrReplace(const std::string& table, const Rows& rows, bool transaction) override;
+    PrimaryKey upsert(const std::string& table,
+                      const KeyValues& keyValues,
+                      const std::vector<std::string>& conflictColumns,
+                      const std::vector<std::string>& updateColumns,
+                      bool transaction) override;
+    PrimaryKeys upsert(const std::string& table,
+                       const Rows& rows,
+                       const std::vector<std::string>& conflictColumns,
+                       const std::vector<std::string>& updateColumns,
+                       bool transaction) override;
+    void
+    update(const std::string& table, const KeyValues& keyValues, const KeyValues& filters, bool transaction) override;
+    void deleteRows(const std::string& table, const KeyValues& filters, bool transaction) override;
+    std::size_t count(const std::string& table, const KeyValues& filters) override;
+    std::size_t count(const std::string& table, const std::string& col, const KeyValues& filters) override;
+    double sum(const std::string& table, const std::string& col, const KeyValues& filters) override;
+    double average(const std::string& table, const std::string& col, const KeyValues& filters) override;
+    Rows select(const std::string& table, const Filter& filter) override;
+    Rows select(const std::string& table, const std::string& col, const Filter& filter) override;
+    Rows query(const std::string& table, const QueryOptions& options, const Filter& filter) override;
+    Page queryPage(const std::string& table,
+                   const PageOptions& options,
+                   const Filter& filter,
+                   const std::optional<PageToken>& after) override;
+    void update(const std::string& table, const KeyValues& keyValues, const Filter& filter, bool transaction) override;
+    void deleteRows(const std::string& table, const Filter& filter, bool transaction) override;
+    std::size_t count(const std::string& table, const Filter& filter) override;
+    std::size_t count(const std::string& table, const std::string& col, const Filter& filter) override;
+    double sum(const std::string& table, const std::string& col, const Filter& filter) override;
+    double average(const std::string& table, const std::string& col, const Filter& filter) override;
+    SqlRow aggregate(const std::string& table, const Aggregates& aggregates, const KeyValues& filters) override;
+    SqlRows aggregate(const std::string& table,
+                      const std::vector<std::string>& groupBy,
+                      const Aggregates& aggregates,
+                      const KeyValues& filters) override;
+
+    /**
+     * @brief Get a snapshot of the reader pool counters.
+     * @return The pool statistics.
+     */
+    Stats stats() const;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    /**
+     * Checks a reader out of the pool for its lifetime, or lends the writer to the transaction owner.
+     */
+    class Lease
+    {
+    public:
+        Lease(ConnectionPool* pool, Connection* connection);
+        Lease(Lease&& other) noexcept;
+        ~Lease();
+
+        Lease(const Lease&)            = delete;
+        Lease& operator=(const Lease&) = delete;
+        Lease& operator=(Lease&&)      = delete;
+
+        Connection* operator->() const;
+
+    private:
+        ConnectionPool* mPool; // nullptr when lending the writer
+        Connection* mConnection;
+        Clock::time_point mStart;
+    };
+
+    Lease acquireReader();
+    void releaseReader(Connection* reader, Clock::time_point checkedOutAt);
+
+    bool ownsTransaction() const;
+
+    std::string mDatabasePath;
+    std::unique_ptr<Connection> mWriter;
+    std::vector<std::unique_ptr<Connection>> mReaders;
+
+    mutable std::mutex mReadersMutex;
+    std::condition_variable mReaderReleased;
+    std::vector<Connection*> mIdleReaders;
+    Stats mStats;
+    std::chrono::nanoseconds mBusyTime{};
+    Clock::time_point mOpenedAt;
+
+    std::atomic<std::thread::id> mTransactionOwner{std::thread::id{}};
+};
+
+} // namespace sqlite_wrapper
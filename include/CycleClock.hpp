@@ -0,0 +1,54 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#endif
+#endif
+
+namespace sqlite_wrapper
+{
+
+/**
+ * @class CycleClock
+ * @brief Cheap monotonic clock, for timing short operations on hot paths.
+ *
+ * On x86-64, reads the time-stamp counter, which costs a few nanoseconds where @c std::chrono::steady_clock
+ * may cost tens of them; ticks are converted to nanoseconds with a rate calibrated against
+ * @c std::chrono::steady_clock, once per process, the first time a conversion is needed (which takes 1 ms).
+ * Elsewhere, ticks are @c std::chrono::steady_clock nanoseconds.
+ */
+class CycleClock
+{
+public:
+    CycleClock() = delete;
+
+    static std::uint64_t Now()
+    {
+#if defined(__x86_64__) || defined(_M_X64)
+        return __rdtsc();
+#else
+        const auto now = std::chrono::steady_clock::now().time_since_epoch();
+        return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(now).count());
+#endif
+    }
+
+    /**
+     * @brief Convert a number of ticks, i.e. the difference between two @c Now() values, to a duration.
+     */
+    static std::chrono::nanoseconds ToDuration(std::uint64_t ticks)
+    {
+        static const double kNanosecondsPerTick = Calibrate();
+        return std::chrono::nanoseconds{static_cast<std::int64_t>(static_cast<double>(ticks) * kNanosecondsPerTick)};
+    }
+
+private:
+    static double Calibrate();
+};
+
+} // namespace sqlite_wrapper
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cstddef>
+#include <istream>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace sqlite_wrapper
+{
+
+/**
+ * @class DelimitedReader
+ * @brief Incremental parser of delimited text (CSV, TSV, ...), one record at a time.
+ *
+ * Fields follow RFC 4180 quoting: a field enclosed in quotes may contain the delimiter, line breaks and
+ * doubled quotes, which stand for a single quote. LF and CRLF line endings are accepted, and blank lines skipped.
+ *
+ * Records are parsed in place, into a buffer reused from one record to the next, so reading a record does not
+ * allocate once the buffer has grown to the longest record. The fields returned by @c field() are therefore
+ * only valid until the next call to @c next().
+ *
+ * Throws a @c std::runtime_error when the input ends inside a quoted field.
+ */
+class DelimitedReader
+{
+public:
+    explicit DelimitedReader(std::istream& input, char delimiter = ',', char quote = '"');
+
+    /**
+     * @brief Read the next record.
+     * @return True if a record was read, false at the end of the input.
+     */
+    bool next();
+
+    /**
+     * @brief Get the number of fields of the current record.
+     */
+    std::size_t size() const;
+
+    /**
+     * @brief Get a field of the current record, unquoted.
+     * @param index The 0-based field index.
+     */
+    std::string_view field(std::size_t index) const;
+
+    /**
+     * @brief Check whether a field of the current record is empty, and was not quoted.
+     */
+    bool isEmpty(std::size_t index) const;
+
+    /**
+     * @brief Get the 1-based line number at which the current record starts.
+     */
+    std::size_t lineNumber() const;
+
+private:
+    struct Field
+    {
+        std::size_t offset;
+        std::size_t length;
+        bool quoted;
+    };
+
+    bool readLine(bool append);
+
+    std::istream& mInput;
+    const char mDelimiter;
+    const char mQuote;
+
+    std::string mRecord;
+    std::vector<Field> mFields;
+    std::size_t mLinesRead{0};
+    std::size_t mLineNumber{0};
+};
+
+} // namespace sqlite_wrapper
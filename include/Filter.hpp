@@ -0,0 +1,172 @@
+#pragma once
+
+#include "SqliteTypes.hpp"
+
+#include <initializer_list>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace sqlite_wrapper
+{
+
+/**
+ * @class Filter
+ * @brief A WHERE condition, built from comparisons of columns with values and combined with AND, OR and NOT.
+ *
+ * Where @c KeyValues filters can only require columns to equal values, a @c Filter can express ranges,
+ * lists, patterns and alternatives, so that rows are filtered by SQLite, possibly through an index, rather
+ * than after being fetched. Values are bound to '?' placeholders: the SQL text only depends on the shape
+ * of the condition, so statements are reused from the statement cache.
+ *
+ * Example:
+ *
+ *    auto filter = Filter::GreaterEqual("age", 18) && (Filter::In("city", {"Lisbon", "Porto"})
+ *                                                      || !Filter::Like("name", "A%"));
+ *    connection.select("people", filter);
+ */
+class Filter
+{
+public:
+    enum class Operator
+    {
+        Equal,    // IS NULL for a NULL value
+        NotEqual, // IS NOT NULL for a NULL value
+        Less,
+        LessEqual,
+        Greater,
+        GreaterEqual,
+        Between,
+        In,
+        Like,
+        And, // of the operands; true if there are none
+        Or,  // of the operands; false if there are none
+        Not  // of the single operand
+    };
+
+    /**
+     * @brief Match all rows: an AND of no conditions.
+     */
+    static Filter All();
+
+    /**
+     * @brief Require every column to equal its value, or to be NULL: the condition of a @c KeyValues filter.
+     */
+    static Filter Equal(const KeyValues& keyValues);
+
+    template<typename T>
+    static Filter Equal(const std::string& key, const T& value)
+    {
+        return {Operator::Equal, key, {KeyValue{key, value}.sqlValue()}};
+    }
+
+    template<typename T>
+    static Filter NotEqual(const std::string& key, const T& value)
+    {
+        return {Operator::NotEqual, key, {KeyValue{key, value}.sqlValue()}};
+    }
+
+    template<typename T>
+    static Filter Less(const std::string& key, const T& value)
+    {
+        return {Operator::Less, key, {KeyValue{key, value}.sqlValue()}};
+    }
+
+    template<typename T>
+    static Filter LessEqual(const std::string& key, const T& value)
+    {
+        return {Operator::LessEqual, key, {KeyValue{key, value}.sqlValue()}};
+    }
+
+    template<typename T>
+    static Filter Greater(const std::string& key, const T& value)
+    {
+        return {Operator::Greater, key, {KeyValue{key, value}.sqlValue()}};
+    }
+
+    template<typename T>
+    static Filter GreaterEqual(const std::string& key, const T& value)
+    {
+        return {Operator::GreaterEqual, key, {KeyValue{key, value}.sqlValue()}};
+    }
+
+    /**
+     * @brief Require a column to be within [@arg low, @arg high].
+     */
+    template<typename T>
+    static Filter Between(const std::string& key, const T& low, const T& high)
+    {
+        return {Operator::Between, key, {KeyValue{key, low}.sqlValue(), KeyValue{key, high}.sqlValue()}};
+    }
+
+    /**
+     * @brief Require a column to equal one of the values; an empty list matches no row.
+     */
+    template<typename T>
+    static Filter In(const std::string& key, const std::vector<T>& values)
+    {
+        SqlRow row;
+        row.reserve(values.size());
+        for (const auto& value : values)
+        {
+            row.emplace_back(KeyValue{key, value}.sqlValue());
+        }
+
+        return {Operator::In, key, std::move(row)};
+    }
+
+    template<typename T>
+    static Filter In(const std::string& key, std::initializer_list<T> values)
+    {
+        return In(key, std::vector<T>{values});
+    }
+
+    /**
+     * @brief Require a column to match a LIKE pattern, where '%' matches any text and '_' any character.
+     *
+     * Matching is case-insensitive for ASCII characters, unless PRAGMA case_sensitive_like is set.
+     */
+    static Filter Like(const std::string& key, const std::string& pattern);
+
+    static Filter IsNull(const std::string& key);
+    static Filter IsNotNull(const std::string& key);
+
+    Operator op() const;
+
+    /**
+     * @brief Get the compared column; empty for AND, OR and NOT.
+     */
+    const std::string& key() const;
+
+    /**
+     * @brief Get the values compared with the column, in binding order.
+     */
+    const SqlRow& values() const;
+
+    /**
+     * @brief Get the conditions combined by AND, OR or NOT.
+     */
+    const std::vector<Filter>& operands() const;
+
+    /**
+     * @brief Check whether the filter is an AND of no conditions, matching all rows.
+     */
+    bool empty() const;
+
+    friend Filter operator&&(Filter lhs, Filter rhs);
+    friend Filter operator||(Filter lhs, Filter rhs);
+    friend Filter operator!(Filter operand);
+
+private:
+    Filter(Operator op, std::string key, SqlRow values);
+    Filter(Operator op, std::vector<Filter> operands);
+
+    static Filter Combine(Operator op, Filter lhs, Filter rhs);
+
+    Operator mOperator;
+    std::string mKey;
+    SqlRow mValues;
+    std::vector<Filter> mOperands;
+};
+
+} // namespace sqlite_wrapper
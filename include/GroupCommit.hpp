@@ -0,0 +1,94 @@
+#pragma once
+
+#include "ConnectionOptions.hpp"
+#include "SqliteTypes.hpp"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+namespace sqlite_wrapper
+{
+
+/**
+ * @class GroupCommit
+ * @brief Coalesces writes submitted concurrently by several threads into shared transactions.
+ *
+ * The first thread to submit a write into an empty batch becomes the batch leader: it waits for more writes
+ * to join, within the window set by @c GroupCommitOptions, then runs the whole batch through the executor
+ * on behalf of all submitters. Writes arriving meanwhile start the next batch, so batches pipeline behind
+ * each other's commit. Every submitter blocks until its own write's outcome is known, and gets its own
+ * result or exception.
+ */
+class GroupCommit
+{
+public:
+    using Operation = std::function<PrimaryKey()>;
+
+    struct Request
+    {
+        Operation operation;
+        std::optional<PrimaryKey> result;
+        std::exception_ptr error;
+        bool done{false};
+    };
+
+    using Batch = std::vector<Request*>;
+
+    /**
+     * Runs a batch in a single transaction, setting each request's result or error.
+     */
+    using Executor = std::function<void(const Batch& batch)>;
+
+    struct Stats
+    {
+        std::uint64_t batches{0};
+        std::uint64_t writes{0};
+        std::size_t maxBatchSize{0};
+        double averageBatchSize{0.0};
+        std::chrono::nanoseconds commitLatency{}; // total time spent executing batches
+        std::chrono::nanoseconds maxCommitLatency{};
+    };
+
+    GroupCommit(const GroupCommitOptions& options, Executor executor);
+
+    GroupCommit(const GroupCommit&)            = delete;
+    GroupCommit& operator=(const GroupCommit&) = delete;
+
+    /**
+     * @brief Submit a write, and wait for the batch it joined to be committed.
+     * @param operation The write; it runs on the batch leader's thread, inside the batch transaction.
+     * @return The result of @arg operation.
+     *
+     * Rethrows the exception thrown by @arg operation, or the one that made the batch fail.
+     */
+    PrimaryKey submit(Operation operation);
+
+    /**
+     * @brief Get a snapshot of the batching counters.
+     * @return The group commit statistics.
+     */
+    Stats stats() const;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    void lead(std::unique_lock<std::mutex>& lock);
+
+    const GroupCommitOptions mOptions;
+    const Executor mExecutor;
+
+    mutable std::mutex mMutex;
+    std::condition_variable mBatchGrown; // wakes the leader of the open batch
+    std::condition_variable mBatchDone;  // wakes the followers of executed batches
+    Batch mOpenBatch;
+    Stats mStats;
+};
+
+} // namespace sqlite_wrapper
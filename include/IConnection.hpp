@@ -1,8 +1,14 @@
 #pragma once
 
+#include "Filter.hpp"
+#include "QueryOptions.hpp"
+#include "ResultSet.hpp"
+#include "RowCursor.hpp"
 #include "SqliteTypes.hpp"
 
 #include <cstddef>
+#include <string>
+#include <vector>
 
 namespace sqlite_wrapper
 {
@@ -57,6 +63,16 @@ public:
      */
     virtual void beginTransaction(bool enableForeignKeys = true) = 0;
 
+    /**
+     * @brief Begin a transaction, acquiring the DB locks as specified.
+     * @param mode When the DB locks are acquired; with @c TransactionMode::Immediate, a transaction that writes
+     *             waits for other processes' writes up front, rather than failing with SQLITE_BUSY halfway through.
+     * @param enableForeignKeys Whether to enable foreign key constraints, as for @c beginTransaction(bool).
+     *
+     * If the transaction can't be begun, an exception is thrown and no transaction is active.
+     */
+    virtual void beginTransaction(TransactionMode mode, bool enableForeignKeys = true) = 0;
+
     /**
      * @brief Commit an active transaction.
      */
@@ -67,6 +83,24 @@ public:
      */
     virtual void rollbackTransaction() = 0;
 
+    /**
+     * @brief Open a savepoint within the active transaction.
+     * @param name The savepoint name; a plain SQL identifier.
+     *
+     * Throws a @c std::logic_error if no transaction is active, or a @c std::invalid_argument for a bad name.
+     */
+    virtual void savepoint(const std::string& name) = 0;
+
+    /**
+     * @brief Release a savepoint, and the ones opened after it, keeping their changes in the transaction.
+     */
+    virtual void releaseSavepoint(const std::string& name) = 0;
+
+    /**
+     * @brief Undo the changes made since a savepoint was opened; the savepoint stays open.
+     */
+    virtual void rollbackToSavepoint(const std::string& name) = 0;
+
     /**
      * @brief Select all columns of all rows from the specified table.
      * @param table The target table.
@@ -84,6 +118,107 @@ public:
      */
     virtual Rows select(const std::string& table, const std::string& col, const KeyValues& filters = {}) = 0;
 
+    /**
+     * @brief Select all columns of the rows matching a @c Filter.
+     * @param table The target table.
+     * @param filter The condition rows must satisfy.
+     * @return All matching rows.
+     */
+    virtual Rows select(const std::string& table, const Filter& filter) = 0;
+
+    /**
+     * @brief Select a column of the rows matching a @c Filter.
+     * @param table The target table.
+     * @param col The target column.
+     * @param filter The condition rows must satisfy.
+     * @return All matching rows.
+     */
+    virtual Rows select(const std::string& table, const std::string& col, const Filter& filter) = 0;
+
+    /**
+     * @brief Select rows with a projection, ordering, limit and offset.
+     * @param table The target table.
+     * @param options The columns to return, the sort keys and the bounds; see @c QueryOptions.
+     * @param filter The condition rows must satisfy.
+     * @return The matching rows, within the bounds.
+     */
+    virtual Rows query(const std::string& table, const QueryOptions& options, const Filter& filter = Filter::All()) = 0;
+
+    /**
+     * @brief Select one page of rows, through keyset pagination.
+     * @param table The target table.
+     * @param options The seek key, the page size and the columns to return; see @c PageOptions.
+     * @param filter The condition rows must satisfy; it must be the same for all pages.
+     * @param after The token of the previous page, or std::nullopt for the first page.
+     * @return The page rows, and the token of the next page, if any.
+     *
+     * Throws std::invalid_argument if the page size is 0, or if @arg after does not match the seek key.
+     */
+    virtual Page queryPage(const std::string& table,
+                           const PageOptions& options,
+                           const Filter& filter                  = Filter::All(),
+                           const std::optional<PageToken>& after = std::nullopt)
+        = 0;
+
+    /**
+     * @brief Select all columns of all rows from the specified table into a @c ResultSet.
+     * @param result The result set to fill; any rows it already holds are dropped.
+     * @param table The target table.
+     * @param filters The target filters, if any.
+     *
+     * Reusing the same @c ResultSet across calls also reuses its memory.
+     */
+    virtual void select(ResultSet& result, const std::string& table, const KeyValues& filters = {}) = 0;
+
+    /**
+     * @brief Select a column of all rows from the specified table into a @c ResultSet.
+     * @param result The result set to fill; any rows it already holds are dropped.
+     * @param table The target table.
+     * @param col The target column.
+     * @param filters The target filters, if any.
+     */
+    virtual void
+    select(ResultSet& result, const std::string& table, const std::string& col, const KeyValues& filters = {})
+        = 0;
+
+    /**
+     * @brief Select all columns of all rows from the specified table, in their native storage classes.
+     * @param table The target table.
+     * @param filters The target filters, if any.
+     * @return All matching rows.
+     *
+     * Unlike @c select(), column values are not converted to text.
+     */
+    virtual SqlRows selectTyped(const std::string& table, const KeyValues& filters = {}) = 0;
+
+    /**
+     * @brief Select a column of all rows from the specified table, in its native storage class.
+     * @param table The target table.
+     * @param col The target column.
+     * @param filters The target filters, if any.
+     * @return All matching rows.
+     */
+    virtual SqlRows selectTyped(const std::string& table, const std::string& col, const KeyValues& filters = {}) = 0;
+
+    /**
+     * @brief Select all columns of all rows from the specified table, one row at a time.
+     * @param table The target table.
+     * @param filters The target filters, if any.
+     * @return A cursor over the matching rows.
+     *
+     * Rows are read lazily as the cursor advances; see @c RowCursor.
+     */
+    virtual RowCursor selectCursor(const std::string& table, const KeyValues& filters = {}) = 0;
+
+    /**
+     * @brief Select a column of all rows from the specified table, one row at a time.
+     * @param table The target table.
+     * @param col The target column.
+     * @param filters The target filters, if any.
+     * @return A cursor over the matching rows.
+     */
+    virtual RowCursor selectCursor(const std::string& table, const std::string& col, const KeyValues& filters = {}) = 0;
+
     /**
      * @brief Create a row in a table using the specified key-value pairs.
      * @param table The target table.
@@ -121,6 +256,42 @@ public:
      */
     virtual PrimaryKeys insertOrReplace(const std::string& table, const Rows& rows, bool transaction = false) = 0;
 
+    /**
+     * @brief Insert a row, or update some columns of the existing row it conflicts with, in place.
+     *
+     * Unlike @c insertOrReplace(), the existing row is not deleted and re-inserted: it keeps its rowid and the
+     * values of the other columns, only the index entries of the updated columns are rewritten, and no delete
+     * trigger fires. Requires SQLite 3.35 or later.
+     * @param table The target table.
+     * @param keyValues The key-value pairs.
+     * @param conflictColumns The columns of the PRIMARY KEY or UNIQUE constraint that conflicts are checked on.
+     * @param updateColumns The columns set to their new values on conflict.
+     * @param transaction Whether the operation is part of an active transaction.
+     * @return The @c PrimaryKey of the inserted or updated row.
+     */
+    virtual PrimaryKey upsert(const std::string& table,
+                              const KeyValues& keyValues,
+                              const std::vector<std::string>& conflictColumns,
+                              const std::vector<std::string>& updateColumns,
+                              bool transaction = false)
+        = 0;
+
+    /**
+     * @brief Insert or update one or multiple rows in a table, as @c upsert() does for a single row.
+     * @param table The target table.
+     * @param rows The @c Rows to be inserted in @arg table, with a value for each column, in order.
+     * @param conflictColumns The columns of the PRIMARY KEY or UNIQUE constraint that conflicts are checked on.
+     * @param updateColumns The columns set to their new values on conflict.
+     * @param transaction Whether the SQLite statement is being run inside a transaction or not.
+     * @return The @c PrimaryKeys of the inserted or updated rows, in order.
+     */
+    virtual PrimaryKeys upsert(const std::string& table,
+                               const Rows& rows,
+                               const std::vector<std::string>& conflictColumns,
+                               const std::vector<std::string>& updateColumns,
+                               bool transaction = false)
+        = 0;
+
     /**
      * @brief Update rows in a table with the specified key-value pairs.
      * @param table The target table.
@@ -146,6 +317,25 @@ public:
      */
     virtual void deleteRows(const std::string& table, const KeyValues& filters = {}, bool transaction = false) = 0;
 
+    /**
+     * @brief Update the rows matching a @c Filter with the specified key-value pairs.
+     * @param table The target table.
+     * @param keyValues The key-value pairs.
+     * @param filter The condition rows must satisfy.
+     * @param transaction Whether the operation is part of an active transaction.
+     */
+    virtual void
+    update(const std::string& table, const KeyValues& keyValues, const Filter& filter, bool transaction = false)
+        = 0;
+
+    /**
+     * @brief Delete the rows matching a @c Filter.
+     * @param table The target table.
+     * @param filter The condition rows must satisfy.
+     * @param transaction Whether the operation is part of an active transaction.
+     */
+    virtual void deleteRows(const std::string& table, const Filter& filter, bool transaction = false) = 0;
+
     /**
      * @brief Count the number of rows in the specified table.
      * @param table The target table.
@@ -184,6 +374,52 @@ public:
      * If all values all NULL, or no rows are found, this function returns 0.0.
      */
     virtual double average(const std::string& table, const std::string& col, const KeyValues& filters = {}) = 0;
+
+    /**
+     * @brief Count the rows matching a @c Filter.
+     */
+    virtual std::size_t count(const std::string& table, const Filter& filter) = 0;
+
+    /**
+     * @brief Count the rows matching a @c Filter for which the specified column is not NULL.
+     */
+    virtual std::size_t count(const std::string& table, const std::string& col, const Filter& filter) = 0;
+
+    /**
+     * @brief Sum all non-NULL values from a column, in the rows matching a @c Filter; 0.0 if there are none.
+     */
+    virtual double sum(const std::string& table, const std::string& col, const Filter& filter) = 0;
+
+    /**
+     * @brief Average all non-NULL values from a column, in the rows matching a @c Filter; 0.0 if there are none.
+     */
+    virtual double average(const std::string& table, const std::string& col, const Filter& filter) = 0;
+
+    /**
+     * @brief Compute several aggregates over the same rows, in a single statement and scan.
+     * @param table The target table.
+     * @param aggregates The aggregates to compute, e.g. {Count(), Sum("price"), Max("price")}.
+     * @param filters The target filters, if any.
+     * @return One value per aggregate, in order, in its native storage class.
+     *
+     * Unlike @c sum() and @c average(), SUM, AVG, MIN and MAX of no non-NULL values are NULL.
+     */
+    virtual SqlRow aggregate(const std::string& table, const Aggregates& aggregates, const KeyValues& filters = {})
+        = 0;
+
+    /**
+     * @brief Compute several aggregates over each group of rows sharing the same values in some columns.
+     * @param table The target table.
+     * @param groupBy The columns whose values define the groups.
+     * @param aggregates The aggregates to compute for each group.
+     * @param filters The target filters, if any, applied before grouping.
+     * @return One row per group: the values of @arg groupBy, followed by one value per aggregate.
+     */
+    virtual SqlRows aggregate(const std::string& table,
+                              const std::vector<std::string>& groupBy,
+                              const Aggregates& aggregates,
+                              const KeyValues& filters = {})
+        = 0;
 };
 
 } // namespace sqlite_wrapper
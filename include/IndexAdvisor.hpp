@@ -0,0 +1,100 @@
+#pragma once
+
+#include "ConnectionOptions.hpp"
+#include "Filter.hpp"
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace sqlite_wrapper
+{
+
+/**
+ * @class IndexAdvisor
+ * @brief Finds the statement shapes that scan tables in full, and the indexes that would avoid the scans.
+ *
+ * A @c Connection reports every filtered read and write to the advisor. The first time a statement shape
+ * (its SQL text, with placeholders) is seen, the connection explains it and the advisor learns whether it
+ * scans a table, and which columns it filters on; later calls of the shape only increment its counters.
+ *
+ * For shapes scanning a table at least @c IndexAdvisorOptions::minFullScans times, the advisor recommends
+ * an index on the equality-filtered columns, then on one range-filtered column, then on the read columns,
+ * so that the index also covers the read when possible.
+ */
+class IndexAdvisor
+{
+public:
+    /**
+     * Columns a statement filters on, and reads.
+     */
+    struct Columns
+    {
+        std::vector<std::string> equality; // compared with =, IN or IS NULL
+        std::vector<std::string> range;    // compared with <, <=, >, >=, BETWEEN or LIKE
+        std::vector<std::string> output;
+    };
+
+    struct Advice
+    {
+        std::string table;
+        std::vector<std::string> columns;
+        std::uint64_t fullScans{0}; // calls that scanned the table, across the shapes the index serves
+        std::string sql;            // CREATE INDEX statement
+    };
+
+    explicit IndexAdvisor(const IndexAdvisorOptions& options);
+
+    IndexAdvisor(const IndexAdvisor&)            = delete;
+    IndexAdvisor& operator=(const IndexAdvisor&) = delete;
+
+    /**
+     * @brief Count a call of a statement shape.
+     * @return True if the shape is known, false if it must be learned.
+     */
+    bool record(const std::string& sql);
+
+    /**
+     * @brief Learn a statement shape, and count its first call.
+     */
+    void learn(const std::string& sql, const std::string& table, Columns columns, bool fullScan);
+
+    /**
+     * @brief Get the recommended indexes.
+     * @return One entry per distinct table and column list, the most needed first.
+     */
+    std::vector<Advice> advice() const;
+
+    /**
+     * @brief Forget all shapes, e.g. once indexes are created and plans change.
+     */
+    void clear();
+
+    /**
+     * @brief Get the columns filtered on by the top-level AND conditions of a filter, and read by a statement.
+     * @param filter The statement filter; conditions under OR and NOT are ignored.
+     * @param col The read column: "*" and expressions are ignored.
+     */
+    static Columns FilterColumns(const Filter& filter, const std::string& col);
+
+private:
+    struct Shape
+    {
+        std::string table;
+        Columns columns;
+        bool fullScan{false};
+        std::uint64_t calls{0};
+    };
+
+    static std::vector<std::string> IndexColumns(const Columns& columns);
+    static std::string SqlCreateIndex(const std::string& table, const std::vector<std::string>& columns);
+
+    const IndexAdvisorOptions mOptions;
+
+    mutable std::mutex mMutex;
+    std::unordered_map<std::string, Shape> mShapes; // by SQL text
+};
+
+} // namespace sqlite_wrapper
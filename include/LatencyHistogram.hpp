@@ -0,0 +1,84 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace sqlite_wrapper
+{
+
+/**
+ * @class LatencyHistogram
+ * @brief Lock-free histogram of durations, with log-linear buckets in the style of HdrHistogram.
+ *
+ * Durations are counted in nanoseconds. Each power of two is split into @c kSubBuckets linear buckets,
+ * so a recorded value is known within 1/kSubBuckets of its magnitude, from 1 ns up to about 18 minutes;
+ * longer durations are counted in the last bucket. Recording is a handful of relaxed atomic operations,
+ * and can happen concurrently from any number of threads; a histogram recorded into by a single thread can use
+ * @c recordExclusive() instead, which avoids read-modify-write operations, and be merged with others when read.
+ */
+class LatencyHistogram
+{
+public:
+    static constexpr std::size_t kSubBucketBits = 3;
+    static constexpr std::size_t kSubBuckets    = 1u << kSubBucketBits;
+    static constexpr std::size_t kMaxExponent   = 40; // durations from 2^kMaxExponent ns are counted as overflows
+
+    // the last bucket counts overflows
+    static constexpr std::size_t kBucketCount = (kMaxExponent - kSubBucketBits + 1) * kSubBuckets + 1;
+
+    /**
+     * @struct Snapshot
+     * @brief Copy of the histogram counters, taken while recording may still be going on.
+     */
+    struct Snapshot
+    {
+        std::uint64_t count{0};
+        std::chrono::nanoseconds total{};
+        std::chrono::nanoseconds max{};
+        std::vector<std::uint64_t> buckets; // counts, indexed like LatencyHistogram buckets
+
+        std::chrono::nanoseconds mean() const;
+
+        /**
+         * @brief Add the durations counted by another snapshot, e.g. of the histogram of another thread.
+         */
+        void add(const Snapshot& other);
+
+        /**
+         * @brief Get an upper bound of the given percentile.
+         * @param percentile In [0, 100].
+         * @return The upper bound of the bucket holding the percentile, capped to the max recorded value.
+         */
+        std::chrono::nanoseconds percentile(double percentile) const;
+    };
+
+    void record(std::chrono::nanoseconds duration);
+
+    /**
+     * @brief Record a duration, from the only thread recording into the histogram; it may still be read concurrently.
+     */
+    void recordExclusive(std::chrono::nanoseconds duration);
+
+    Snapshot snapshot() const;
+
+    /**
+     * @brief Get the smallest duration counted in a bucket.
+     */
+    static std::uint64_t BucketLowerBound(std::size_t index);
+
+    /**
+     * @brief Get the index of the bucket counting a duration, in nanoseconds.
+     */
+    static std::size_t BucketIndex(std::uint64_t nanoseconds);
+
+private:
+    std::array<std::atomic<std::uint64_t>, kBucketCount> mBuckets{}; // also give the count, when summed
+    std::atomic<std::uint64_t> mTotal{0};
+    std::atomic<std::uint64_t> mMax{0};
+};
+
+} // namespace sqlite_wrapper
@@ -0,0 +1,94 @@
+#pragma once
+
+#include "SqliteTypes.hpp"
+
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace sqlite_wrapper
+{
+
+/**
+ * @struct QueryOptions
+ * @brief Projection, ordering and bounds of the rows returned by @c IConnection::query().
+ */
+struct QueryOptions
+{
+    struct Order
+    {
+        std::string col;
+        bool descending{false};
+    };
+
+    // Columns (or expressions) to return, in order; all columns if empty
+    std::vector<std::string> columns;
+
+    // Sort keys, most significant first; SQLite's unspecified order if empty
+    std::vector<Order> orderBy;
+
+    std::optional<std::size_t> limit;
+
+    // Rows skipped before the first one returned: they are still read, so deep offsets are slow,
+    // see @c PageOptions for paging that is not
+    std::size_t offset{0};
+};
+
+/**
+ * @struct PageOptions
+ * @brief Keyset pagination of the rows returned by @c IConnection::queryPage().
+ *
+ * Rows are ordered by @c key, then by rowid to break ties, and each page starts right after the last row of
+ * the previous one, through a seek on that key rather than an OFFSET. With an index on @c key (or for the
+ * rowid itself), every page costs O(page size), however deep it is. Rows inserted or deleted meanwhile are
+ * seen, or not, depending on where they fall relative to the pages already read.
+ *
+ * The table must have a rowid, and @c key should not be NULL, as NULL never compares after a page's end.
+ */
+struct PageOptions
+{
+    static constexpr std::size_t kDefaultPageSize = 100;
+
+    std::string key{"rowid"};
+    bool descending{false};
+
+    std::size_t pageSize{kDefaultPageSize}; // must be at least 1
+
+    // Columns (or expressions) to return, in order; all columns if empty
+    std::vector<std::string> columns;
+
+    /**
+     * @brief Get the columns the pages are ordered by, and seek on: @c key, and the rowid unless it is the key.
+     */
+    std::vector<std::string> seekColumns() const
+    {
+        if (key == "rowid")
+        {
+            return {key};
+        }
+
+        return {key, "rowid"};
+    }
+};
+
+/**
+ * @struct PageToken
+ * @brief Where a page ended: pass it back to @c IConnection::queryPage() to get the next page.
+ */
+struct PageToken
+{
+    SqlRow after; // values of @c PageOptions::seekColumns() in the page's last row
+};
+
+/**
+ * @struct Page
+ * @brief One page of rows returned by @c IConnection::queryPage().
+ */
+struct Page
+{
+    Rows rows;
+    std::optional<PageToken> next; // std::nullopt if this is the last page
+};
+
+} // namespace sqlite_wrapper
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+namespace sqlite_wrapper
+{
+
+/**
+ * @struct QueryPlan
+ * @brief How SQLite executes a statement, as reported by EXPLAIN QUERY PLAN.
+ *
+ * See https://www.sqlite.org/eqp.html. Each step is one line of the report, parsed into how it accesses a table:
+ * a SCAN visits every row of the table (or of an index), while a SEARCH only visits the rows matching
+ * constraints on an index or on the rowid.
+ */
+struct QueryPlan
+{
+    struct Step
+    {
+        enum class Access
+        {
+            Scan,
+            Search,
+            Other // temporary B-trees, subqueries, compound queries, ...
+        };
+
+        int id{0};
+        int parent{0}; // id of the step this one is nested in; 0 at the top level
+        std::string detail;
+
+        Access access{Access::Other};
+        std::string table;          // set for scans and searches
+        std::string index;          // index used, "INTEGER PRIMARY KEY" for the rowid, or empty
+        bool coveringIndex{false};  // the table itself is not read, only the index
+        bool automaticIndex{false}; // built by SQLite for this statement only: an index is missing
+    };
+
+    std::vector<Step> steps;
+
+    /**
+     * @brief Parse the detail text of an EXPLAIN QUERY PLAN line.
+     * @return The step, with @c id and @c parent left to be set by the caller.
+     */
+    static Step ParseStep(const std::string& detail);
+
+    /**
+     * @brief Check whether any table is read in full, through a SCAN or an automatic index.
+     */
+    bool fullScan() const;
+
+    /**
+     * @brief Format the plan as an indented tree, one step per line, as the sqlite3 shell prints it.
+     */
+    std::string toString() const;
+};
+
+} // namespace sqlite_wrapper
@@ -0,0 +1,98 @@
+#pragma once
+
+#include "ConnectionOptions.hpp"
+
+#include <sqlite3.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace sqlite_wrapper
+{
+
+/**
+ * @class QueryProfiler
+ * @brief Profiles every statement run on a connection, through sqlite3_trace_v2(SQLITE_TRACE_PROFILE).
+ *
+ * For each completed statement, SQLite reports its wall time, and the statement's counters
+ * (see https://www.sqlite.org/c3ref/c_stmtstatus_counter.html) are read and reset. Totals are kept for all
+ * statements, while the ones taking at least @c ProfilerOptions::slowQueryThreshold are recorded, with their
+ * SQL, in a fixed-size ring buffer: the slow-query log, which keeps the most recent ones.
+ */
+class QueryProfiler
+{
+public:
+    struct Entry
+    {
+        std::chrono::system_clock::time_point time; // when the statement completed
+        std::string sql;
+        std::chrono::nanoseconds duration{};
+        std::uint64_t fullScanSteps{0}; // table rows stepped through outside of an index
+        std::uint64_t sorts{0};
+        std::uint64_t autoIndexes{0}; // rows inserted into automatic, i.e. missing, indexes
+        std::uint64_t vmSteps{0};
+    };
+
+    struct Stats
+    {
+        std::uint64_t statements{0};
+        std::uint64_t slowStatements{0};
+        std::chrono::nanoseconds totalTime{};
+        std::uint64_t fullScanSteps{0};
+        std::uint64_t sorts{0};
+        std::uint64_t autoIndexes{0};
+        std::uint64_t vmSteps{0};
+    };
+
+    explicit QueryProfiler(const ProfilerOptions& options);
+
+    QueryProfiler(const QueryProfiler&)            = delete;
+    QueryProfiler& operator=(const QueryProfiler&) = delete;
+
+    /**
+     * @brief Start profiling the statements of a connection; must be called again if it is reopened.
+     */
+    void attach(sqlite3* db);
+
+    /**
+     * @brief Get the slow-query log.
+     * @return The logged statements, oldest first.
+     */
+    std::vector<Entry> slowQueries() const;
+
+    /**
+     * @brief Write the slow-query log, one statement per line, oldest first.
+     */
+    void dump(std::ostream& out) const;
+
+    void clear();
+
+    Stats stats() const;
+
+private:
+    static int TraceCallback(unsigned type, void* context, void* statement, void* nanoseconds);
+
+    void profile(sqlite3_stmt* statement, std::chrono::nanoseconds duration);
+
+    const ProfilerOptions mOptions;
+
+    std::atomic<std::uint64_t> mStatements{0};
+    std::atomic<std::uint64_t> mTotalTime{0};
+    std::atomic<std::uint64_t> mFullScanSteps{0};
+    std::atomic<std::uint64_t> mSorts{0};
+    std::atomic<std::uint64_t> mAutoIndexes{0};
+    std::atomic<std::uint64_t> mVmSteps{0};
+
+    mutable std::mutex mLogMutex;
+    std::vector<Entry> mLog; // ring buffer
+    std::size_t mNext{0};    // where the next entry goes
+    std::uint64_t mSlowStatements{0};
+};
+
+} // namespace sqlite_wrapper
@@ -0,0 +1,159 @@
+#pragma once
+
+#include "ConnectionOptions.hpp"
+#include "SqliteTypes.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <variant>
+
+namespace sqlite_wrapper
+{
+
+/**
+ * @class ResultCache
+ * @brief Bounded LRU cache of query results for a single DB connection, invalidated per table.
+ *
+ * Results are keyed by their SQL together with its bound values, and tagged with the version of the table they
+ * were read from. Writes bump the version of their table, as reported by sqlite3_update_hook(), so results read
+ * before are dropped on their next lookup; a result read while a write was under way is thereby never served.
+ * Rollbacks, schema changes and commits by other connections can't be attributed to a table, so they bump the
+ * version of all tables at once.
+ *
+ * Tables are matched by name as SQLite does, so a query naming @c main."Users" and a write reported on @c users
+ * share a version: see @c TableKey().
+ *
+ * When the estimated memory use of the cached results exceeds @c ResultCacheOptions::maxBytes, the least
+ * recently used ones are evicted.
+ */
+class ResultCache
+{
+public:
+    using Result = std::variant<Rows, std::int64_t, double>;
+
+    struct Version
+    {
+        std::uint64_t epoch{0}; // bumped for all tables at once
+        std::uint64_t table{0}; // bumped by writes to the table
+
+        bool operator==(const Version& other) const
+        {
+            return epoch == other.epoch && table == other.table;
+        }
+    };
+
+    struct Stats
+    {
+        std::size_t hits{0};
+        std::size_t misses{0};
+        std::size_t evictions{0};     // results dropped to stay within maxBytes
+        std::size_t invalidations{0}; // results dropped because their table changed
+        std::size_t entries{0};
+        std::size_t bytes{0};
+        std::size_t maxBytes{0};
+
+        double hitRatio() const
+        {
+            return hits + misses == 0 ? 0.0 : static_cast<double>(hits) / static_cast<double>(hits + misses);
+        }
+    };
+
+    explicit ResultCache(const ResultCacheOptions& options);
+
+    ResultCache(const ResultCache&)            = delete;
+    ResultCache& operator=(const ResultCache&) = delete;
+
+    /**
+     * @brief Get the key of a query: its SQL and bound values.
+     */
+    static std::string Key(const ParameterizedSql& sql);
+
+    /**
+     * @brief Get the key of a table name, as spelled in SQL or reported by sqlite3_update_hook(): the name
+     * without its schema prefix nor quotes, in ASCII lowercase.
+     *
+     * Tables of the same name in attached schemas share a key, so writes to one invalidate the results of all.
+     */
+    static std::string TableKey(std::string_view table);
+
+    /**
+     * @brief Get the current version of a table, to be passed to @c put() with a result read from it.
+     */
+    Version version(const std::string& table) const;
+
+    /**
+     * @brief Get a cached result, unless its table changed since it was read.
+     * @param key The query key.
+     * @param table The table the query reads from.
+     * @return The result, or std::nullopt on a miss.
+     */
+    std::optional<Result> get(const std::string& key, const std::string& table);
+
+    /**
+     * @brief Cache a result; it is dropped right away if its table changed since @arg version.
+     * @param key The query key.
+     * @param table The table the query reads from.
+     * @param version The version of the table obtained before running the query.
+     * @param result The result.
+     */
+    void put(std::string key, const std::string& table, const Version& version, Result result);
+
+    /**
+     * @brief Invalidate the results read from a table.
+     */
+    void invalidate(const char* table);
+
+    /**
+     * @brief Invalidate all results.
+     */
+    void invalidateAll();
+
+    /**
+     * @brief Invalidate all results if @c PRAGMA data_version changed since the last check.
+     * @param dataVersion The current value of @c PRAGMA data_version.
+     */
+    void checkDataVersion(std::int64_t dataVersion);
+
+    /**
+     * @brief Drop all results, and reset the counters.
+     */
+    void clear();
+
+    Stats stats() const;
+
+private:
+    struct Entry
+    {
+        std::string key;
+        std::string table;
+        Version version;
+        Result result;
+        std::size_t bytes;
+    };
+
+    using Entries = std::list<Entry>;
+
+    static std::size_t EstimateBytes(const Entry& entry);
+
+    Version currentVersion(const std::string& tableKey) const;
+    void erase(Entries::iterator entry);
+    void evict();
+
+    const ResultCacheOptions mOptions;
+
+    mutable std::mutex mMutex;
+    Entries mEntries; // most recently used first
+    std::unordered_map<std::string, Entries::iterator> mIndex;
+    std::unordered_map<std::string, std::uint64_t> mTableVersions;
+    std::uint64_t mEpoch{0};
+    std::optional<std::int64_t> mDataVersion;
+    Stats mStats;
+};
+
+} // namespace sqlite_wrapper
@@ -0,0 +1,163 @@
+#pragma once
+
+#include "RowCursor.hpp"
+#include "SqliteTypes.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+namespace sqlite_wrapper
+{
+
+class ResultSet;
+
+/**
+ * @class RowView
+ * @brief Non-owning view of a row stored in a @c ResultSet.
+ *
+ * Views are valid until the @c ResultSet they refer to is modified or destroyed.
+ */
+class RowView
+{
+public:
+    RowView(const ResultSet& resultSet, std::size_t row);
+
+    std::size_t size() const;
+    bool isNull(std::size_t col) const;
+
+    /**
+     * @brief Get a column as text.
+     * @param col The 0-based column index.
+     * @return A view of the column text, or @c std::nullopt if the column is NULL.
+     */
+    std::optional<std::string_view> operator[](std::size_t col) const;
+
+    /**
+     * @brief Get a column as text; NULL reads as an empty view.
+     */
+    std::string_view text(std::size_t col) const;
+
+    /**
+     * @brief Copy the row into the string-based @c Row representation.
+     */
+    Row toRow() const;
+
+private:
+    const ResultSet* mResultSet;
+    std::size_t mRow;
+};
+
+/**
+ * @class ResultSet
+ * @brief Materialized query result with all cell bytes stored contiguously.
+ *
+ * Cell values are kept in their text representation (as @c sqlite3_column_text() produces it) in a single
+ * growable byte arena. Cells are located through one offsets array and a NULL bitmap, both indexed
+ * by row * columns + column, so filling a result set costs a handful of amortized allocations regardless
+ * of the number of rows, rather than one per row and per cell as with @c Rows.
+ *
+ * A @c ResultSet can be refilled: @c reset() drops the rows but keeps the allocated capacity.
+ */
+class ResultSet
+{
+public:
+    /**
+     * @class Iterator
+     * @brief Input iterator over the rows; dereferencing yields a @c RowView by value, which the forward iterator
+     * requirements don't allow, though the rows can be iterated over several times.
+     *
+     * @c operator+ and @c operator- jump and measure in constant time.
+     */
+    class Iterator
+    {
+    public:
+        using iterator_category = std::input_iterator_tag;
+        using value_type        = RowView;
+        using difference_type   = std::ptrdiff_t;
+        using pointer           = void;
+        using reference         = RowView;
+
+        Iterator() = default;
+        Iterator(const ResultSet& resultSet, std::size_t row);
+
+        RowView operator*() const;
+        Iterator& operator++();
+        Iterator operator++(int);
+        Iterator operator+(difference_type n) const;
+        difference_type operator-(const Iterator& other) const;
+
+        bool operator==(const Iterator& other) const;
+        bool operator!=(const Iterator& other) const;
+
+    private:
+        const ResultSet* mResultSet{nullptr};
+        std::size_t mRow{0};
+    };
+
+    ResultSet() = default;
+    explicit ResultSet(std::size_t columns);
+
+    /**
+     * @brief Remove all rows, keeping the allocated memory, and set the number of columns.
+     */
+    void reset(std::size_t columns);
+
+    /**
+     * @brief Pre-allocate memory.
+     * @param rows The expected number of rows.
+     * @param bytes The expected total size of the cell values.
+     */
+    void reserve(std::size_t rows, std::size_t bytes);
+
+    /**
+     * @brief Append the current row of a cursor.
+     *
+     * The row must have as many columns as the result set.
+     */
+    void append(const CursorRow& row);
+
+    /**
+     * @brief Append a row in the string-based @c Row representation.
+     *
+     * The row must have as many columns as the result set.
+     */
+    void append(const Row& row);
+
+    std::size_t size() const;
+    std::size_t columns() const;
+    bool empty() const;
+
+    /**
+     * @brief Get the total size of the cell values, in bytes.
+     */
+    std::size_t bytes() const;
+
+    RowView operator[](std::size_t row) const;
+
+    Iterator begin() const;
+    Iterator end() const;
+
+    /**
+     * @brief Copy all rows into the string-based @c Rows representation.
+     */
+    Rows toRows() const;
+
+private:
+    friend class RowView;
+
+    void appendCell(std::optional<std::string_view> value);
+
+    bool isNull(std::size_t cell) const;
+    std::string_view cell(std::size_t cell) const;
+
+    std::size_t mColumns{0};
+    std::vector<char> mArena;
+    std::vector<std::size_t> mOffsets{0}; // cell i spans [mOffsets[i], mOffsets[i + 1])
+    std::vector<std::uint64_t> mNulls;    // bit i is set if cell i is NULL
+};
+
+} // namespace sqlite_wrapper
@@ -0,0 +1,150 @@
+#pragma once
+
+#include "SqliteTypes.hpp"
+#include "Statement.hpp"
+
+#include <sqlite3.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <optional>
+#include <string_view>
+
+namespace sqlite_wrapper
+{
+
+/**
+ * @class CursorRow
+ * @brief Non-owning view of the current result row of a @c RowCursor.
+ *
+ * Views returned by the accessors point into SQLite's own buffers and are only valid
+ * until the cursor advances or is closed.
+ */
+class CursorRow
+{
+public:
+    explicit CursorRow(sqlite3_stmt* stmt = nullptr);
+
+    /**
+     * @brief Get the number of columns in the row.
+     */
+    int size() const;
+
+    bool isNull(int col) const;
+
+    /**
+     * @brief Get a column as text, without copying it.
+     * @param col The 0-based column index.
+     * @return A view of the column text, or @c std::nullopt if the column is NULL.
+     */
+    std::optional<std::string_view> operator[](int col) const;
+
+    /**
+     * @brief Get a column as text, without copying it; NULL reads as an empty view.
+     */
+    std::string_view text(int col) const;
+
+    std::int64_t integer(int col) const;
+    double real(int col) const;
+
+    /**
+     * @brief Get an owning copy of a column, in its native storage class.
+     */
+    SqlValue value(int col) const;
+
+private:
+    sqlite3_stmt* mStmt;
+};
+
+/**
+ * @class RowCursor
+ * @brief Steps through the result rows of a query lazily, one row at a time.
+ *
+ * Rows are not materialized: only the current row is available, through a @c CursorRow,
+ * so a scan runs in constant memory regardless of the result size. Iteration can be stopped at any point;
+ * the statement is reset and handed back to the connection as soon as the last row has been read,
+ * @c close() is called or the cursor is destroyed.
+ *
+ * Until then the statement keeps its read transaction open, so cursors should not be kept around longer
+ * than needed. A @c RowCursor must only be used by one thread at a time.
+ *
+ * Example:
+ *
+ *    for (const auto& row : connection.selectCursor("table"))
+ *    {
+ *        if (row.text(0) == "needle")
+ *            break;
+ *    }
+ */
+class RowCursor
+{
+public:
+    class Iterator
+    {
+    public:
+        using iterator_category = std::input_iterator_tag;
+        using value_type        = CursorRow;
+        using difference_type   = std::ptrdiff_t;
+        using pointer           = const CursorRow*;
+        using reference         = const CursorRow&;
+
+        explicit Iterator(RowCursor* cursor = nullptr);
+
+        reference operator*() const;
+        pointer operator->() const;
+        Iterator& operator++();
+
+        bool operator==(const Iterator& other) const;
+        bool operator!=(const Iterator& other) const;
+
+    private:
+        bool atEnd() const;
+
+        RowCursor* mCursor;
+    };
+
+    RowCursor() = default;
+    explicit RowCursor(Statement statement);
+
+    RowCursor(RowCursor&& other) noexcept;
+    RowCursor& operator=(RowCursor&& other) noexcept;
+    ~RowCursor();
+
+    /**
+     * @brief Advance to the next row; the first call moves to the first row.
+     * @return True if a row is available, false once all rows have been read.
+     */
+    bool next();
+
+    /**
+     * @brief Get the current row.
+     */
+    const CursorRow& row() const;
+
+    /**
+     * @brief Keep a resource alive until the cursor is closed, e.g. the connection its statement belongs to.
+     * @param resource The resource, released right after the statement is handed back.
+     */
+    void retain(std::shared_ptr<void> resource);
+
+    /**
+     * @brief Stop iterating and hand the statement back, even if there are rows left.
+     */
+    void close();
+
+    bool done() const;
+
+    Iterator begin();
+    Iterator end();
+
+private:
+    std::shared_ptr<void> mRetained; // declared first, so it outlives the statement
+    Statement mStatement;
+    CursorRow mRow;
+    bool mStarted{false};
+    bool mDone{true};
+};
+
+} // namespace sqlite_wrapper
@@ -0,0 +1,132 @@
+#pragma once
+
+#include "Statement.hpp"
+#include "StringUtils.hpp"
+#include "Table.hpp"
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+namespace sqlite_wrapper
+{
+
+/**
+ * @brief A member of a struct, mapped to the DB column of the same values.
+ */
+template<typename TStruct, typename TField>
+struct Field
+{
+    constexpr Field(std::string_view name, TField TStruct::*member)
+        : name{name}
+        , member{member}
+    {
+    }
+
+    std::string_view name;
+    TField TStruct::*member;
+};
+
+/**
+ * @brief Declares how the struct @c T maps to DB columns; to be specialized for each mapped struct.
+ *
+ * A specialization lists the mapped members, in column order, as a tuple of @c Field:
+ * @code
+ * template<>
+ * struct RowMapping<User>
+ * {
+ *     static constexpr auto kFields = std::make_tuple(Field{"id", &User::id}, Field{"name", &User::name});
+ * };
+ * @endcode
+ *
+ * Member types must be supported by @c ColumnTraits.
+ */
+template<typename T>
+struct RowMapping;
+
+template<typename T, typename = void>
+inline constexpr bool kHasRowMapping = false;
+
+template<typename T>
+inline constexpr bool kHasRowMapping<T, std::void_t<decltype(RowMapping<T>::kFields)>> = true;
+
+/**
+ * @class RowMapper
+ * @brief Binds the members of a struct declared by @c RowMapping<T>, and reads them from result columns,
+ * without going through @c Row or @c KeyValues.
+ */
+template<typename T>
+class RowMapper
+{
+public:
+    static_assert(kHasRowMapping<T>, "RowMapping<T> is not specialized for this type");
+
+    static constexpr std::size_t kFieldCount = std::tuple_size_v<std::decay_t<decltype(RowMapping<T>::kFields)>>;
+
+    /**
+     * @brief Get the names of the mapped columns, in order.
+     */
+    static const std::vector<std::string>& Columns()
+    {
+        static const std::vector<std::string> columns = std::apply(
+            [](const auto&... field) { return std::vector<std::string>{std::string{field.name}...}; },
+            RowMapping<T>::kFields);
+        return columns;
+    }
+
+    /**
+     * @brief Get the names of the mapped columns, as a comma-separated list.
+     */
+    static const std::string& ColumnList()
+    {
+        static const std::string columnList = StringUtils::Join(Columns());
+        return columnList;
+    }
+
+    /**
+     * @brief Bind the mapped members of a struct to consecutive statement placeholders.
+     * @param statement The statement to bind the members to.
+     * @param value The struct to bind.
+     * @param firstIndex The 1-based index of the placeholder to bind the first member to.
+     */
+    static void Bind(Statement& statement, const T& value, int firstIndex = 1)
+    {
+        std::apply(
+            [&statement, &value, index = firstIndex](const auto&... field) mutable
+            { (BindField(statement, index++, value.*field.member), ...); },
+            RowMapping<T>::kFields);
+    }
+
+    /**
+     * @brief Read the mapped members of a struct from the current result row, one column per member, in order.
+     * @param statement The statement positioned on a result row.
+     * @return The struct read, with any members not mapped default-initialized.
+     */
+    static T Read(const Statement& statement)
+    {
+        T value{};
+        std::apply(
+            [&statement, &value, index = 0](const auto&... field) mutable
+            { (ReadField(statement, index++, value.*field.member), ...); },
+            RowMapping<T>::kFields);
+        return value;
+    }
+
+private:
+    template<typename TField>
+    static void BindField(Statement& statement, int index, const TField& field)
+    {
+        ColumnTraits<TField>::Bind(statement, index, field);
+    }
+
+    template<typename TField>
+    static void ReadField(const Statement& statement, int index, TField& field)
+    {
+        field = ColumnTraits<TField>::Read(statement, index);
+    }
+};
+
+} // namespace sqlite_wrapper
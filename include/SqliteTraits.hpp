@@ -1,8 +1,11 @@
 #pragma once
 
+#include "Filter.hpp"
+#include "QueryOptions.hpp"
 #include "SqliteTypes.hpp"
 
 #include <cstddef>
+#include <optional>
 #include <string>
 #include <vector>
 
@@ -22,6 +25,61 @@ public:
     static std::string SqlAvg(const std::string& table, const std::string& col, const KeyValues& filters = {});
 
     static std::string SqlInsertWithPlaceholders(const std::string& table, const std::size_t& count, bool replace);
+    static std::string SqlInsertWithPlaceholders(const std::string& table,
+                                                 const std::vector<std::string>& columns,
+                                                 std::size_t count,
+                                                 ConflictPolicy policy);
+    static std::string SqlUpsertWithPlaceholders(const std::string& table,
+                                                 const std::vector<std::string>& columns,
+                                                 std::size_t count,
+                                                 const std::vector<std::string>& conflictColumns,
+                                                 const std::vector<std::string>& updateColumns);
+
+    static std::string SqlPragma(const std::string& name, const std::string& value);
+    static std::string SqlBeginTransaction(TransactionMode mode);
+
+    // Parameterized variants: values are replaced by '?' placeholders and returned, in binding order,
+    // alongside the SQL. The SQL text then only depends on the shape of the query.
+    static ParameterizedSql
+    SqlSelectParameterized(const std::string& table, const std::string& col, const KeyValues& filters = {});
+    static ParameterizedSql SqlInsertParameterized(const std::string& table, const KeyValues& keyValues, bool replace);
+    static ParameterizedSql SqlUpsertParameterized(const std::string& table,
+                                                   const KeyValues& keyValues,
+                                                   const std::vector<std::string>& conflictColumns,
+                                                   const std::vector<std::string>& updateColumns);
+    static ParameterizedSql
+    SqlUpdateParameterized(const std::string& table, const KeyValues& keyValues, const KeyValues& filters = {});
+    static ParameterizedSql SqlDeleteParameterized(const std::string& table, const KeyValues& filters = {});
+
+    static ParameterizedSql
+    SqlCountParameterized(const std::string& table, const std::string& col, const KeyValues& filters = {});
+    static ParameterizedSql
+    SqlSumParameterized(const std::string& table, const std::string& col, const KeyValues& filters = {});
+    static ParameterizedSql
+    SqlAvgParameterized(const std::string& table, const std::string& col, const KeyValues& filters = {});
+
+    // Filter variants of the above
+    static ParameterizedSql
+    SqlSelectParameterized(const std::string& table, const std::string& col, const Filter& filter);
+    static ParameterizedSql
+    SqlUpdateParameterized(const std::string& table, const KeyValues& keyValues, const Filter& filter);
+    static ParameterizedSql SqlDeleteParameterized(const std::string& table, const Filter& filter);
+    static ParameterizedSql
+    SqlCountParameterized(const std::string& table, const std::string& col, const Filter& filter);
+    static ParameterizedSql SqlSumParameterized(const std::string& table, const std::string& col, const Filter& filter);
+    static ParameterizedSql SqlAvgParameterized(const std::string& table, const std::string& col, const Filter& filter);
+
+    static ParameterizedSql
+    SqlQueryParameterized(const std::string& table, const QueryOptions& options, const Filter& filter);
+    static ParameterizedSql SqlPageParameterized(const std::string& table,
+                                                 const PageOptions& options,
+                                                 const Filter& filter,
+                                                 const std::optional<PageToken>& after);
+
+    static ParameterizedSql SqlAggregateParameterized(const std::string& table,
+                                                      const std::vector<std::string>& groupBy,
+                                                      const Aggregates& aggregates,
+                                                      const KeyValues& filters = {});
 
     SqliteTraits()                     = delete;
     SqliteTraits(const SqliteTraits&)  = delete;
@@ -41,6 +99,28 @@ private:
 
     static std::string SqlAssignments(const KeyValues& keyValues);
     static std::string SqlAssignment(const KeyValue& kv);
+
+    static ParameterizedSql SqlSelectFunctionParameterized(const std::string& function,
+                                                           const std::string& col,
+                                                           const std::string& table,
+                                                           const KeyValues& filters);
+
+    static ParameterizedSql SqlSelectFunctionParameterized(const std::string& function,
+                                                           const std::string& col,
+                                                           const std::string& table,
+                                                           const Filter& filter);
+
+    static std::string SqlFilters(const KeyValues& keyValues, SqlRow& params);
+    static std::string SqlFilter(const KeyValue& kv, SqlRow& params);
+
+    static std::string SqlFilters(const Filter& filter, SqlRow& params);
+    static std::string SqlFilter(const Filter& filter, SqlRow& params);
+
+    static std::string SqlAssignments(const KeyValues& keyValues, SqlRow& params);
+    static std::string SqlAssignment(const KeyValue& kv, SqlRow& params);
+
+    static std::string SqlPlaceholders(std::size_t count);
+    static std::string SqlAggregate(const Aggregate& aggregate);
 };
 
 } // namespace sqlite_wrapper
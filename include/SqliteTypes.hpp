@@ -1,9 +1,13 @@
 #pragma once
 
 #include <chrono>
+#include <cstddef>
+#include <cstdint>
 #include <list>
 #include <optional>
 #include <string>
+#include <type_traits>
+#include <variant>
 #include <vector>
 
 namespace sqlite_wrapper
@@ -17,13 +21,40 @@ using Value = std::optional<std::string>;
 using Row  = std::vector<Value>;
 using Rows = std::vector<Row>;
 
+using Blob = std::vector<std::uint8_t>;
+
+/**
+ * A value in one of the SQLite storage classes: NULL, INTEGER, REAL, TEXT or BLOB.
+ */
+using SqlValue = std::variant<std::nullptr_t, std::int64_t, double, std::string, Blob>;
+
+using SqlRow  = std::vector<SqlValue>;
+using SqlRows = std::vector<SqlRow>;
+
+/**
+ * @brief Check whether a @c SqlValue is NULL.
+ */
+inline bool IsNull(const SqlValue& value)
+{
+    return std::holds_alternative<std::nullptr_t>(value);
+}
+
+/**
+ * @brief Convert a @c SqlValue to its text representation, as @c sqlite3_column_text() would produce it.
+ */
+Value ToValue(const SqlValue& value);
+Value ToValue(SqlValue&& value);
+
+Row ToRow(SqlRow&& row);
+Rows ToRows(SqlRows&& rows);
+
 class KeyValue
 {
 public:
     template<typename T>
     KeyValue(const std::string& key, const T& value)
         : mKey{key}
-        , mValue{ToString(value)}
+        , mValue{ToSqlValue(value)}
     {
     }
 
@@ -33,7 +64,7 @@ public:
     {
         if (value)
         {
-            mValue = ToString(value.value());
+            mValue = ToSqlValue(value.value());
         }
     }
 
@@ -42,49 +73,153 @@ public:
         return mKey;
     }
 
-    const std::optional<std::string>& value() const
+    /**
+     * @brief Get the value in its text representation.
+     */
+    Value value() const
+    {
+        return ToValue(mValue);
+    }
+
+    const SqlValue& sqlValue() const
     {
         return mValue;
     }
 
 private:
-    static std::string ToString(const std::string& value)
+    static SqlValue ToSqlValue(const std::string& value)
     {
         return value;
     }
 
-    static std::string ToString(const char* const value)
+    static SqlValue ToSqlValue(const char* const value)
+    {
+        return std::string{value};
+    }
+
+    static SqlValue ToSqlValue(bool value)
+    {
+        return std::int64_t{value ? 1 : 0};
+    }
+
+    static SqlValue ToSqlValue(const Blob& value)
     {
         return value;
     }
 
-    static std::string ToString(bool value)
+    static SqlValue ToSqlValue(const SqlValue& value)
     {
-        return value ? "1" : "0";
+        return value;
     }
 
     template<typename T>
-    static std::string ToString(const T& value)
+    static SqlValue ToSqlValue(const T& value)
     {
-        return std::to_string(value);
+        static_assert(std::is_arithmetic<T>::value, "unsupported value type");
+
+        if constexpr (std::is_floating_point<T>::value)
+        {
+            return static_cast<double>(value);
+        }
+        else
+        {
+            return static_cast<std::int64_t>(value);
+        }
     }
 
     template<typename Rep, typename Per>
-    static std::string ToString(const std::chrono::duration<Rep, Per>& value)
+    static SqlValue ToSqlValue(const std::chrono::duration<Rep, Per>& value)
     {
-        return std::to_string(value.count());
+        return ToSqlValue(value.count());
     }
 
     template<typename TClock>
-    static std::string ToString(const std::chrono::time_point<TClock>& value)
+    static SqlValue ToSqlValue(const std::chrono::time_point<TClock>& value)
     {
-        return ToString(std::chrono::duration_cast<std::chrono::seconds>(value.time_since_epoch()));
+        return ToSqlValue(std::chrono::duration_cast<std::chrono::seconds>(value.time_since_epoch()));
     }
 
     std::string mKey;
-    std::optional<std::string> mValue;
+    SqlValue mValue;
 };
 
 using KeyValues = std::list<KeyValue>;
 
+/**
+ * How an INSERT resolves a row violating a uniqueness constraint.
+ */
+enum class ConflictPolicy
+{
+    Abort,   // fail the statement: plain INSERT
+    Replace, // delete the conflicting rows first: INSERT OR REPLACE
+    Ignore   // skip the row: INSERT OR IGNORE
+};
+
+/**
+ * How a transaction acquires the DB locks (https://www.sqlite.org/lang_transaction.html).
+ */
+enum class TransactionMode
+{
+    Deferred,  // on first access: a read lock on the first read, the write lock on the first write
+    Immediate, // the write lock right away, so that later writes can't fail with SQLITE_BUSY
+    Exclusive  // the write lock right away; also blocks readers outside of WAL mode
+};
+
+/**
+ * An aggregate function over a column, as computed by @c IConnection::aggregate().
+ */
+struct Aggregate
+{
+    enum class Function
+    {
+        Count,
+        Sum,
+        Avg,
+        Min,
+        Max
+    };
+
+    Function function;
+    std::string col;
+};
+
+using Aggregates = std::vector<Aggregate>;
+
+/**
+ * @brief COUNT(<col>): the number of rows where @arg col is not NULL, or of all rows for "*".
+ */
+inline Aggregate Count(const std::string& col = "*")
+{
+    return {Aggregate::Function::Count, col};
+}
+
+inline Aggregate Sum(const std::string& col)
+{
+    return {Aggregate::Function::Sum, col};
+}
+
+inline Aggregate Avg(const std::string& col)
+{
+    return {Aggregate::Function::Avg, col};
+}
+
+inline Aggregate Min(const std::string& col)
+{
+    return {Aggregate::Function::Min, col};
+}
+
+inline Aggregate Max(const std::string& col)
+{
+    return {Aggregate::Function::Max, col};
+}
+
+/**
+ * SQL statement text using '?' placeholders, along with the values to bind to them, in order.
+ */
+struct ParameterizedSql
+{
+    std::string sql;
+    SqlRow params;
+};
+
 } // namespace sqlite_wrapper
@@ -0,0 +1,125 @@
+#pragma once
+
+#include "SqliteTypes.hpp"
+
+#include <sqlite3.h>
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace sqlite_wrapper
+{
+
+class StatementCache;
+
+/**
+ * @class Statement
+ * @brief Owns a prepared SQLite statement for the duration of a single operation.
+ *
+ * A @c Statement obtained from a @c StatementCache is handed back to that cache when it goes out of scope,
+ * so the underlying @c sqlite3_stmt can be reset and reused by a later call with the same SQL.
+ * Otherwise the statement is finalized.
+ *
+ * A @c Statement must only be used by one thread at a time.
+ */
+class Statement
+{
+public:
+    Statement() = default;
+    Statement(sqlite3_stmt* stmt, std::string sql, StatementCache* cache, std::uint64_t generation);
+    Statement(Statement&& other) noexcept;
+    Statement& operator=(Statement&& other) noexcept;
+    ~Statement();
+
+    Statement(const Statement&)            = delete;
+    Statement& operator=(const Statement&) = delete;
+
+    /**
+     * @brief Get the underlying SQLite statement handle.
+     * @return The statement handle, or nullptr if this @c Statement is empty.
+     */
+    sqlite3_stmt* get() const;
+
+    /**
+     * @brief Get the SQL this statement was prepared from.
+     * @return The SQL statement.
+     */
+    const std::string& sql() const;
+
+    /**
+     * @brief Bind values to the statement placeholders, in order.
+     * @param params The values to bind; @c std::nullopt binds NULL.
+     * @param firstIndex The 1-based index of the placeholder to bind the first value to.
+     *
+     * Throws a @c sqlite::sqlite_exception if a value cannot be bound.
+     */
+    void bind(const Row& params, int firstIndex = 1);
+    void bind(const SqlRow& params);
+
+    /**
+     * @brief Bind a value to a statement placeholder, using its native storage class.
+     * @param index The 1-based placeholder index.
+     * @param value The value to bind.
+     *
+     * Throws a @c sqlite::sqlite_exception if the value cannot be bound.
+     */
+    void bind(int index, const SqlValue& value);
+
+    /**
+     * @brief Bind text to a statement placeholder, copying it.
+     * @param index The 1-based placeholder index.
+     * @param text The text to bind.
+     *
+     * Throws a @c sqlite::sqlite_exception if the text cannot be bound.
+     */
+    void bindText(int index, std::string_view text);
+
+    /**
+     * @brief Bind NULL to a statement placeholder.
+     * @param index The 1-based placeholder index.
+     */
+    void bindNull(int index);
+
+    /**
+     * @brief Evaluate the statement until the next result row is available.
+     * @return True if a row is available, false if the statement has finished executing.
+     *
+     * Throws a @c sqlite::sqlite_exception if SQLite reports an error.
+     */
+    bool step();
+
+    /**
+     * @brief Evaluate the statement until completion, discarding any result rows.
+     */
+    void execute();
+
+    /**
+     * @brief Reset the statement so it can be executed again, keeping its bindings.
+     */
+    void reset();
+
+    /**
+     * @brief Get the number of columns in the result rows.
+     */
+    int columnCount() const;
+
+    /**
+     * @brief Read a column of the current result row in its native storage class.
+     * @param index The 0-based column index.
+     * @return The column value.
+     */
+    SqlValue column(int index) const;
+
+    explicit operator bool() const;
+
+private:
+    void release();
+
+    sqlite3_stmt* mStmt{nullptr};
+    std::string mSql;
+    StatementCache* mCache{nullptr};
+    std::uint64_t mGeneration{0};
+};
+
+} // namespace sqlite_wrapper
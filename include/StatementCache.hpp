@@ -0,0 +1,94 @@
+#pragma once
+
+#include "Statement.hpp"
+
+#include <sqlite3.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace sqlite_wrapper
+{
+
+/**
+ * @class StatementCache
+ * @brief Bounded LRU cache of prepared statements for a single DB connection.
+ *
+ * Statements are keyed by their SQL text. An idle statement is checked out of the cache by @c acquire()
+ * and returned to it, reset and with its bindings cleared, when the resulting @c Statement goes out of scope.
+ * Since checked-out statements are not visible to other callers, concurrent users of the same SQL each
+ * get their own statement; the cache only ever holds idle ones.
+ *
+ * When the number of idle statements exceeds the capacity, the least recently used one is finalized.
+ * A capacity of 0 disables caching.
+ */
+class StatementCache
+{
+public:
+    struct Stats
+    {
+        std::size_t hits{0};
+        std::size_t misses{0};
+        std::size_t evictions{0};
+        std::size_t size{0};
+        std::size_t capacity{0};
+    };
+
+    explicit StatementCache(std::size_t capacity);
+    ~StatementCache();
+
+    StatementCache(const StatementCache&)            = delete;
+    StatementCache& operator=(const StatementCache&) = delete;
+
+    /**
+     * @brief Get a prepared statement for the specified SQL, preparing a new one on a cache miss.
+     * @param db The DB connection the statement belongs to.
+     * @param sql The SQL statement.
+     * @return The prepared statement.
+     *
+     * Throws a @c sqlite::sqlite_exception if the statement cannot be prepared.
+     */
+    Statement acquire(sqlite3* db, const std::string& sql);
+
+    /**
+     * @brief Finalize all idle statements.
+     *
+     * Must be called before the DB connection the statements belong to is closed or replaced.
+     * Statements checked out at that point are finalized, rather than cached, when released.
+     */
+    void clear();
+
+    /**
+     * @brief Get a snapshot of the cache counters.
+     * @return The cache statistics.
+     */
+    Stats stats() const;
+
+private:
+    friend class Statement;
+
+    struct Entry
+    {
+        std::string sql;
+        sqlite3_stmt* stmt;
+    };
+
+    using Entries = std::list<Entry>;
+
+    void release(sqlite3_stmt* stmt, std::string sql, std::uint64_t generation);
+    void evict();
+
+    const std::size_t mCapacity;
+
+    mutable std::mutex mMutex;
+    Entries mEntries; // most recently used first
+    std::unordered_multimap<std::string, Entries::iterator> mIndex;
+    std::uint64_t mGeneration{0};
+    Stats mStats;
+};
+
+} // namespace sqlite_wrapper
@@ -0,0 +1,438 @@
+#pragma once
+
+#include "SqliteTypes.hpp"
+#include "Statement.hpp"
+
+#include <sqlite3.h>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace sqlite_wrapper
+{
+
+/**
+ * @brief Base of a column of a @c Table; @c T is the C++ type its values are bound from and read into.
+ *
+ * A column is declared as a struct deriving from @c Column, naming the column:
+ * @code
+ * struct UserId : Column<std::int64_t> { static constexpr std::string_view kName = "id"; };
+ * @endcode
+ */
+template<typename T>
+struct Column
+{
+    using Type = T;
+};
+
+/**
+ * @brief The columns an UPDATE statement assigns, together with their values.
+ */
+template<typename... TColumns>
+struct Set
+{
+    Set(const typename TColumns::Type&... values)
+        : values{values...}
+    {
+    }
+
+    std::tuple<typename TColumns::Type...> values;
+};
+
+/**
+ * @brief The columns a statement filters on, with equality, together with their values.
+ */
+template<typename... TColumns>
+struct Where
+{
+    Where(const typename TColumns::Type&... values)
+        : values{values...}
+    {
+    }
+
+    std::tuple<typename TColumns::Type...> values;
+};
+
+/**
+ * @brief Binds values of type @c T to statement placeholders, and reads them back from result columns,
+ * using the SQLite storage class matching @c T rather than going through text.
+ *
+ * Supported types are integral and floating-point types, @c std::string, @c Blob, and @c std::optional of those,
+ * where @c std::nullopt stands for NULL.
+ */
+template<typename T, typename = void>
+struct ColumnTraits
+{
+    static_assert(!std::is_same_v<T, T>, "unsupported column type");
+};
+
+template<typename T>
+struct ColumnTraits<T, std::enable_if_t<std::is_integral_v<T>>>
+{
+    static void Bind(Statement& statement, int index, T value)
+    {
+        statement.bind(index, SqlValue{static_cast<std::int64_t>(value)});
+    }
+
+    static T Read(const Statement& statement, int index)
+    {
+        return static_cast<T>(sqlite3_column_int64(statement.get(), index));
+    }
+};
+
+template<typename T>
+struct ColumnTraits<T, std::enable_if_t<std::is_floating_point_v<T>>>
+{
+    static void Bind(Statement& statement, int index, T value)
+    {
+        statement.bind(index, SqlValue{static_cast<double>(value)});
+    }
+
+    static T Read(const Statement& statement, int index)
+    {
+        return static_cast<T>(sqlite3_column_double(statement.get(), index));
+    }
+};
+
+template<>
+struct ColumnTraits<std::string>
+{
+    static void Bind(Statement& statement, int index, const std::string& value)
+    {
+        statement.bindText(index, value);
+    }
+
+    static std::string Read(const Statement& statement, int index)
+    {
+        const auto* text = reinterpret_cast<const char*>(sqlite3_column_text(statement.get(), index));
+        const auto size  = static_cast<std::size_t>(sqlite3_column_bytes(statement.get(), index));
+        return text != nullptr ? std::string{text, size} : std::string{};
+    }
+};
+
+template<>
+struct ColumnTraits<Blob>
+{
+    static void Bind(Statement& statement, int index, const Blob& value)
+    {
+        statement.bind(index, SqlValue{value});
+    }
+
+    static Blob Read(const Statement& statement, int index)
+    {
+        const auto* data = static_cast<const std::uint8_t*>(sqlite3_column_blob(statement.get(), index));
+        const auto size  = static_cast<std::size_t>(sqlite3_column_bytes(statement.get(), index));
+        return data != nullptr ? Blob{data, data + size} : Blob{};
+    }
+};
+
+template<typename T>
+struct ColumnTraits<std::optional<T>>
+{
+    static void Bind(Statement& statement, int index, const std::optional<T>& value)
+    {
+        if (value)
+        {
+            ColumnTraits<T>::Bind(statement, index, *value);
+        }
+        else
+        {
+            statement.bindNull(index);
+        }
+    }
+
+    static std::optional<T> Read(const Statement& statement, int index)
+    {
+        if (sqlite3_column_type(statement.get(), index) == SQLITE_NULL)
+        {
+            return std::nullopt;
+        }
+
+        return ColumnTraits<T>::Read(statement, index);
+    }
+};
+
+/**
+ * @brief Null-terminated SQL text of a known length, built in a constant expression.
+ */
+template<std::size_t N>
+struct SqlText
+{
+    constexpr void append(std::string_view text)
+    {
+        for (const char c : text)
+        {
+            chars[size++] = c;
+        }
+    }
+
+    constexpr std::string_view view() const
+    {
+        return {chars.data(), size};
+    }
+
+    std::array<char, N + 1> chars{};
+    std::size_t size{0};
+};
+
+/**
+ * @brief Counts the characters appended to it; used to size a @c SqlText before writing it.
+ */
+struct SqlLength
+{
+    constexpr void append(std::string_view text)
+    {
+        size += text.size();
+    }
+
+    std::size_t size{0};
+};
+
+/**
+ * @class Table
+ * @brief Compile-time schema of a DB table, generating the SQL of its statements in constant expressions.
+ *
+ * A table is declared by deriving from @c Table, listing its columns and naming it:
+ * @code
+ * struct Users : Table<Users, UserId, UserName> { static constexpr std::string_view kName = "users"; };
+ * @endcode
+ *
+ * Table and column names must be plain SQL identifiers, and a column may only be listed once. Statements only
+ * accept the columns of their table, with values of the column types, so these are all checked when compiling.
+ *
+ * The SQL text of each statement is a constant, interned once per program by @c Sql(), so using it costs
+ * no string building; the statement cache then keys the prepared statement on it as usual.
+ * Values are bound and read in their native storage class, through @c ColumnTraits.
+ */
+template<typename TTable, typename... TColumns>
+class Table
+{
+public:
+    static_assert(sizeof...(TColumns) > 0, "a table needs at least one column");
+    static_assert((std::is_base_of_v<Column<typename TColumns::Type>, TColumns> && ...),
+                  "table columns must derive from Column<T>");
+
+    using Row = std::tuple<typename TColumns::Type...>;
+
+    template<typename TColumn>
+    static constexpr bool kHasColumn = (std::is_same_v<TColumn, TColumns> || ...);
+
+    /**
+     * @brief INSERT INTO <table>(<columns>) VALUES (<placeholders>);
+     */
+    struct Insert
+    {
+        template<typename TOut>
+        static constexpr void Write(TOut& out)
+        {
+            out.append("INSERT INTO ");
+            out.append(TTable::kName);
+            out.append("(");
+            WriteColumns<TColumns...>(out, ", ", "");
+            out.append(") VALUES (");
+            WritePlaceholders(out, sizeof...(TColumns));
+            out.append(");");
+        }
+    };
+
+    /**
+     * @brief SELECT <columns> FROM <table> [WHERE <column>=? AND ...];
+     */
+    template<typename... TWhere>
+    struct Select
+    {
+        static_assert((kHasColumn<TWhere> && ...), "filtering on a column of another table");
+
+        template<typename TOut>
+        static constexpr void Write(TOut& out)
+        {
+            out.append("SELECT ");
+            WriteColumns<TColumns...>(out, ", ", "");
+            out.append(" FROM ");
+            out.append(TTable::kName);
+            WriteWhere<TWhere...>(out);
+            out.append(";");
+        }
+    };
+
+    /**
+     * @brief UPDATE <table> SET <column>=?, ... [WHERE <column>=? AND ...];
+     */
+    template<typename TSet, typename TWhere>
+    struct Update;
+
+    template<typename... TSet, typename... TWhere>
+    struct Update<Set<TSet...>, Where<TWhere...>>
+    {
+        static_assert(sizeof...(TSet) > 0, "an update needs at least one column to set");
+        static_assert((kHasColumn<TSet> && ...), "setting a column of another table");
+        static_assert((kHasColumn<TWhere> && ...), "filtering on a column of another table");
+
+        template<typename TOut>
+        static constexpr void Write(TOut& out)
+        {
+            out.append("UPDATE ");
+            out.append(TTable::kName);
+            out.append(" SET ");
+            WriteColumns<TSet...>(out, ", ", "=?");
+            WriteWhere<TWhere...>(out);
+            out.append(";");
+        }
+    };
+
+    /**
+     * @brief DELETE FROM <table> [WHERE <column>=? AND ...];
+     */
+    template<typename... TWhere>
+    struct Delete
+    {
+        static_assert((kHasColumn<TWhere> && ...), "filtering on a column of another table");
+
+        template<typename TOut>
+        static constexpr void Write(TOut& out)
+        {
+            out.append("DELETE FROM ");
+            out.append(TTable::kName);
+            WriteWhere<TWhere...>(out);
+            out.append(";");
+        }
+    };
+
+    /**
+     * @brief Generate the SQL text of a statement of this table, in a constant expression.
+     * @tparam TStatement One of @c Insert, @c Select, @c Update or @c Delete.
+     */
+    template<typename TStatement>
+    static constexpr auto Text()
+    {
+        static_assert(IsIdentifier(TTable::kName), "table names must be plain SQL identifiers");
+        static_assert((IsIdentifier(TColumns::kName) && ...), "column names must be plain SQL identifiers");
+        static_assert(UniqueNames(), "a column is listed more than once");
+
+        constexpr std::size_t size = [] {
+            SqlLength length;
+            TStatement::Write(length);
+            return length.size;
+        }();
+
+        SqlText<size> text;
+        TStatement::Write(text);
+        return text;
+    }
+
+    /**
+     * @brief Get the SQL of a statement of this table, interned on first use.
+     * @tparam TStatement One of @c Insert, @c Select, @c Update or @c Delete.
+     */
+    template<typename TStatement>
+    static const std::string& Sql()
+    {
+        static constexpr auto kText = Text<TStatement>();
+        static const std::string sql{kText.view()};
+        return sql;
+    }
+
+    /**
+     * @brief Bind values to consecutive statement placeholders.
+     * @param statement The statement to bind the values to.
+     * @param firstIndex The 1-based index of the placeholder to bind the first value to.
+     * @param values The values to bind, in order.
+     */
+    template<typename... TValues>
+    static void Bind(Statement& statement, int firstIndex, const std::tuple<TValues...>& values)
+    {
+        std::apply(
+            [&statement, index = firstIndex](const TValues&... value) mutable
+            { (ColumnTraits<TValues>::Bind(statement, index++, value), ...); },
+            values);
+    }
+
+    /**
+     * @brief Read the current result row of a @c Select statement.
+     * @tparam TResult @c Row, or any type that can be brace-initialized from the column values, in order.
+     */
+    template<typename TResult>
+    static TResult Read(const Statement& statement)
+    {
+        return Read<TResult>(statement, std::index_sequence_for<TColumns...>{});
+    }
+
+private:
+    template<typename TResult, std::size_t... Is>
+    static TResult Read(const Statement& statement, std::index_sequence<Is...>)
+    {
+        // braced initializers are evaluated in order, so columns are read left to right
+        return TResult{ColumnTraits<typename TColumns::Type>::Read(statement, static_cast<int>(Is))...};
+    }
+
+    static constexpr bool IsIdentifier(std::string_view name)
+    {
+        if (name.empty() || (name.front() >= '0' && name.front() <= '9'))
+        {
+            return false;
+        }
+
+        for (const char c : name)
+        {
+            const bool letter = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
+            if (!letter && !(c >= '0' && c <= '9') && c != '_')
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    static constexpr bool UniqueNames()
+    {
+        constexpr std::array<std::string_view, sizeof...(TColumns)> names{TColumns::kName...};
+        for (std::size_t i = 0; i < names.size(); ++i)
+        {
+            for (std::size_t j = i + 1; j < names.size(); ++j)
+            {
+                if (names[i] == names[j])
+                {
+                    return false;
+                }
+            }
+        }
+
+        return true;
+    }
+
+    template<typename... TList, typename TOut>
+    static constexpr void WriteColumns(TOut& out, std::string_view separator, std::string_view suffix)
+    {
+        bool first = true;
+        ((out.append(first ? "" : separator), out.append(TList::kName), out.append(suffix), first = false), ...);
+    }
+
+    template<typename... TWhere, typename TOut>
+    static constexpr void WriteWhere(TOut& out)
+    {
+        if constexpr (sizeof...(TWhere) > 0)
+        {
+            out.append(" WHERE ");
+            WriteColumns<TWhere...>(out, " AND ", "=?");
+        }
+    }
+
+    template<typename TOut>
+    static constexpr void WritePlaceholders(TOut& out, std::size_t count)
+    {
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            out.append(i == 0 ? "?" : ", ?");
+        }
+    }
+};
+
+} // namespace sqlite_wrapper
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace sqlite_wrapper
+{
+
+/**
+ * @class TaskQueue
+ * @brief FIFO queue of tasks executed by a fixed set of worker threads.
+ *
+ * With a single worker thread, tasks run one after the other in submission order.
+ * Tasks still queued when the @c TaskQueue is destroyed are executed before the workers are joined.
+ */
+class TaskQueue
+{
+public:
+    using Task = std::function<void()>;
+
+    explicit TaskQueue(std::size_t threadCount);
+    ~TaskQueue();
+
+    TaskQueue(const TaskQueue&)            = delete;
+    TaskQueue& operator=(const TaskQueue&) = delete;
+
+    void push(Task task);
+
+    /**
+     * @brief Get the number of tasks waiting for a worker.
+     */
+    std::size_t pending() const;
+
+private:
+    void run();
+
+    mutable std::mutex mMutex;
+    std::condition_variable mTaskPushed;
+    std::deque<Task> mTasks;
+    bool mStopping{false};
+    std::vector<std::thread> mThreads;
+};
+
+} // namespace sqlite_wrapper
@@ -0,0 +1,102 @@
+#pragma once
+
+#include "IConnection.hpp"
+
+#include <cstddef>
+#include <string>
+
+namespace sqlite_wrapper
+{
+
+/**
+ * @class Transaction
+ * @brief Scoped transaction: begun on construction, and rolled back on destruction unless committed.
+ *
+ * Any exception thrown between the beginning and the commit thus rolls the transaction back, and releases
+ * the connection's write access, as the guard goes out of scope.
+ * Transactions take the write lock up front by default (@c TransactionMode::Immediate), so a busy DB is
+ * waited for before any work is done, instead of on the first write.
+ *
+ * Nested units of work are undone, without giving up the whole transaction, through @c savepoint().
+ *
+ * @code
+ * Transaction transaction{connection};
+ * connection.insert("orders", order, true);
+ * {
+ *     auto savepoint = transaction.savepoint();
+ *     connection.update("stock", stock, filters, true); // undone if it throws, the order insert is kept
+ *     savepoint.release();
+ * }
+ * transaction.commit();
+ * @endcode
+ */
+class Transaction
+{
+public:
+    /**
+     * @class Savepoint
+     * @brief Scoped savepoint: opened on construction, and rolled back to on destruction unless released.
+     */
+    class Savepoint
+    {
+    public:
+        Savepoint(IConnection& connection, std::string name);
+        ~Savepoint();
+
+        Savepoint(const Savepoint&)            = delete;
+        Savepoint& operator=(const Savepoint&) = delete;
+
+        /**
+         * @brief Keep the changes made since the savepoint, as part of the transaction.
+         */
+        void release();
+
+        /**
+         * @brief Undo the changes made since the savepoint, and close it.
+         */
+        void rollback();
+
+        const std::string& name() const;
+
+    private:
+        IConnection& mConnection;
+        const std::string mName;
+        bool mActive{true};
+    };
+
+    explicit Transaction(IConnection& connection,
+                         TransactionMode mode   = TransactionMode::Immediate,
+                         bool enableForeignKeys = true);
+    ~Transaction();
+
+    Transaction(const Transaction&)            = delete;
+    Transaction& operator=(const Transaction&) = delete;
+
+    /**
+     * @brief Commit the transaction.
+     *
+     * If the commit fails, e.g. with SQLITE_BUSY, the transaction is still active: it may be committed again,
+     * or else it is rolled back by the destructor.
+     */
+    void commit();
+
+    /**
+     * @brief Roll the transaction back now, rather than on destruction.
+     */
+    void rollback();
+
+    /**
+     * @brief Open a savepoint within the transaction.
+     * @return The savepoint guard, which must go out of scope before the transaction is committed.
+     */
+    Savepoint savepoint();
+
+    bool active() const;
+
+private:
+    IConnection& mConnection;
+    bool mActive{false};
+    std::size_t mSavepoints{0}; // opened so far, to name the next one
+};
+
+} // namespace sqlite_wrapper
@@ -0,0 +1,293 @@
+#include "AsyncConnection.hpp"
+
+namespace sqlite_wrapper
+{
+
+AsyncConnection::AsyncConnection(const std::string& databasePath,
+                                 std::size_t readerThreadCount,
+                                 const ConnectionOptions& options)
+    : mPool{databasePath, readerThreadCount, options}
+    , mWriter{1}
+    , mReaders{readerThreadCount}
+{
+}
+
+AsyncConnection::~AsyncConnection() = default;
+
+const std::string& AsyncConnection::getDatabasePath() const
+{
+    return mPool.getDatabasePath();
+}
+
+bool AsyncConnection::open()
+{
+    return mPool.open();
+}
+
+bool AsyncConnection::isOpen() const
+{
+    return mPool.isOpen();
+}
+
+std::future<void> AsyncConnection::applySql(std::string sql)
+{
+    return enqueue(mWriter, [this, sql = std::move(sql)] { mPool.applySql(sql); });
+}
+
+std::future<bool> AsyncConnection::tableExists(std::string table)
+{
+    return enqueue(mReaders, [this, table = std::move(table)] { return mPool.tableExists(table); });
+}
+
+std::future<Rows> AsyncConnection::select(std::string table, KeyValues filters)
+{
+    return enqueue(mReaders, [this, table = std::move(table), filters = std::move(filters)] {
+        return mPool.select(table, filters);
+    });
+}
+
+std::future<Rows> AsyncConnection::select(std::string table, std::string col, KeyValues filters)
+{
+    return enqueue(mReaders, [this, table = std::move(table), col = std::move(col), filters = std::move(filters)] {
+        return mPool.select(table, col, filters);
+    });
+}
+
+std::future<void> AsyncConnection::select(ResultSet& result, std::string table, KeyValues filters)
+{
+    return enqueue(mReaders, [this, &result, table = std::move(table), filters = std::move(filters)] {
+        mPool.select(result, table, filters);
+    });
+}
+
+std::future<void> AsyncConnection::select(ResultSet& result, std::string table, std::string col, KeyValues filters)
+{
+    return enqueue(mReaders,
+                   [this, &result, table = std::move(table), col = std::move(col), filters = std::move(filters)] {
+                       mPool.select(result, table, col, filters);
+                   });
+}
+
+std::future<SqlRows> AsyncConnection::selectTyped(std::string table, KeyValues filters)
+{
+    return enqueue(mReaders, [this, table = std::move(table), filters = std::move(filters)] {
+        return mPool.selectTyped(table, filters);
+    });
+}
+
+std::future<SqlRows> AsyncConnection::selectTyped(std::string table, std::string col, KeyValues filters)
+{
+    return enqueue(mReaders, [this, table = std::move(table), col = std::move(col), filters = std::move(filters)] {
+        return mPool.selectTyped(table, col, filters);
+    });
+}
+
+std::future<PrimaryKey> AsyncConnection::insert(std::string table, KeyValues keyValues)
+{
+    return enqueue(mWriter, [this, table = std::move(table), keyValues = std::move(keyValues)] {
+        return mPool.insert(table, keyValues, false);
+    });
+}
+
+std::future<PrimaryKeys> AsyncConnection::insert(std::string table, Rows rows)
+{
+    return enqueue(mWriter, [this, table = std::move(table), rows = std::move(rows)] {
+        return mPool.insert(table, rows, false);
+    });
+}
+
+std::future<PrimaryKey> AsyncConnection::insertOrReplace(std::string table, KeyValues keyValues)
+{
+    return enqueue(mWriter, [this, table = std::move(table), keyValues = std::move(keyValues)] {
+        return mPool.insertOrReplace(table, keyValues, false);
+    });
+}
+
+std::future<PrimaryKeys> AsyncConnection::insertOrReplace(std::string table, Rows rows)
+{
+    return enqueue(mWriter, [this, table = std::move(table), rows = std::move(rows)] {
+        return mPool.insertOrReplace(table, rows, false);
+    });
+}
+
+std::future<PrimaryKey> AsyncConnection::upsert(std::string table,
+                                                KeyValues keyValues,
+                                                std::vector<std::string> conflictColumns,
+                                                std::vector<std::string> updateColumns)
+{
+    return enqueue(mWriter,
+                   [this,
+                    table           = std::move(table),
+                    keyValues       = std::move(keyValues),
+                    conflictColumns = std::move(conflictColumns),
+                    updateColumns   = std::move(updateColumns)] {
+                       return mPool.upsert(table, keyValues, conflictColumns, updateColumns, false);
+                   });
+}
+
+std::future<PrimaryKeys> AsyncConnection::upsert(std::string table,
+                                                 Rows rows,
+                                                 std::vector<std::string> conflictColumns,
+                                                 std::vector<std::string> updateColumns)
+{
+    return enqueue(mWriter,
+                   [this,
+                    table           = std::move(table),
+                    rows            = std::move(rows),
+                    conflictColumns = std::move(conflictColumns),
+                    updateColumns   = std::move(updateColumns)] {
+                       return mPool.upsert(table, rows, conflictColumns, updateColumns, false);
+                   });
+}
+
+std::future<void> AsyncConnection::update(std::string table, KeyValues keyValues, KeyValues filters)
+{
+    return enqueue(mWriter,
+                   [this, table = std::move(table), keyValues = std::move(keyValues), filters = std::move(filters)] {
+                       mPool.update(table, keyValues, filters, false);
+                   });
+}
+
+std::future<void> AsyncConnection::deleteRows(std::string table, KeyValues filters)
+{
+    return enqueue(mWriter, [this, table = std::move(table), filters = std::move(filters)] {
+        mPool.deleteRows(table, filters, false);
+    });
+}
+
+std::future<std::size_t> AsyncConnection::count(std::string table, KeyValues filters)
+{
+    return enqueue(mReaders, [this, table = std::move(table), filters = std::move(filters)] {
+        return mPool.count(table, filters);
+    });
+}
+
+std::future<std::size_t> AsyncConnection::count(std::string table, std::string col, KeyValues filters)
+{
+    return enqueue(mReaders, [this, table = std::move(table), col = std::move(col), filters = std::move(filters)] {
+        return mPool.count(table, col, filters);
+    });
+}
+
+std::future<double> AsyncConnection::sum(std::string table, std::string col, KeyValues filters)
+{
+    return enqueue(mReaders, [this, table = std::move(table), col = std::move(col), filters = std::move(filters)] {
+        return mPool.sum(table, col, filters);
+    });
+}
+
+std::future<double> AsyncConnection::average(std::string table, std::string col, KeyValues filters)
+{
+    return enqueue(mReaders, [this, table = std::move(table), col = std::move(col), filters = std::move(filters)] {
+        return mPool.average(table, col, filters);
+    });
+}
+
+std::future<Rows> AsyncConnection::select(std::string table, Filter filter)
+{
+    return enqueue(mReaders, [this, table = std::move(table), filter = std::move(filter)] {
+        return mPool.select(table, filter);
+    });
+}
+
+std::future<Rows> AsyncConnection::select(std::string table, std::string col, Filter filter)
+{
+    return enqueue(mReaders, [this, table = std::move(table), col = std::move(col), filter = std::move(filter)] {
+        return mPool.select(table, col, filter);
+    });
+}
+
+std::future<Rows> AsyncConnection::query(std::string table, QueryOptions options, Filter filter)
+{
+    return enqueue(mReaders,
+                   [this, table = std::move(table), options = std::move(options), filter = std::move(filter)] {
+                       return mPool.query(table, options, filter);
+                   });
+}
+
+std::future<Page>
+AsyncConnection::queryPage(std::string table, PageOptions options, Filter filter, std::optional<PageToken> after)
+{
+    return enqueue(mReaders,
+                   [this,
+                    table   = std::move(table),
+                    options = std::move(options),
+                    filter  = std::move(filter),
+                    after   = std::move(after)] { return mPool.queryPage(table, options, filter, after); });
+}
+
+std::future<void> AsyncConnection::update(std::string table, KeyValues keyValues, Filter filter)
+{
+    return enqueue(mWriter,
+                   [this, table = std::move(table), keyValues = std::move(keyValues), filter = std::move(filter)] {
+                       mPool.update(table, keyValues, filter, false);
+                   });
+}
+
+std::future<void> AsyncConnection::deleteRows(std::string table, Filter filter)
+{
+    return enqueue(mWriter, [this, table = std::move(table), filter = std::move(filter)] {
+        mPool.deleteRows(table, filter, false);
+    });
+}
+
+std::future<std::size_t> AsyncConnection::count(std::string table, Filter filter)
+{
+    return enqueue(mReaders, [this, table = std::move(table), filter = std::move(filter)] {
+        return mPool.count(table, filter);
+    });
+}
+
+std::future<std::size_t> AsyncConnection::count(std::string table, std::string col, Filter filter)
+{
+    return enqueue(mReaders, [this, table = std::move(table), col = std::move(col), filter = std::move(filter)] {
+        return mPool.count(table, col, filter);
+    });
+}
+
+std::future<double> AsyncConnection::sum(std::string table, std::string col, Filter filter)
+{
+    return enqueue(mReaders, [this, table = std::move(table), col = std::move(col), filter = std::move(filter)] {
+        return mPool.sum(table, col, filter);
+    });
+}
+
+std::future<double> AsyncConnection::average(std::string table, std::string col, Filter filter)
+{
+    return enqueue(mReaders, [this, table = std::move(table), col = std::move(col), filter = std::move(filter)] {
+        return mPool.average(table, col, filter);
+    });
+}
+
+std::future<SqlRow> AsyncConnection::aggregate(std::string table, Aggregates aggregates, KeyValues filters)
+{
+    return enqueue(mReaders,
+                   [this, table = std::move(table), aggregates = std::move(aggregates), filters = std::move(filters)] {
+                       return mPool.aggregate(table, aggregates, filters);
+                   });
+}
+
+std::future<SqlRows> AsyncConnection::aggregate(std::string table,
+                                                std::vector<std::string> groupBy,
+                                                Aggregates aggregates,
+                                                KeyValues filters)
+{
+    return enqueue(mReaders,
+                   [this,
+                    table      = std::move(table),
+                    groupBy    = std::move(groupBy),
+                    aggregates = std::move(aggregates),
+                    filters    = std::move(filters)] { return mPool.aggregate(table, groupBy, aggregates, filters); });
+}
+
+std::size_t AsyncConnection::pendingWrites() const
+{
+    return mWriter.pending();
+}
+
+std::size_t AsyncConnection::pendingReads() const
+{
+    return mReaders.pending();
+}
+
+} // namespace sqlite_wrapper
@@ -0,0 +1,123 @@
+#include "BusyPolicy.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <random>
+
+namespace sqlite_wrapper
+{
+
+namespace
+{
+
+struct GiveUp
+{
+    sqlite3* db;
+    BusyWait wait;
+};
+
+// set by the busy handler right before SQLite fails the statement of the same thread
+std::optional<GiveUp>& LastGiveUp()
+{
+    thread_local std::optional<GiveUp> giveUp;
+    return giveUp;
+}
+
+} // namespace
+
+BackoffBusyPolicy::BackoffBusyPolicy(const BusyBackoffOptions& options, std::chrono::milliseconds timeout)
+    : mOptions{options}
+    , mTimeout{timeout}
+{
+}
+
+std::optional<std::chrono::nanoseconds> BackoffBusyPolicy::delay(const BusyWait& wait)
+{
+    if (mOptions.maxRetries && wait.retries >= static_cast<std::int64_t>(*mOptions.maxRetries))
+    {
+        return std::nullopt;
+    }
+
+    const auto remaining = deadline(wait) - wait.elapsed;
+    if (remaining <= std::chrono::nanoseconds::zero())
+    {
+        return std::nullopt;
+    }
+
+    using Nanoseconds = std::chrono::duration<double, std::nano>;
+    auto delay        = Nanoseconds{mOptions.initialDelay}.count() * std::pow(mOptions.multiplier, wait.retries);
+    delay             = std::min(delay, Nanoseconds{mOptions.maxDelay}.count());
+
+    // one generator per thread, so that the connections sharing the policy do not contend on it
+    thread_local std::minstd_rand random{std::random_device{}()};
+    const auto jitter = std::clamp(mOptions.jitter, 0.0, 1.0);
+    delay *= 1.0 - jitter * std::uniform_real_distribution<double>{0.0, 1.0}(random);
+
+    return std::min(std::chrono::nanoseconds{static_cast<std::int64_t>(delay)}, remaining);
+}
+
+std::chrono::nanoseconds BackoffBusyPolicy::deadline(const BusyWait& wait) const
+{
+    if (wait.operation)
+    {
+        auto it = mOptions.deadlines.find(*wait.operation);
+        if (it != mOptions.deadlines.end())
+        {
+            return it->second;
+        }
+    }
+
+    return mTimeout;
+}
+
+BusyTimeoutError::BusyTimeoutError(const std::string& sql, const BusyWait& wait)
+    : sqlite::errors::busy(Message(wait).c_str(), sql, SQLITE_BUSY)
+    , mWait{wait}
+{
+}
+
+const BusyWait& BusyTimeoutError::wait() const
+{
+    return mWait;
+}
+
+void BusyTimeoutError::GaveUp(sqlite3* db, const BusyWait& wait)
+{
+    LastGiveUp() = GiveUp{db, wait};
+}
+
+void BusyTimeoutError::Clear()
+{
+    LastGiveUp().reset();
+}
+
+void BusyTimeoutError::Throw(sqlite3* db, int code, const std::string& sql)
+{
+    auto& giveUp = LastGiveUp();
+    if ((code & 0xFF) == SQLITE_BUSY && giveUp && giveUp->db == db)
+    {
+        const auto wait = giveUp->wait;
+        giveUp.reset();
+        throw BusyTimeoutError(sql, wait);
+    }
+
+    sqlite::errors::throw_sqlite_error(code, sql);
+    throw sqlite::sqlite_exception(code, sql); // not reached: throw_sqlite_error() always throws
+}
+
+std::string BusyTimeoutError::Message(const BusyWait& wait)
+{
+    const auto elapsedMs = std::chrono::duration_cast<std::chrono::milliseconds>(wait.elapsed).count();
+
+    std::string message = "database is locked: gave up after " + std::to_string(wait.retries) + " retries and "
+                          + std::to_string(elapsedMs) + " ms";
+    if (wait.operation)
+    {
+        message += std::string(" in ") + ConnectionMetrics::ToString(*wait.operation);
+    }
+
+    return message;
+}
+
+} // namespace sqlite_wrapper
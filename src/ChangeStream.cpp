@@ -0,0 +1,159 @@
+#include "ChangeStream.hpp"
+
+#include <algorithm>
+#include <iterator>
+
+namespace sqlite_wrapper
+{
+
+ChangeStream::ChangeStream(const ChangeStreamOptions& options)
+    : mOptions{options}
+{
+}
+
+void ChangeStream::record(int operation, const char* table, sqlite3_int64 rowid)
+{
+    Change change;
+    change.operation = operation == SQLITE_INSERT   ? Change::Operation::Insert
+                       : operation == SQLITE_UPDATE ? Change::Operation::Update
+                                                    : Change::Operation::Delete;
+    change.table     = table;
+    change.rowid     = rowid;
+
+    std::lock_guard<std::mutex> lock(mMutex);
+    mPending.emplace_back(std::move(change));
+}
+
+void ChangeStream::commit()
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    mCommitting.insert(mCommitting.end(),
+                       std::make_move_iterator(mPending.begin()),
+                       std::make_move_iterator(mPending.end()));
+    mPending.clear();
+}
+
+void ChangeStream::settle(bool committed)
+{
+    std::vector<Change> published;
+
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+
+        if (mCommitting.empty())
+        {
+            return;
+        }
+
+        if (!committed)
+        {
+            mPending.insert(mPending.begin(),
+                            std::make_move_iterator(mCommitting.begin()),
+                            std::make_move_iterator(mCommitting.end()));
+            mCommitting.clear();
+            return;
+        }
+
+        ++mCommits;
+        for (auto& change : mCommitting)
+        {
+            change.sequence = ++mSequence;
+            change.commit   = mCommits;
+            mHistory.push_back(change);
+        }
+
+        while (mHistory.size() > mOptions.capacity)
+        {
+            mHistory.pop_front();
+        }
+
+        published.swap(mCommitting);
+    }
+
+    std::lock_guard<std::mutex> lock(mSubscribersMutex);
+    for (auto& subscriber : mSubscribers)
+    {
+        deliver(subscriber, published);
+    }
+}
+
+void ChangeStream::rollback()
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    mPending.clear();
+    mCommitting.clear();
+}
+
+std::size_t ChangeStream::savepoint() const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mPending.size();
+}
+
+void ChangeStream::rollbackTo(std::size_t savepoint)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    mPending.resize(std::min(savepoint, mPending.size()));
+}
+
+ChangeStream::Poll ChangeStream::poll(std::uint64_t after, std::size_t max) const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    Poll poll;
+    if (after >= mSequence)
+    {
+        return poll;
+    }
+
+    // sequence numbers are consecutive, so the first change to return is found by offset
+    const auto oldest = mHistory.empty() ? mSequence + 1 : mHistory.front().sequence;
+    poll.missed       = after + 1 < oldest;
+
+    const auto first = static_cast<std::size_t>(std::max(after + 1, oldest) - oldest);
+    const auto count = std::min(max, mHistory.size() - std::min(first, mHistory.size()));
+    poll.changes.assign(mHistory.cbegin() + static_cast<std::ptrdiff_t>(first),
+                        mHistory.cbegin() + static_cast<std::ptrdiff_t>(first + count));
+    return poll;
+}
+
+std::uint64_t ChangeStream::lastSequence() const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mSequence;
+}
+
+std::uint64_t ChangeStream::subscribe(Callback callback, std::uint64_t after)
+{
+    std::lock_guard<std::mutex> lock(mSubscribersMutex);
+
+    // changes committed from now on wait for this lock, and those already delivered by the replay are skipped
+    Subscriber subscriber{mNextSubscriberId++, std::move(callback), after};
+    deliver(subscriber, poll(after).changes);
+
+    mSubscribers.emplace_back(std::move(subscriber));
+    return mSubscribers.back().id;
+}
+
+void ChangeStream::unsubscribe(std::uint64_t id)
+{
+    std::lock_guard<std::mutex> lock(mSubscribersMutex);
+    mSubscribers.erase(std::remove_if(mSubscribers.begin(),
+                                      mSubscribers.end(),
+                                      [id](const Subscriber& subscriber) { return subscriber.id == id; }),
+                       mSubscribers.end());
+}
+
+void ChangeStream::deliver(Subscriber& subscriber, const std::vector<Change>& changes)
+{
+    for (const auto& change : changes)
+    {
+        if (change.sequence > subscriber.delivered)
+        {
+            subscriber.callback(change);
+            subscriber.delivered = change.sequence;
+        }
+    }
+}
+
+} // namespace sqlite_wrapper
@@ -1,7 +1,16 @@
 #include "Connection.hpp"
 
+#include "DelimitedReader.hpp"
 #include "SqliteTraits.hpp"
 
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+
 #ifndef DEBUG
 #define DEBUG 0
 #endif
@@ -9,11 +18,41 @@
 namespace sqlite_wrapper
 {
 
-Connection::Connection(const std::string& databasePath)
+Connection::Connection(const std::string& databasePath, const ConnectionOptions& options)
     : mDatabasePath{databasePath}
+    , mOptions{options}
     , mDatabase{std::shared_ptr<sqlite3>(nullptr)}
+    , mStatementCache{options.statementCacheSize}
     , mInTransaction{false}
 {
+    if (options.groupCommit)
+    {
+        mGroupCommit = std::make_unique<GroupCommit>(
+            *options.groupCommit, [this](const GroupCommit::Batch& batch) { commitBatch(batch); });
+    }
+
+    mBusyPolicy = options.busyPolicy ? options.busyPolicy
+                                     : std::make_shared<BackoffBusyPolicy>(options.busyBackoff, options.busyTimeout);
+
+    if (options.profiler)
+    {
+        mProfiler = std::make_unique<QueryProfiler>(*options.profiler);
+    }
+
+    if (options.indexAdvisor)
+    {
+        mIndexAdvisor = std::make_unique<IndexAdvisor>(*options.indexAdvisor);
+    }
+
+    if (options.resultCache)
+    {
+        mResultCache = std::make_unique<ResultCache>(*options.resultCache);
+    }
+
+    if (options.changeStream)
+    {
+        mChangeStream = std::make_unique<ChangeStream>(*options.changeStream);
+    }
 }
 
 const std::string& Connection::getDatabasePath() const
@@ -21,10 +60,35 @@ const std::string& Connection::getDatabasePath() const
     return mDatabasePath;
 }
 
+const ConnectionOptions& Connection::getOptions() const
+{
+    return mOptions;
+}
+
 bool Connection::open()
 {
     sqlite::sqlite_config config;
-    config.flags = sqlite::OpenFlags::READWRITE | sqlite::OpenFlags::CREATE | sqlite::OpenFlags::FULLMUTEX;
+    if (mOptions.readOnly)
+    {
+        config.flags = sqlite::OpenFlags::READONLY;
+    }
+    else
+    {
+        config.flags = mOptions.create ? sqlite::OpenFlags::READWRITE | sqlite::OpenFlags::CREATE
+                                       : sqlite::OpenFlags::READWRITE;
+    }
+
+    if (mOptions.threadingMode == ConnectionOptions::ThreadingMode::Serialized)
+    {
+        config.flags = config.flags | sqlite::OpenFlags::FULLMUTEX;
+    }
+    else
+    {
+        config.flags = config.flags | sqlite::OpenFlags::NOMUTEX;
+    }
+
+    // cached statements belong to the previous connection, if any
+    mStatementCache.clear();
 
     try
     {
@@ -36,8 +100,7 @@ bool Connection::open()
         return false;
     }
 
-    connectionHook();
-    return true;
+    return connectionHook();
 }
 
 bool Connection::isOpen() const
@@ -47,7 +110,14 @@ bool Connection::isOpen() const
 
 void Connection::applySql(const std::string& sql)
 {
-    mDatabase << sql;
+    ConnectionMetrics::Scope scope{mMetrics, ConnectionMetrics::Operation::ApplySql};
+    executeCommit(sql);
+
+    // may have changed the schema, which the update hook doesn't report
+    if (mResultCache)
+    {
+        mResultCache->invalidateAll();
+    }
 }
 
 bool Connection::tableExists(const std::string& table)
@@ -65,249 +135,1632 @@ bool Connection::tableExists(const std::string& table)
 
 void Connection::beginTransaction(bool enableForeignKeys)
 {
-    mWriteMutex.lock();
+    beginTransaction(TransactionMode::Deferred, enableForeignKeys);
+}
+
+void Connection::beginTransaction(TransactionMode mode, bool enableForeignKeys)
+{
+    ConnectionMetrics::Scope scope{mMetrics, ConnectionMetrics::Operation::BeginTransaction};
+
+    acquireWriteMutex();
     mInTransaction = true;
 
-    if (enableForeignKeys)
-    {
-        applySql("PRAGMA foreign_keys=ON;");
-    }
-    else
+    try
     {
-        applySql("PRAGMA foreign_keys=OFF;");
-    }
+        // a no-op within a transaction, so it's set right before; and only when changed, as it costs a statement
+        if (mForeignKeys != enableForeignKeys)
+        {
+            auto pragma = SqliteTraits::SqlPragma("foreign_keys", enableForeignKeys ? "ON" : "OFF");
+#if DEBUG
+            std::cout << "Built SQL: " << pragma << std::endl;
+#endif
+            execute(pragma);
+            mForeignKeys = enableForeignKeys;
+        }
 
-    std::string query = "begin;";
+        auto query = SqliteTraits::SqlBeginTransaction(mode);
 #if DEBUG
-    std::cout << "Built SQL: " << query << std::endl;
+        std::cout << "Built SQL: " << query << std::endl;
 #endif
-    mDatabase << query;
+        execute(query);
+    }
+    catch (...)
+    {
+        mInTransaction = false;
+        mWriteMutex.unlock();
+        throw;
+    }
 }
 
 void Connection::commitTransaction()
 {
+    commitTransaction({});
+}
+
+void Connection::commitTransaction(const std::function<void()>& committed)
+{
+    ConnectionMetrics::Scope scope{mMetrics, ConnectionMetrics::Operation::CommitTransaction};
+
 #if DEBUG
     std::cout << "Built SQL: commit;" << std::endl;
 #endif
 
-    mDatabase << "commit;";
+    // on failure, e.g. SQLITE_BUSY, the transaction stays active, to be committed again or rolled back
+    executeCommit("commit;");
+
+    mSavepoints.clear();
     mInTransaction = false;
+
+    if (committed)
+    {
+        committed();
+    }
+
     mWriteMutex.unlock();
 }
 
 void Connection::rollbackTransaction()
 {
+    ConnectionMetrics::Scope scope{mMetrics, ConnectionMetrics::Operation::RollbackTransaction};
+
 #if DEBUG
     std::cout << "Built SQL: rollback;" << std::endl;
 #endif
 
-    mDatabase << "rollback;";
+    mSavepoints.clear();
     mInTransaction = false;
+
+    try
+    {
+        // SQLite rolls back by itself on some errors, e.g. SQLITE_FULL, after which a rollback would fail
+        // executed explicitly, as a binder destroyed during stack unwinding, e.g. by a scoped Transaction, doesn't run
+        if (sqlite3_get_autocommit(mDatabase.connection().get()) == 0)
+        {
+            (mDatabase << "rollback;").execute();
+        }
+    }
+    catch (...)
+    {
+        mWriteMutex.unlock();
+        throw;
+    }
+
     mWriteMutex.unlock();
 }
 
-Rows Connection::select(const std::string& table, const KeyValues& filters)
+void Connection::savepoint(const std::string& name)
+{
+    if (!mInTransaction)
+    {
+        throw std::logic_error("savepoint(), no transaction is active");
+    }
+
+    CheckSavepointName(name);
+
+    auto query = "savepoint " + name + ";";
+#if DEBUG
+    std::cout << "Built SQL: " << query << std::endl;
+#endif
+    mDatabase << query;
+    mSavepoints.emplace_back(name, mChangeStream ? mChangeStream->savepoint() : 0);
+}
+
+void Connection::releaseSavepoint(const std::string& name)
 {
-    Rows rows; // will represent an array of size N-by-M
+    CheckSavepointName(name);
+
+    auto query = "release " + name + ";";
+#if DEBUG
+    std::cout << "Built SQL: " << query << std::endl;
+#endif
+    (mDatabase << query).execute();
 
-    auto&& sql = SqliteTraits::SqlSelect(table, "*", filters);
+    // releases the savepoints opened after it too
+    auto it = findSavepoint(name);
+    mSavepoints.erase(it, mSavepoints.end());
+}
 
-    auto dbConnection  = mDatabase.connection().get();
-    sqlite3_stmt* stmt = nullptr;
-    auto hresult       = sqlite3_prepare_v2(dbConnection, sql.c_str(), -1, &stmt, nullptr);
-    if (hresult != SQLITE_OK)
+void Connection::rollbackToSavepoint(const std::string& name)
+{
+    CheckSavepointName(name);
+
+    auto query = "rollback to " + name + ";";
+#if DEBUG
+    std::cout << "Built SQL: " << query << std::endl;
+#endif
+    (mDatabase << query).execute();
+
+    // the rollback hook only reports full rollbacks
+    if (mResultCache)
     {
-        std::cerr << "select(), could not prepare statement, got error code: " << hresult << std::endl;
+        mResultCache->invalidateAll();
     }
 
-    const auto numberOfColumns = sqlite3_column_count(stmt);
-    while ((hresult = sqlite3_step(stmt)) == SQLITE_ROW)
+    auto it = findSavepoint(name);
+    if (it != mSavepoints.end())
     {
-        Row row;
-        for (int i = 0; i < numberOfColumns; ++i)
+        if (mChangeStream)
         {
-            auto columnValue = sqlite3_column_text(stmt, i);
-            if (columnValue == nullptr)
-            {
-                row.emplace_back(std::nullopt);
-                continue;
-            }
-
-            std::string value = std::string{reinterpret_cast<const char*>(columnValue)}; // NOLINT
-            row.emplace_back(value);
+            mChangeStream->rollbackTo(it->second);
         }
 
-        rows.emplace_back(row);
+        mSavepoints.erase(it + 1, mSavepoints.end());
     }
+}
 
-    sqlite3_finalize(stmt);
+Rows Connection::select(const std::string& table, const KeyValues& filters)
+{
+    ConnectionMetrics::Scope scope{mMetrics, ConnectionMetrics::Operation::Select};
 
-    return rows;
+    auto&& sql = SqliteTraits::SqlSelectParameterized(table, "*", filters);
+    adviseIndex(table, "*", sql, filters);
+
+    return readThrough<Rows>(table, sql, scope, [this, &sql, &scope] {
+        Rows rows; // will represent an array of size N-by-M
+
+        Statement statement;
+        try
+        {
+            statement = prepare(sql);
+        }
+        catch (const sqlite::sqlite_exception& e)
+        {
+            std::cerr << "select(), could not prepare statement, got error code: " << e.get_code() << std::endl;
+            return rows;
+        }
+
+        scope.prepared();
+
+        std::size_t bytes          = 0;
+        const auto numberOfColumns = statement.columnCount();
+        while (statement.step())
+        {
+            Row row;
+            row.reserve(numberOfColumns);
+            for (int i = 0; i < numberOfColumns; ++i)
+            {
+                auto& value = row.emplace_back(ToValue(statement.column(i)));
+                bytes += value ? value->size() : 0;
+            }
+
+            rows.emplace_back(std::move(row));
+        }
+
+        scope.bytes(bytes);
+        return rows;
+    });
 }
 
 Rows Connection::select(const std::string& table, const std::string& col, const KeyValues& filters)
 {
-    Rows rows; // will represent an array of size N-by-1
+    ConnectionMetrics::Scope scope{mMetrics, ConnectionMetrics::Operation::Select};
 
-    auto&& sql = SqliteTraits::SqlSelect(table, col, filters);
-    std::vector<std::optional<std::string>> columnValues;
+    auto&& sql = SqliteTraits::SqlSelectParameterized(table, col, filters);
+    adviseIndex(table, col, sql, filters);
 
-    mDatabase << sql >> [&](std::unique_ptr<std::string> value) {
-        Row row{value ? std::optional<std::string>(*value) : std::nullopt};
-        rows.emplace_back(row);
-    };
+    return selectColumn(table, sql, scope);
+}
 
-    return rows;
+Rows Connection::select(const std::string& table, const Filter& filter)
+{
+    ConnectionMetrics::Scope scope{mMetrics, ConnectionMetrics::Operation::Select};
+
+    auto&& sql = SqliteTraits::SqlSelectParameterized(table, "*", filter);
+    adviseIndex(table, "*", sql, filter);
+
+    return selectRows(table, sql, scope);
 }
 
-PrimaryKey Connection::insert(const std::string& table, const KeyValues& keyValues, bool transaction)
+Rows Connection::select(const std::string& table, const std::string& col, const Filter& filter)
 {
-    return insertRow(table, keyValues, transaction, false);
+    ConnectionMetrics::Scope scope{mMetrics, ConnectionMetrics::Operation::Select};
+
+    auto&& sql = SqliteTraits::SqlSelectParameterized(table, col, filter);
+    adviseIndex(table, col, sql, filter);
+
+    return selectColumn(table, sql, scope);
 }
 
-PrimaryKeys Connection::insert(const std::string& table, const Rows& rows, bool transaction)
+Rows Connection::query(const std::string& table, const QueryOptions& options, const Filter& filter)
 {
-    return insertRows(table, rows, transaction, false);
+    ConnectionMetrics::Scope scope{mMetrics, ConnectionMetrics::Operation::Query};
+
+    auto&& sql = SqliteTraits::SqlQueryParameterized(table, options, filter);
+    adviseIndex(table, "*", sql, filter);
+
+    return selectRows(table, sql, scope);
 }
 
-PrimaryKey Connection::insertOrReplace(const std::string& table, const KeyValues& keyValues, bool transaction)
+Page Connection::queryPage(const std::string& table,
+                           const PageOptions& options,
+                           const Filter& filter,
+                           const std::optional<PageToken>& after)
 {
-    return insertRow(table, keyValues, transaction, true);
+    ConnectionMetrics::Scope scope{mMetrics, ConnectionMetrics::Operation::QueryPage};
+
+    const auto seekColumnCount = static_cast<int>(options.seekColumns().size());
+
+    if (options.pageSize == 0)
+    {
+        throw std::invalid_argument("queryPage(), the page size must be at least 1");
+    }
+
+    if (after && after->after.size() != static_cast<std::size_t>(seekColumnCount))
+    {
+        throw std::invalid_argument("queryPage(), the page token does not match the key " + options.key);
+    }
+
+    Page page;
+
+    auto&& sql = SqliteTraits::SqlPageParameterized(table, options, filter, after);
+
+    auto statement = prepare(sql);
+    scope.prepared();
+
+    // the seek columns come last, and are not returned
+    std::size_t bytes          = 0;
+    const auto numberOfColumns = statement.columnCount() - seekColumnCount;
+    SqlRow last;
+    while (statement.step())
+    {
+        if (page.rows.size() == options.pageSize)
+        {
+            // the extra row: there is a next page, starting after the last row returned
+            page.next = PageToken{std::move(last)};
+            break;
+        }
+
+        Row row;
+        row.reserve(numberOfColumns);
+        for (int i = 0; i < numberOfColumns; ++i)
+        {
+            auto& value = row.emplace_back(ToValue(statement.column(i)));
+            bytes += value ? value->size() : 0;
+        }
+
+        page.rows.emplace_back(std::move(row));
+
+        last.clear();
+        for (int i = numberOfColumns; i < numberOfColumns + seekColumnCount; ++i)
+        {
+            last.emplace_back(statement.column(i));
+        }
+    }
+
+    scope.rows(page.rows.size());
+    scope.bytes(bytes);
+    return page;
 }
 
-PrimaryKeys Connection::insertOrReplace(const std::string& table, const Rows& rows, bool transaction)
+void Connection::select(ResultSet& result, const std::string& table, const KeyValues& filters)
 {
-    return insertRows(table, rows, transaction, true);
+    select(result, table, "*", filters);
 }
 
-void Connection::update(const std::string& table,
-                        const KeyValues& keyValues,
-                        const KeyValues& filters,
-                        bool transaction)
+void Connection::select(ResultSet& result,
+                        const std::string& table,
+                        const std::string& col,
+                        const KeyValues& filters)
 {
-    lockWriteAccess(transaction);
+    ConnectionMetrics::Scope scope{mMetrics, ConnectionMetrics::Operation::SelectResultSet};
 
-    auto&& sql = SqliteTraits::SqlUpdate(table, keyValues, filters);
-    mDatabase << sql;
+    auto&& sql = SqliteTraits::SqlSelectParameterized(table, col, filters);
 
-    unlockWriteAccess(transaction);
+    auto statement = prepare(sql);
+    scope.prepared();
+    result.reset(static_cast<std::size_t>(statement.columnCount()));
+
+    const CursorRow row{statement.get()};
+    while (statement.step())
+    {
+        result.append(row);
+    }
+
+    scope.rows(result.size());
+    scope.bytes(result.bytes());
 }
 
-void Connection::deleteRows(const std::string& table, const KeyValues& filters, bool transaction)
+SqlRows Connection::selectTyped(const std::string& table, const KeyValues& filters)
 {
-    lockWriteAccess(transaction);
+    ConnectionMetrics::Scope scope{mMetrics, ConnectionMetrics::Operation::SelectTyped};
 
-    auto&& sql = SqliteTraits::SqlDelete(table, filters);
-    mDatabase << sql;
+    SqlRows rows; // will represent an array of size N-by-M
 
-    unlockWriteAccess(transaction);
+    auto&& sql = SqliteTraits::SqlSelectParameterized(table, "*", filters);
+
+    auto statement = prepare(sql);
+    scope.prepared();
+
+    std::size_t bytes          = 0;
+    const auto numberOfColumns = statement.columnCount();
+    while (statement.step())
+    {
+        SqlRow row;
+        row.reserve(numberOfColumns);
+        for (int i = 0; i < numberOfColumns; ++i)
+        {
+            bytes += static_cast<std::size_t>(sqlite3_column_bytes(statement.get(), i));
+            row.emplace_back(statement.column(i));
+        }
+
+        rows.emplace_back(std::move(row));
+    }
+
+    scope.rows(rows.size());
+    scope.bytes(bytes);
+    return rows;
 }
 
-std::size_t Connection::count(const std::string& table, const KeyValues& filters)
+SqlRows Connection::selectTyped(const std::string& table, const std::string& col, const KeyValues& filters)
 {
-    return count(table, "*", filters);
+    ConnectionMetrics::Scope scope{mMetrics, ConnectionMetrics::Operation::SelectTyped};
+
+    SqlRows rows; // will represent an array of size N-by-1
+
+    auto&& sql = SqliteTraits::SqlSelectParameterized(table, col, filters);
+
+    auto statement = prepare(sql);
+    scope.prepared();
+
+    std::size_t bytes = 0;
+    while (statement.step())
+    {
+        bytes += static_cast<std::size_t>(sqlite3_column_bytes(statement.get(), 0));
+        rows.emplace_back(SqlRow{statement.column(0)});
+    }
+
+    scope.rows(rows.size());
+    scope.bytes(bytes);
+    return rows;
 }
 
-std::size_t Connection::count(const std::string& table, const std::string& col, const KeyValues& filters)
+RowCursor Connection::selectCursor(const std::string& table, const KeyValues& filters)
 {
-    std::size_t result{0};
-    auto sql = SqliteTraits::SqlCount(table, col, filters);
-    mDatabase << sql >> result;
-    return result;
+    return selectCursor(table, "*", filters);
 }
 
-double Connection::sum(const std::string& table, const std::string& col, const KeyValues& filters)
+RowCursor Connection::selectCursor(const std::string& table, const std::string& col, const KeyValues& filters)
 {
-    double sum{0.0};
-    auto sql = SqliteTraits::SqlSum(table, col, filters);
-    mDatabase << sql >> sum;
-    return sum;
+    // rows are read after the call returns, so only the statement preparation is accounted for
+    ConnectionMetrics::Scope scope{mMetrics, ConnectionMetrics::Operation::SelectCursor};
+
+    auto&& sql = SqliteTraits::SqlSelectParameterized(table, col, filters);
+    return RowCursor{prepare(sql)};
 }
 
-double Connection::average(const std::string& table, const std::string& col, const KeyValues& filters)
+PrimaryKey Connection::insert(const std::string& table, const KeyValues& keyValues, bool transaction)
 {
-    double average{0.0};
-    auto sql = SqliteTraits::SqlAvg(table, col, filters);
-    mDatabase << sql >> average;
-    return average;
+    ConnectionMetrics::Scope scope{mMetrics, ConnectionMetrics::Operation::Insert};
+
+    auto sql = SqliteTraits::SqlInsertParameterized(table, keyValues, false);
+    auto key = executeInsert(sql, transaction, &scope);
+    scope.rows(1);
+    return key;
 }
 
-void Connection::connectionHook()
+PrimaryKeys Connection::insert(const std::string& table, const Rows& rows, bool transaction)
 {
-    sqlite3_busy_timeout(mDatabase.connection().get(), kBusyTimeoutMs);
+    ConnectionMetrics::Scope scope{mMetrics, ConnectionMetrics::Operation::InsertRows};
+
+    auto keys = insertRows(table, rows, transaction, false);
+    scope.rows(keys.size());
+    return keys;
 }
 
-void Connection::lockWriteAccess(bool partOfTransaction)
+PrimaryKey Connection::insertOrReplace(const std::string& table, const KeyValues& keyValues, bool transaction)
 {
-    if (!mInTransaction || (mInTransaction && !partOfTransaction))
-    {
-        mWriteMutex.lock();
-    }
+    ConnectionMetrics::Scope scope{mMetrics, ConnectionMetrics::Operation::InsertOrReplace};
+
+    auto sql = SqliteTraits::SqlInsertParameterized(table, keyValues, true);
+    auto key = executeInsert(sql, transaction, &scope);
+    scope.rows(1);
+    return key;
 }
 
-void Connection::unlockWriteAccess(bool partOfTransaction)
+PrimaryKeys Connection::insertOrReplace(const std::string& table, const Rows& rows, bool transaction)
 {
-    if (!partOfTransaction)
-    {
-        mWriteMutex.unlock();
-    }
+    ConnectionMetrics::Scope scope{mMetrics, ConnectionMetrics::Operation::InsertOrReplaceRows};
+
+    auto keys = insertRows(table, rows, transaction, true);
+    scope.rows(keys.size());
+    return keys;
 }
 
-PrimaryKey Connection::insertRow(const std::string& table, const KeyValues& keyValues, bool transaction, bool replace)
+PrimaryKey Connection::upsert(const std::string& table,
+                              const KeyValues& keyValues,
+                              const std::vector<std::string>& conflictColumns,
+                              const std::vector<std::string>& updateColumns,
+                              bool transaction)
 {
-    lockWriteAccess(transaction);
+    ConnectionMetrics::Scope scope{mMetrics, ConnectionMetrics::Operation::Upsert};
 
-    auto sql = SqliteTraits::SqlInsert(table, keyValues, replace);
-    mDatabase << sql;
-    PrimaryKey key = mDatabase.last_insert_rowid();
+    CheckUpsert(conflictColumns, updateColumns);
 
-    unlockWriteAccess(transaction);
+    auto sql = SqliteTraits::SqlUpsertParameterized(table, keyValues, conflictColumns, updateColumns);
+    auto key = executeInsert(sql, transaction, &scope);
+    scope.rows(1);
     return key;
 }
 
-PrimaryKeys Connection::insertRows(const std::string& table, const Rows& rows, bool transaction, bool replace)
+PrimaryKeys Connection::upsert(const std::string& table,
+                               const Rows& rows,
+                               const std::vector<std::string>& conflictColumns,
+                               const std::vector<std::string>& updateColumns,
+                               bool transaction)
 {
-    PrimaryKeys primaryKeys;
+    ConnectionMetrics::Scope scope{mMetrics, ConnectionMetrics::Operation::UpsertRows};
+
+    CheckUpsert(conflictColumns, updateColumns);
 
     if (rows.empty())
     {
-        return primaryKeys;
+        return {};
     }
 
-    lockWriteAccess(transaction);
+    // a single-row statement, run for each row: its RETURNING row tells the rowid of the row updated, if any
+    auto sql  = SqliteTraits::SqlUpsertWithPlaceholders(table, {}, rows[0].size(), conflictColumns, updateColumns);
+    auto keys = insertRows(
+        sql,
+        rows.size(),
+        [&rows](Statement& statement, std::size_t row) { statement.bind(rows[row]); },
+        transaction,
+        rows.size());
+    scope.rows(keys.size());
+    return keys;
+}
 
-    auto sql = SqliteTraits::SqlInsertWithPlaceholders(table, rows[0].size(), replace);
-    auto pps = mDatabase << sql;
+void Connection::update(const std::string& table,
+                        const KeyValues& keyValues,
+                        const KeyValues& filters,
+                        bool transaction)
+{
+    ConnectionMetrics::Scope scope{mMetrics, ConnectionMetrics::Operation::Update};
 
-    for (const auto& row : rows)
-    {
-        primaryKeys.emplace_back(executePPS(pps, row));
-    }
+    auto&& sql = SqliteTraits::SqlUpdateParameterized(table, keyValues, filters);
+    adviseIndex(table, "*", sql, filters);
+    scope.rows(executeWrite(sql, transaction, &scope));
+}
 
-    unlockWriteAccess(transaction);
-    return primaryKeys;
+void Connection::deleteRows(const std::string& table, const KeyValues& filters, bool transaction)
+{
+    ConnectionMetrics::Scope scope{mMetrics, ConnectionMetrics::Operation::DeleteRows};
+
+    auto&& sql = SqliteTraits::SqlDeleteParameterized(table, filters);
+    adviseIndex(table, "*", sql, filters);
+    scope.rows(executeDelete(table, sql, transaction, &scope));
 }
 
-PrimaryKey Connection::executePPS(sqlite::database_binder& pps, const Row& row)
+void Connection::update(const std::string& table, const KeyValues& keyValues, const Filter& filter, bool transaction)
 {
-    PrimaryKey primaryKey;
+    ConnectionMetrics::Scope scope{mMetrics, ConnectionMetrics::Operation::Update};
 
-    for (size_t i = 0; i < row.size(); ++i)
-    {
-        if (row[i])
-        {
-            pps << row[i].value();
-        }
-        else
-        {
-            pps << nullptr;
-        }
-    }
+    auto&& sql = SqliteTraits::SqlUpdateParameterized(table, keyValues, filter);
+    adviseIndex(table, "*", sql, filter);
+    scope.rows(executeWrite(sql, transaction, &scope));
+}
 
-    pps.execute();
+void Connection::deleteRows(const std::string& table, const Filter& filter, bool transaction)
+{
+    ConnectionMetrics::Scope scope{mMetrics, ConnectionMetrics::Operation::DeleteRows};
+
+    auto&& sql = SqliteTraits::SqlDeleteParameterized(table, filter);
+    adviseIndex(table, "*", sql, filter);
+    scope.rows(executeDelete(table, sql, transaction, &scope));
+}
+
+std::size_t Connection::count(const std::string& table, const KeyValues& filters)
+{
+    return count(table, "*", filters);
+}
 
-    primaryKey = mDatabase.last_insert_rowid();
-    return primaryKey;
+std::size_t Connection::count(const std::string& table, const std::string& col, const KeyValues& filters)
+{
+    ConnectionMetrics::Scope scope{mMetrics, ConnectionMetrics::Operation::Count};
+
+    auto&& sql = SqliteTraits::SqlCountParameterized(table, col, filters);
+    adviseIndex(table, col, sql, filters);
+
+    return static_cast<std::size_t>(selectInt64(table, sql, scope));
+}
+
+double Connection::sum(const std::string& table, const std::string& col, const KeyValues& filters)
+{
+    ConnectionMetrics::Scope scope{mMetrics, ConnectionMetrics::Operation::Sum};
+
+    auto&& sql = SqliteTraits::SqlSumParameterized(table, col, filters);
+    adviseIndex(table, col, sql, filters);
+
+    return selectDouble(table, sql, scope);
+}
+
+double Connection::average(const std::string& table, const std::string& col, const KeyValues& filters)
+{
+    ConnectionMetrics::Scope scope{mMetrics, ConnectionMetrics::Operation::Average};
+
+    auto&& sql = SqliteTraits::SqlAvgParameterized(table, col, filters);
+    adviseIndex(table, col, sql, filters);
+
+    return selectDouble(table, sql, scope);
+}
+
+std::size_t Connection::count(const std::string& table, const Filter& filter)
+{
+    return count(table, "*", filter);
+}
+
+std::size_t Connection::count(const std::string& table, const std::string& col, const Filter& filter)
+{
+    ConnectionMetrics::Scope scope{mMetrics, ConnectionMetrics::Operation::Count};
+
+    auto&& sql = SqliteTraits::SqlCountParameterized(table, col, filter);
+    adviseIndex(table, col, sql, filter);
+
+    return static_cast<std::size_t>(selectInt64(table, sql, scope));
+}
+
+double Connection::sum(const std::string& table, const std::string& col, const Filter& filter)
+{
+    ConnectionMetrics::Scope scope{mMetrics, ConnectionMetrics::Operation::Sum};
+
+    auto&& sql = SqliteTraits::SqlSumParameterized(table, col, filter);
+    adviseIndex(table, col, sql, filter);
+
+    return selectDouble(table, sql, scope);
+}
+
+double Connection::average(const std::string& table, const std::string& col, const Filter& filter)
+{
+    ConnectionMetrics::Scope scope{mMetrics, ConnectionMetrics::Operation::Average};
+
+    auto&& sql = SqliteTraits::SqlAvgParameterized(table, col, filter);
+    adviseIndex(table, col, sql, filter);
+
+    return selectDouble(table, sql, scope);
+}
+
+SqlRow Connection::aggregate(const std::string& table, const Aggregates& aggregates, const KeyValues& filters)
+{
+    // without GROUP BY, an aggregate query yields exactly one row, even when no row matches
+    auto rows = aggregate(table, {}, aggregates, filters);
+    return rows.empty() ? SqlRow(aggregates.size()) : std::move(rows.front());
+}
+
+SqlRows Connection::aggregate(const std::string& table,
+                              const std::vector<std::string>& groupBy,
+                              const Aggregates& aggregates,
+                              const KeyValues& filters)
+{
+    ConnectionMetrics::Scope scope{mMetrics, ConnectionMetrics::Operation::Aggregate};
+
+    SqlRows rows; // will represent an array of size groups-by-(groupBy + aggregates)
+
+    auto&& sql = SqliteTraits::SqlAggregateParameterized(table, groupBy, aggregates, filters);
+
+    auto statement = prepare(sql);
+    scope.prepared();
+
+    const auto numberOfColumns = statement.columnCount();
+    while (statement.step())
+    {
+        SqlRow row;
+        row.reserve(numberOfColumns);
+        for (int i = 0; i < numberOfColumns; ++i)
+        {
+            row.emplace_back(statement.column(i));
+        }
+
+        rows.emplace_back(std::move(row));
+    }
+
+    scope.rows(rows.size());
+    return rows;
+}
+
+BulkLoadStats Connection::bulkLoad(const std::string& table,
+                                   std::istream& input,
+                                   const BulkLoadOptions& options,
+                                   bool transaction)
+{
+    ConnectionMetrics::Scope scope{mMetrics, ConnectionMetrics::Operation::BulkLoad};
+
+    BulkLoadStats stats;
+
+    DelimitedReader reader{input, options.delimiter, options.quote};
+    auto more = reader.next();
+
+    auto columns = options.columns;
+    if (options.header && more)
+    {
+        if (columns.empty())
+        {
+            for (std::size_t i = 0; i < reader.size(); ++i)
+            {
+                columns.emplace_back(reader.field(i));
+            }
+        }
+
+        more = reader.next();
+    }
+
+    if (more)
+    {
+        const auto fieldCount     = columns.empty() ? reader.size() : columns.size();
+        const auto commitInterval = std::max<std::size_t>(options.commitInterval, 1);
+
+        auto sql       = SqliteTraits::SqlInsertWithPlaceholders(table, columns, fieldCount, options.conflictPolicy);
+        auto statement = prepare(sql);
+
+        while (more)
+        {
+            std::size_t batchRows = 0;
+            const auto insertBatch = [&] {
+                do
+                {
+                    if (reader.size() != fieldCount)
+                    {
+                        throw std::runtime_error("bulkLoad(), line " + std::to_string(reader.lineNumber())
+                                                 + ": expected " + std::to_string(fieldCount) + " fields, got "
+                                                 + std::to_string(reader.size()));
+                    }
+
+                    for (std::size_t i = 0; i < fieldCount; ++i)
+                    {
+                        const auto index = static_cast<int>(i) + 1;
+                        if (reader.isEmpty(i))
+                        {
+                            statement.bindNull(index);
+                        }
+                        else
+                        {
+                            statement.bindText(index, reader.field(i));
+                        }
+                    }
+
+                    statement.execute();
+                    statement.reset();
+
+                    ++batchRows;
+                    more = reader.next();
+                } while (more && batchRows < commitInterval);
+            };
+
+            if (transaction)
+            {
+                // the write mutex and the transaction are the caller's: a batch is a savepoint, undone alone
+                lockWriteAccess(transaction);
+
+                try
+                {
+                    execute("savepoint bulk_load;");
+                    const auto changes = mChangeStream ? mChangeStream->savepoint() : 0;
+
+                    try
+                    {
+                        insertBatch();
+                        executeCommit("release bulk_load;");
+                    }
+                    catch (...)
+                    {
+                        statement.reset();
+                        undoSavepoint("bulk_load", changes);
+                        throw;
+                    }
+                }
+                catch (...)
+                {
+                    unlockWriteAccess(transaction);
+                    throw;
+                }
+
+                unlockWriteAccess(transaction);
+            }
+            else
+            {
+                acquireWriteMutex();
+                std::lock_guard<std::mutex> lock(mWriteMutex, std::adopt_lock);
+                mInTransaction = true;
+
+                try
+                {
+                    execute("begin;");
+                    insertBatch();
+                    executeCommit("commit;");
+                }
+                catch (...)
+                {
+                    try
+                    {
+                        mDatabase << "rollback;";
+                    }
+                    catch (...)
+                    {
+                        // no transaction left to roll back, e.g. if begin failed
+                    }
+
+                    mInTransaction = false;
+                    throw;
+                }
+
+                mInTransaction = false;
+            }
+
+            stats.rows += batchRows;
+            ++stats.commits;
+            scope.rows(batchRows);
+        }
+    }
+
+    stats.elapsed = scope.elapsed(); // timed from the same clock read as the call's latency
+
+    const auto seconds = std::chrono::duration<double>(stats.elapsed).count();
+    if (seconds > 0)
+    {
+        stats.rowsPerSecond = static_cast<double>(stats.rows) / seconds;
+    }
+
+    return stats;
+}
+
+BulkLoadStats Connection::bulkLoad(const std::string& table,
+                                   const std::string& path,
+                                   const BulkLoadOptions& options,
+                                   bool transaction)
+{
+    std::ifstream file{path, std::ios::binary};
+    if (!file)
+    {
+        throw std::runtime_error("bulkLoad(), could not open file: " + path);
+    }
+
+    return bulkLoad(table, file, options, transaction);
+}
+
+ConnectionMetrics::Stats Connection::stats() const
+{
+    return mMetrics.snapshot();
+}
+
+StatementCache::Stats Connection::statementCacheStats() const
+{
+    return mStatementCache.stats();
+}
+
+std::optional<GroupCommit::Stats> Connection::groupCommitStats() const
+{
+    if (!mGroupCommit)
+    {
+        return std::nullopt;
+    }
+
+    return mGroupCommit->stats();
+}
+
+std::optional<QueryProfiler::Stats> Connection::profilerStats() const
+{
+    if (!mProfiler)
+    {
+        return std::nullopt;
+    }
+
+    return mProfiler->stats();
+}
+
+std::vector<QueryProfiler::Entry> Connection::slowQueries() const
+{
+    if (!mProfiler)
+    {
+        return {};
+    }
+
+    return mProfiler->slowQueries();
+}
+
+void Connection::dumpSlowQueries(std::ostream& out) const
+{
+    if (mProfiler)
+    {
+        mProfiler->dump(out);
+    }
+}
+
+QueryPlan Connection::explain(const std::string& table, const KeyValues& filters)
+{
+    return explain(SqliteTraits::SqlSelectParameterized(table, "*", filters));
+}
+
+QueryPlan Connection::explain(const std::string& table, const Filter& filter)
+{
+    return explain(SqliteTraits::SqlSelectParameterized(table, "*", filter));
+}
+
+QueryPlan Connection::explain(const ParameterizedSql& sql)
+{
+    // not cached: plans are only asked for once per statement shape
+    const auto explainSql = "EXPLAIN QUERY PLAN " + sql.sql;
+#if DEBUG
+    std::cout << "Built SQL: " << explainSql << std::endl;
+#endif
+
+    sqlite3_stmt* stmt = nullptr;
+    auto hresult       = sqlite3_prepare_v2(mDatabase.connection().get(), explainSql.c_str(), -1, &stmt, nullptr);
+    if (hresult != SQLITE_OK)
+    {
+        sqlite3_finalize(stmt);
+        sqlite::errors::throw_sqlite_error(hresult, explainSql);
+    }
+
+    Statement statement{stmt, explainSql, nullptr, 0};
+    statement.bind(sql.params);
+
+    // columns: id, parent, notused, detail
+    QueryPlan plan;
+    while (statement.step())
+    {
+        auto& step  = plan.steps.emplace_back(QueryPlan::ParseStep(
+            reinterpret_cast<const char*>(sqlite3_column_text(statement.get(), 3))));
+        step.id     = sqlite3_column_int(statement.get(), 0);
+        step.parent = sqlite3_column_int(statement.get(), 1);
+    }
+
+    return plan;
+}
+
+std::vector<IndexAdvisor::Advice> Connection::indexAdvice() const
+{
+    if (!mIndexAdvisor)
+    {
+        return {};
+    }
+
+    return mIndexAdvisor->advice();
+}
+
+std::size_t Connection::createAdvisedIndexes()
+{
+    const auto advice = indexAdvice();
+    for (const auto& index : advice)
+    {
+        applySql(index.sql);
+    }
+
+    if (mIndexAdvisor)
+    {
+        mIndexAdvisor->clear();
+    }
+
+    return advice.size();
+}
+
+std::optional<ResultCache::Stats> Connection::resultCacheStats() const
+{
+    if (!mResultCache)
+    {
+        return std::nullopt;
+    }
+
+    return mResultCache->stats();
+}
+
+void Connection::clearResultCache()
+{
+    if (mResultCache)
+    {
+        mResultCache->clear();
+    }
+}
+
+ChangeStream::Poll Connection::pollChanges(std::uint64_t after, std::size_t max) const
+{
+    if (!mChangeStream)
+    {
+        return {};
+    }
+
+    return mChangeStream->poll(after, max);
+}
+
+std::uint64_t Connection::subscribeChanges(ChangeStream::Callback callback, std::uint64_t after)
+{
+    if (!mChangeStream)
+    {
+        throw std::runtime_error("subscribeChanges(), the change stream is not enabled on " + mDatabasePath);
+    }
+
+    return mChangeStream->subscribe(std::move(callback), after);
+}
+
+void Connection::unsubscribeChanges(std::uint64_t id)
+{
+    if (mChangeStream)
+    {
+        mChangeStream->unsubscribe(id);
+    }
+}
+
+bool Connection::connectionHook()
+{
+    // a new DB connection: SQLite's defaults apply again
+    mForeignKeys.reset();
+    mSavepoints.clear();
+
+    sqlite3_busy_handler(mDatabase.connection().get(), &Connection::BusyHandler, this);
+
+    if (mProfiler)
+    {
+        mProfiler->attach(mDatabase.connection().get());
+    }
+
+    if (mResultCache || mChangeStream)
+    {
+        sqlite3_update_hook(mDatabase.connection().get(), &Connection::UpdateHook, this);
+        sqlite3_rollback_hook(mDatabase.connection().get(), &Connection::RollbackHook, this);
+    }
+
+    if (mResultCache)
+    {
+        mResultCache->invalidateAll();
+    }
+
+    if (mChangeStream)
+    {
+        sqlite3_commit_hook(mDatabase.connection().get(), &Connection::CommitHook, this);
+    }
+
+    for (const auto& [name, value] : mOptions.pragmas())
+    {
+        auto sql = SqliteTraits::SqlPragma(name, value);
+#if DEBUG
+        std::cout << "Built SQL: " << sql << std::endl;
+#endif
+
+        try
+        {
+            mDatabase << sql;
+        }
+        catch (const sqlite::sqlite_exception& e)
+        {
+            std::cerr << "Could not apply " << sql << " on " << mDatabasePath << ", got error code: " << e.get_code()
+                      << std::endl;
+            return false;
+        }
+    }
+
+    return true;
+}
+
+int Connection::BusyHandler(void* context, int retries)
+{
+    // waits outside of operations, e.g. for the PRAGMAs applied by open(), are timed from the statement's first retry
+    thread_local ConnectionMetrics::Clock::time_point waitStart;
+
+    auto* connection = static_cast<Connection*>(context);
+    auto& metrics    = connection->mMetrics;
+    auto* scope      = ConnectionMetrics::Scope::Current(metrics);
+    const auto now   = ConnectionMetrics::Clock::now();
+
+    BusyWait wait;
+    if (scope != nullptr)
+    {
+        wait.operation = scope->operation();
+        wait.retries   = scope->busyRetries();
+        wait.elapsed   = scope->elapsed();
+    }
+    else
+    {
+        waitStart    = retries == 0 ? now : waitStart;
+        wait.retries = retries;
+        wait.elapsed = now - waitStart;
+    }
+
+    if (retries == 0)
+    {
+        metrics.recordBusy(wait.operation);
+    }
+
+    const auto delay = connection->mBusyPolicy->delay(wait);
+    if (!delay)
+    {
+        metrics.recordBusyTimeout(wait.operation);
+        BusyTimeoutError::GaveUp(connection->mDatabase.connection().get(), wait);
+        return 0; // give up: SQLITE_BUSY is returned
+    }
+
+    std::this_thread::sleep_for(*delay);
+    metrics.recordBusyWait(wait.operation, ConnectionMetrics::Clock::now() - now);
+    if (scope != nullptr)
+    {
+        scope->busyRetried();
+    }
+
+    return 1;
+}
+
+void Connection::UpdateHook(void* context, int operation, const char*, const char* table, sqlite3_int64 rowid)
+{
+    auto* connection = static_cast<Connection*>(context);
+
+    if (connection->mResultCache)
+    {
+        connection->mResultCache->invalidate(table);
+    }
+
+    if (connection->mChangeStream)
+    {
+        connection->mChangeStream->record(operation, table, rowid);
+    }
+}
+
+void Connection::RollbackHook(void* context)
+{
+    auto* connection = static_cast<Connection*>(context);
+
+    if (connection->mResultCache)
+    {
+        connection->mResultCache->invalidateAll();
+    }
+
+    if (connection->mChangeStream)
+    {
+        connection->mChangeStream->rollback();
+    }
+}
+
+int Connection::CommitHook(void* context)
+{
+    // the commit may still fail: its changes are published by settleChanges() once the committing statement returns
+    static_cast<Connection*>(context)->mChangeStream->commit();
+    return 0; // let the commit proceed
+}
+
+void Connection::CheckSavepointName(const std::string& name)
+{
+    const auto isNameChar = [](unsigned char ch) { return std::isalnum(ch) || ch == '_'; };
+    if (name.empty() || std::isdigit(static_cast<unsigned char>(name.front()))
+        || !std::all_of(name.cbegin(), name.cend(), isNameChar))
+    {
+        throw std::invalid_argument("invalid savepoint name: " + name);
+    }
+}
+
+void Connection::CheckUpsert(const std::vector<std::string>& conflictColumns,
+                             const std::vector<std::string>& updateColumns)
+{
+    // the rowid of an updated row is only known from RETURNING
+    if (sqlite3_libversion_number() < kReturningMinVersion)
+    {
+        throw std::runtime_error("upsert() requires SQLite 3.35 or later");
+    }
+
+    if (conflictColumns.empty() || updateColumns.empty())
+    {
+        throw std::invalid_argument("upsert() requires conflict columns and columns to update");
+    }
+}
+
+Connection::Savepoints::iterator Connection::findSavepoint(const std::string& name)
+{
+    // SQLite picks the most recent savepoint of that name
+    auto it = std::find_if(mSavepoints.rbegin(),
+                           mSavepoints.rend(),
+                           [&name](const Savepoints::value_type& savepoint) { return savepoint.first == name; });
+    return it == mSavepoints.rend() ? mSavepoints.end() : std::prev(it.base());
+}
+
+void Connection::adviseIndex(const std::string& table,
+                             const std::string& col,
+                             const ParameterizedSql& sql,
+                             const Filter& filter)
+{
+    // SQLite's own tables are not worth indexing, e.g. sqlite_master for tableExists()
+    if (!mIndexAdvisor || table.rfind("sqlite_", 0) == 0 || mIndexAdvisor->record(sql.sql))
+    {
+        return;
+    }
+
+    auto columns = IndexAdvisor::FilterColumns(filter, col);
+    mIndexAdvisor->learn(sql.sql, table, std::move(columns), explain(sql).fullScan());
+}
+
+void Connection::adviseIndex(const std::string& table,
+                             const std::string& col,
+                             const ParameterizedSql& sql,
+                             const KeyValues& filters)
+{
+    if (mIndexAdvisor)
+    {
+        adviseIndex(table, col, sql, Filter::Equal(filters));
+    }
+}
+
+Statement Connection::prepare(const std::string& sql)
+{
+    return mStatementCache.acquire(mDatabase.connection().get(), sql);
+}
+
+Statement Connection::prepare(const ParameterizedSql& sql)
+{
+    auto statement = prepare(sql.sql);
+    statement.bind(sql.params);
+    return statement;
+}
+
+std::chrono::nanoseconds Connection::lockWriteAccess(bool partOfTransaction)
+{
+    if (!mInTransaction || (mInTransaction && !partOfTransaction))
+    {
+        return acquireWriteMutex();
+    }
+
+    return {};
+}
+
+void Connection::unlockWriteAccess(bool partOfTransaction)
+{
+    if (!partOfTransaction)
+    {
+        mWriteMutex.unlock();
+    }
+}
+
+std::chrono::nanoseconds Connection::acquireWriteMutex()
+{
+    if (mWriteMutex.try_lock())
+    {
+        return {};
+    }
+
+    const auto start = ConnectionMetrics::Clock::now();
+    mWriteMutex.lock();
+    const auto waited = std::chrono::duration_cast<std::chrono::nanoseconds>(ConnectionMetrics::Clock::now() - start);
+
+    mMetrics.recordWriteLockWait(waited);
+    return waited;
+}
+
+PrimaryKey Connection::executeInsert(const ParameterizedSql& sql, bool transaction, ConnectionMetrics::Scope* scope)
+{
+    return executeInsert(sql.sql, [&sql](Statement& statement) { statement.bind(sql.params); }, transaction, scope);
+}
+
+PrimaryKey
+Connection::executeInsert(const std::string& sql, const Binder& bind, bool transaction, ConnectionMetrics::Scope* scope)
+{
+    if (!transaction && mGroupCommit)
+    {
+        // run by the batch leader, possibly on another thread, after the caller's scope started
+        return mGroupCommit->submit([&] { return executeInsert(sql, bind, true, nullptr); });
+    }
+
+    const auto waited = lockWriteAccess(transaction);
+
+    PrimaryKey key;
+    try
+    {
+        auto statement = prepare(sql);
+        bind(statement);
+        if (scope != nullptr)
+        {
+            scope->prepared(waited);
+        }
+
+        key = executeAndGetRowid(statement);
+    }
+    catch (...)
+    {
+        settleChanges();
+        unlockWriteAccess(transaction);
+        throw;
+    }
+
+    settleChanges();
+
+    unlockWriteAccess(transaction);
+    return key;
+}
+
+PrimaryKey Connection::executeAndGetRowid(Statement& statement)
+{
+    if (!statement.step())
+    {
+        return mDatabase.last_insert_rowid();
+    }
+
+    // RETURNING rowid: also set for a row updated by an upsert, unlike the last insert rowid
+    const PrimaryKey key = sqlite3_column_int64(statement.get(), 0);
+    statement.execute();
+    return key;
+}
+
+std::uint64_t Connection::executeWrite(const ParameterizedSql& sql, bool transaction, ConnectionMetrics::Scope* scope)
+{
+    return executeWrite(sql.sql, [&sql](Statement& statement) { statement.bind(sql.params); }, transaction, scope);
+}
+
+std::uint64_t
+Connection::executeWrite(const std::string& sql, const Binder& bind, bool transaction, ConnectionMetrics::Scope* scope)
+{
+    if (!transaction && mGroupCommit)
+    {
+        return static_cast<std::uint64_t>(
+            mGroupCommit->submit([&] { return static_cast<PrimaryKey>(executeWrite(sql, bind, true, nullptr)); }));
+    }
+
+    const auto waited = lockWriteAccess(transaction);
+
+    std::uint64_t changes;
+    try
+    {
+        auto statement = prepare(sql);
+        bind(statement);
+        if (scope != nullptr)
+        {
+            scope->prepared(waited);
+        }
+
+        statement.execute();
+        changes = static_cast<std::uint64_t>(sqlite3_changes(mDatabase.connection().get()));
+    }
+    catch (...)
+    {
+        settleChanges();
+        unlockWriteAccess(transaction);
+        throw;
+    }
+
+    settleChanges();
+
+    unlockWriteAccess(transaction);
+    return changes;
+}
+
+std::uint64_t Connection::executeDelete(const std::string& table,
+                                        const ParameterizedSql& sql,
+                                        bool transaction,
+                                        ConnectionMetrics::Scope* scope)
+{
+    return executeDelete(
+        table, sql.sql, [&sql](Statement& statement) { statement.bind(sql.params); }, transaction, scope);
+}
+
+std::uint64_t Connection::executeDelete(const std::string& table,
+                                        const std::string& sql,
+                                        const Binder& bind,
+                                        bool transaction,
+                                        ConnectionMetrics::Scope* scope)
+{
+    std::uint64_t changes;
+
+    // without a WHERE clause, SQLite empties the table without reporting each row to the update hook
+    if (mChangeStream && sql.find(" WHERE ") == std::string::npos)
+    {
+        auto filtered = sql;
+        filtered.insert(filtered.size() - 1, " WHERE 1");
+        changes = executeWrite(filtered, bind, transaction, scope);
+    }
+    else
+    {
+        changes = executeWrite(sql, bind, transaction, scope);
+    }
+
+    // deleting every row skips the update hook
+    if (mResultCache)
+    {
+        mResultCache->invalidate(table.c_str());
+    }
+
+    return changes;
+}
+
+PrimaryKeys Connection::insertRows(const std::string& table, const Rows& rows, bool transaction, bool replace)
+{
+    if (rows.empty())
+    {
+        return {};
+    }
+
+    auto sql = SqliteTraits::SqlInsertWithPlaceholders(table, rows[0].size(), replace);
+    return insertRows(
+        sql,
+        rows.size(),
+        [&rows](Statement& statement, std::size_t row) { statement.bind(rows[row]); },
+        transaction,
+        kInsertChunkRows);
+}
+
+PrimaryKeys Connection::insertRows(const std::string& sql,
+                                   std::size_t rowCount,
+                                   const RowBinder& bindRow,
+                                   bool transaction,
+                                   std::size_t rowsPerChunk)
+{
+    PrimaryKeys primaryKeys;
+
+    if (rowCount == 0)
+    {
+        return primaryKeys;
+    }
+
+    primaryKeys.reserve(rowCount);
+
+    lockWriteAccess(transaction);
+
+    try
+    {
+        // one cached single-row statement, re-bound for each row, so keys are read in the order of the rows
+        auto statement = prepare(sql);
+
+        for (std::size_t first = 0; first < rowCount; first += rowsPerChunk)
+        {
+            const auto last = std::min(rowCount, first + rowsPerChunk);
+
+            // a transaction of its own outside of one, undone alone within one
+            execute("savepoint insert_rows;");
+            const auto changes = mChangeStream ? mChangeStream->savepoint() : 0;
+
+            try
+            {
+                for (std::size_t row = first; row < last; ++row)
+                {
+                    bindRow(statement, row);
+                    primaryKeys.emplace_back(executeAndGetRowid(statement));
+                    statement.reset();
+                }
+
+                executeCommit("release insert_rows;");
+            }
+            catch (...)
+            {
+                statement.reset();
+                undoSavepoint("insert_rows", changes);
+                throw;
+            }
+        }
+    }
+    catch (...)
+    {
+        unlockWriteAccess(transaction);
+        throw;
+    }
+
+    unlockWriteAccess(transaction);
+    return primaryKeys;
+}
+
+void Connection::execute(const std::string& sql)
+{
+    BusyTimeoutError::Clear();
+
+    try
+    {
+        mDatabase << sql;
+    }
+    catch (const sqlite::errors::busy& e)
+    {
+        BusyTimeoutError::Throw(mDatabase.connection().get(), e.get_extended_code(), e.get_sql());
+    }
+}
+
+void Connection::executeCommit(const std::string& sql)
+{
+    try
+    {
+        execute(sql);
+    }
+    catch (...)
+    {
+        settleChanges();
+        throw;
+    }
+
+    settleChanges();
+}
+
+void Connection::settleChanges()
+{
+    if (mChangeStream)
+    {
+        // a failed COMMIT, e.g. with SQLITE_BUSY, leaves the transaction active, while a failed autocommit is
+        // rolled back, which the rollback hook reports
+        mChangeStream->settle(sqlite3_get_autocommit(mDatabase.connection().get()) != 0);
+    }
+}
+
+void Connection::undoSavepoint(const std::string& name, std::size_t changes)
+{
+    // SQLite rolls back the whole transaction by itself on some errors, e.g. SQLITE_FULL, taking the savepoint along
+    if (sqlite3_get_autocommit(mDatabase.connection().get()) == 0)
+    {
+        mDatabase << "rollback to " + name + ";";
+        mDatabase << "release " + name + ";";
+    }
+
+    // the rollback hook only reports full rollbacks
+    if (mResultCache)
+    {
+        mResultCache->invalidateAll();
+    }
+
+    if (mChangeStream)
+    {
+        mChangeStream->rollbackTo(changes);
+    }
+}
+
+Rows Connection::selectRows(const std::string& table, const ParameterizedSql& sql, ConnectionMetrics::Scope& scope)
+{
+    return readThrough<Rows>(table, sql, scope, [this, &sql, &scope] {
+        Rows rows; // will represent an array of size N-by-M
+
+        auto statement = prepare(sql);
+        scope.prepared();
+
+        std::size_t bytes          = 0;
+        const auto numberOfColumns = statement.columnCount();
+        while (statement.step())
+        {
+            Row row;
+            row.reserve(numberOfColumns);
+            for (int i = 0; i < numberOfColumns; ++i)
+            {
+                auto& value = row.emplace_back(ToValue(statement.column(i)));
+                bytes += value ? value->size() : 0;
+            }
+
+            rows.emplace_back(std::move(row));
+        }
+
+        scope.bytes(bytes);
+        return rows;
+    });
+}
+
+Rows Connection::selectColumn(const std::string& table, const ParameterizedSql& sql, ConnectionMetrics::Scope& scope)
+{
+    return readThrough<Rows>(table, sql, scope, [this, &sql, &scope] {
+        Rows rows; // will represent an array of size N-by-1
+
+        auto statement = prepare(sql);
+        scope.prepared();
+
+        std::size_t bytes = 0;
+        while (statement.step())
+        {
+            auto& row = rows.emplace_back(Row{ToValue(statement.column(0))});
+            bytes += row[0] ? row[0]->size() : 0;
+        }
+
+        scope.bytes(bytes);
+        return rows;
+    });
+}
+
+std::int64_t
+Connection::selectInt64(const std::string& table, const ParameterizedSql& sql, ConnectionMetrics::Scope& scope)
+{
+    return readThrough<std::int64_t>(table, sql, scope, [this, &sql, &scope] {
+        auto statement = prepare(sql);
+        scope.prepared();
+
+        return statement.step() ? sqlite3_column_int64(statement.get(), 0) : std::int64_t{0};
+    });
+}
+
+double Connection::selectDouble(const std::string& table, const ParameterizedSql& sql, ConnectionMetrics::Scope& scope)
+{
+    return readThrough<double>(table, sql, scope, [this, &sql, &scope] {
+        auto statement = prepare(sql);
+        scope.prepared();
+
+        return statement.step() ? sqlite3_column_double(statement.get(), 0) : 0.0;
+    });
+}
+
+template<typename TResult, typename TRead>
+TResult Connection::readThrough(const std::string& table,
+                                const ParameterizedSql& sql,
+                                ConnectionMetrics::Scope& scope,
+                                TRead&& read)
+{
+    if (!mResultCache)
+    {
+        auto result = read();
+        if constexpr (std::is_same_v<TResult, Rows>)
+        {
+            scope.rows(result.size());
+        }
+
+        return result;
+    }
+
+    if (mOptions.resultCache->checkDataVersion)
+    {
+        mResultCache->checkDataVersion(dataVersion());
+    }
+
+    auto key = ResultCache::Key(sql);
+    if (auto cached = mResultCache->get(key, table))
+    {
+        scope.prepared();
+
+        auto result = std::get<TResult>(std::move(*cached));
+        if constexpr (std::is_same_v<TResult, Rows>)
+        {
+            scope.rows(result.size());
+        }
+
+        return result;
+    }
+
+    // taken before reading, so that a result racing with a write is not cached
+    const auto version = mResultCache->version(table);
+
+    auto result = read();
+    if constexpr (std::is_same_v<TResult, Rows>)
+    {
+        scope.rows(result.size());
+    }
+
+    mResultCache->put(std::move(key), table, version, result);
+    return result;
+}
+
+std::int64_t Connection::dataVersion()
+{
+    static const std::string kDataVersionSql = "PRAGMA data_version;";
+
+    auto statement = prepare(kDataVersionSql);
+    return statement.step() ? sqlite3_column_int64(statement.get(), 0) : 0;
+}
+
+void Connection::commitBatch(const GroupCommit::Batch& batch)
+{
+    // batched writes run as part of this transaction, so they must not take the write mutex themselves
+    acquireWriteMutex();
+    std::lock_guard<std::mutex> lock(mWriteMutex, std::adopt_lock);
+    mInTransaction = true;
+
+    try
+    {
+#if DEBUG
+        std::cout << "Built SQL: begin; (group commit of " << batch.size() << " writes)" << std::endl;
+#endif
+        execute("begin;");
+
+        for (auto request : batch)
+        {
+            execute("savepoint group_commit;");
+            const auto changes = mChangeStream ? mChangeStream->savepoint() : 0;
+
+            try
+            {
+                request->result = request->operation();
+                execute("release group_commit;");
+            }
+            catch (...)
+            {
+                request->error = std::current_exception();
+                undoSavepoint("group_commit", changes);
+            }
+        }
+
+        executeCommit("commit;");
+    }
+    catch (...)
+    {
+        try
+        {
+            mDatabase << "rollback;";
+        }
+        catch (...)
+        {
+            // no transaction left to roll back, e.g. if begin failed
+        }
+
+        mInTransaction = false;
+        throw;
+    }
+
+    mInTransaction = false;
 }
 
 } // namespace sqlite_wrapper
@@ -0,0 +1,200 @@
+#include "ConnectionMetrics.hpp"
+
+#include <algorithm>
+
+namespace sqlite_wrapper
+{
+
+const char* ConnectionMetrics::ToString(Operation operation)
+{
+    switch (operation)
+    {
+    case Operation::ApplySql:
+        return "applySql";
+    case Operation::BeginTransaction:
+        return "beginTransaction";
+    case Operation::CommitTransaction:
+        return "commitTransaction";
+    case Operation::RollbackTransaction:
+        return "rollbackTransaction";
+    case Operation::Select:
+        return "select";
+    case Operation::SelectResultSet:
+        return "selectResultSet";
+    case Operation::SelectTyped:
+        return "selectTyped";
+    case Operation::SelectCursor:
+        return "selectCursor";
+    case Operation::Query:
+        return "query";
+    case Operation::QueryPage:
+        return "queryPage";
+    case Operation::Insert:
+        return "insert";
+    case Operation::InsertRows:
+        return "insertRows";
+    case Operation::InsertOrReplace:
+        return "insertOrReplace";
+    case Operation::InsertOrReplaceRows:
+        return "insertOrReplaceRows";
+    case Operation::Upsert:
+        return "upsert";
+    case Operation::UpsertRows:
+        return "upsertRows";
+    case Operation::Update:
+        return "update";
+    case Operation::DeleteRows:
+        return "deleteRows";
+    case Operation::Count:
+        return "count";
+    case Operation::Sum:
+        return "sum";
+    case Operation::Average:
+        return "average";
+    case Operation::Aggregate:
+        return "aggregate";
+    case Operation::BulkLoad:
+        return "bulkLoad";
+    }
+
+    return "unknown";
+}
+
+ConnectionMetrics::ConnectionMetrics()
+    : mId{[] {
+        static std::atomic<std::uint64_t> lastId{0};
+        return lastId.fetch_add(1, std::memory_order_relaxed) + 1; // 0 marks free cache slots
+    }()}
+{
+}
+
+const ConnectionMetrics::OperationStats& ConnectionMetrics::Stats::operator[](Operation operation) const
+{
+    return operations[static_cast<std::size_t>(operation)];
+}
+
+void ConnectionMetrics::recordWriteLockWait(std::chrono::nanoseconds wait)
+{
+    mWriteLockWaits.fetch_add(1, std::memory_order_relaxed);
+    mWriteLockWaitTime.fetch_add(static_cast<std::uint64_t>(wait.count()), std::memory_order_relaxed);
+}
+
+ConnectionMetrics::Scope* ConnectionMetrics::Scope::Current(const ConnectionMetrics& metrics)
+{
+    // nested calls, e.g. the select of tableExists(), are part of the outermost one
+    Scope* current = nullptr;
+    for (auto* scope = Innermost(); scope != nullptr; scope = scope->mOuter)
+    {
+        if (&scope->mMetrics == &metrics)
+        {
+            current = scope;
+        }
+    }
+
+    return current;
+}
+
+ConnectionMetrics::Shard& ConnectionMetrics::registerShard()
+{
+    Shard* shard = nullptr;
+    {
+        const std::lock_guard<std::mutex> lock{mShardsMutex};
+
+        // a thread reusing the id of one that exited continues its counters
+        auto& registered = mShards[std::this_thread::get_id()];
+        if (!registered)
+        {
+            registered = std::make_unique<Shard>();
+        }
+        shard = registered.get();
+    }
+
+    // evicts the least recently registered shard, whose metrics may be gone anyway
+    auto& cachedShards = CachedShards();
+    std::rotate(cachedShards.rbegin(), cachedShards.rbegin() + 1, cachedShards.rend());
+    cachedShards.front() = {mId, shard};
+    return *shard;
+}
+
+ConnectionMetrics::BusyCounters& ConnectionMetrics::busyCounters(Operation operation)
+{
+    return mBusyOperations[static_cast<std::size_t>(operation)];
+}
+
+void ConnectionMetrics::recordBusy(std::optional<Operation> operation)
+{
+    mBusyEvents.fetch_add(1, std::memory_order_relaxed);
+    if (operation)
+    {
+        busyCounters(*operation).events.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void ConnectionMetrics::recordBusyWait(std::optional<Operation> operation, std::chrono::nanoseconds wait)
+{
+    const auto waitNs = static_cast<std::uint64_t>(wait.count());
+
+    mBusyRetries.fetch_add(1, std::memory_order_relaxed);
+    mBusyWaitTime.fetch_add(waitNs, std::memory_order_relaxed);
+    if (operation)
+    {
+        auto& counters = busyCounters(*operation);
+        counters.retries.fetch_add(1, std::memory_order_relaxed);
+        counters.waitTime.fetch_add(waitNs, std::memory_order_relaxed);
+    }
+}
+
+void ConnectionMetrics::recordBusyTimeout(std::optional<Operation> operation)
+{
+    mBusyTimeouts.fetch_add(1, std::memory_order_relaxed);
+    if (operation)
+    {
+        busyCounters(*operation).timeouts.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+ConnectionMetrics::Stats ConnectionMetrics::snapshot() const
+{
+    Stats stats;
+
+    {
+        const std::lock_guard<std::mutex> lock{mShardsMutex};
+        for (const auto& [thread, shard] : mShards)
+        {
+            for (std::size_t i = 0; i < kOperationCount; ++i)
+            {
+                const auto& counters = shard->operations[i];
+                auto& operation      = stats.operations[i];
+
+                operation.latency.add(counters.latency.snapshot());
+                operation.errors += counters.errors.load(std::memory_order_relaxed);
+                operation.rows += counters.rows.load(std::memory_order_relaxed);
+            }
+
+            stats.prepareTime += std::chrono::nanoseconds{shard->prepareTime.load(std::memory_order_relaxed)};
+            stats.bytesMaterialized += shard->bytesMaterialized.load(std::memory_order_relaxed);
+        }
+    }
+
+    for (std::size_t i = 0; i < kOperationCount; ++i)
+    {
+        const auto& counters = mBusyOperations[i];
+        auto& operation      = stats.operations[i];
+
+        operation.calls        = operation.latency.count;
+        operation.busyEvents   = counters.events.load(std::memory_order_relaxed);
+        operation.busyRetries  = counters.retries.load(std::memory_order_relaxed);
+        operation.busyWaitTime = std::chrono::nanoseconds{counters.waitTime.load(std::memory_order_relaxed)};
+        operation.busyTimeouts = counters.timeouts.load(std::memory_order_relaxed);
+    }
+
+    stats.writeLockWaits    = mWriteLockWaits.load(std::memory_order_relaxed);
+    stats.writeLockWaitTime = std::chrono::nanoseconds{mWriteLockWaitTime.load(std::memory_order_relaxed)};
+    stats.busyEvents        = mBusyEvents.load(std::memory_order_relaxed);
+    stats.busyRetries       = mBusyRetries.load(std::memory_order_relaxed);
+    stats.busyWaitTime      = std::chrono::nanoseconds{mBusyWaitTime.load(std::memory_order_relaxed)};
+    stats.busyTimeouts      = mBusyTimeouts.load(std::memory_order_relaxed);
+    return stats;
+}
+
+} // namespace sqlite_wrapper
@@ -0,0 +1,149 @@
+#include "ConnectionOptions.hpp"
+
+namespace sqlite_wrapper
+{
+
+namespace
+{
+
+std::string ToString(ConnectionOptions::JournalMode mode)
+{
+    switch (mode)
+    {
+    case ConnectionOptions::JournalMode::Delete:
+        return "DELETE";
+    case ConnectionOptions::JournalMode::Truncate:
+        return "TRUNCATE";
+    case ConnectionOptions::JournalMode::Persist:
+        return "PERSIST";
+    case ConnectionOptions::JournalMode::Memory:
+        return "MEMORY";
+    case ConnectionOptions::JournalMode::Wal:
+        return "WAL";
+    case ConnectionOptions::JournalMode::Off:
+        return "OFF";
+    }
+
+    return "DELETE";
+}
+
+std::string ToString(ConnectionOptions::Synchronous synchronous)
+{
+    switch (synchronous)
+    {
+    case ConnectionOptions::Synchronous::Off:
+        return "OFF";
+    case ConnectionOptions::Synchronous::Normal:
+        return "NORMAL";
+    case ConnectionOptions::Synchronous::Full:
+        return "FULL";
+    case ConnectionOptions::Synchronous::Extra:
+        return "EXTRA";
+    }
+
+    return "FULL";
+}
+
+std::string ToString(ConnectionOptions::TempStore tempStore)
+{
+    switch (tempStore)
+    {
+    case ConnectionOptions::TempStore::Default:
+        return "DEFAULT";
+    case ConnectionOptions::TempStore::File:
+        return "FILE";
+    case ConnectionOptions::TempStore::Memory:
+        return "MEMORY";
+    }
+
+    return "DEFAULT";
+}
+
+std::string ToString(ConnectionOptions::LockingMode lockingMode)
+{
+    switch (lockingMode)
+    {
+    case ConnectionOptions::LockingMode::Normal:
+        return "NORMAL";
+    case ConnectionOptions::LockingMode::Exclusive:
+        return "EXCLUSIVE";
+    }
+
+    return "NORMAL";
+}
+
+} // namespace
+
+std::vector<std::pair<std::string, std::string>> ConnectionOptions::pragmas() const
+{
+    std::vector<std::pair<std::string, std::string>> pragmas;
+
+    // page_size must come before anything that may create the DB file or switch it to WAL
+    if (pageSize)
+    {
+        pragmas.emplace_back("page_size", std::to_string(*pageSize));
+    }
+
+    if (lockingMode)
+    {
+        pragmas.emplace_back("locking_mode", ToString(*lockingMode));
+    }
+
+    if (journalMode)
+    {
+        pragmas.emplace_back("journal_mode", ToString(*journalMode));
+    }
+
+    if (synchronous)
+    {
+        pragmas.emplace_back("synchronous", ToString(*synchronous));
+    }
+
+    if (cacheSize)
+    {
+        pragmas.emplace_back("cache_size", std::to_string(*cacheSize));
+    }
+
+    if (mmapSize)
+    {
+        pragmas.emplace_back("mmap_size", std::to_string(*mmapSize));
+    }
+
+    if (tempStore)
+    {
+        pragmas.emplace_back("temp_store", ToString(*tempStore));
+    }
+
+    return pragmas;
+}
+
+ConnectionOptions ConnectionOptions::Durable()
+{
+    ConnectionOptions options;
+    options.journalMode = JournalMode::Wal;
+    options.synchronous = Synchronous::Full;
+    return options;
+}
+
+ConnectionOptions ConnectionOptions::Throughput()
+{
+    ConnectionOptions options;
+    options.journalMode = JournalMode::Wal;
+    options.synchronous = Synchronous::Normal;
+    options.cacheSize   = -64 * 1024;         // 64 MiB
+    options.mmapSize    = 256LL * 1024 * 1024; // 256 MiB
+    options.tempStore   = TempStore::Memory;
+    return options;
+}
+
+ConnectionOptions ConnectionOptions::ReadOnlyAnalytics()
+{
+    ConnectionOptions options;
+    options.readOnly  = true;
+    options.cacheSize = -256 * 1024;         // 256 MiB
+    options.mmapSize  = 1024LL * 1024 * 1024; // 1 GiB
+    options.tempStore = TempStore::Memory;
+    return options;
+}
+
+} // namespace sqlite_wrapper
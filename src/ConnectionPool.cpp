@@ -0,0 +1,390 @@
+#include "ConnectionPool.hpp"
+
+#include <algorithm>
+#include <utility>
+
+namespace sqlite_wrapper
+{
+
+ConnectionPool::Lease::Lease(ConnectionPool* pool, Connection* connection)
+    : mPool{pool}
+    , mConnection{connection}
+    , mStart{Clock::now()}
+{
+}
+
+ConnectionPool::Lease::Lease(Lease&& other) noexcept
+    : mPool{std::exchange(other.mPool, nullptr)}
+    , mConnection{std::exchange(other.mConnection, nullptr)}
+    , mStart{other.mStart}
+{
+}
+
+ConnectionPool::Lease::~Lease()
+{
+    if (mPool != nullptr && mConnection != nullptr)
+    {
+        mPool->releaseReader(mConnection, mStart);
+    }
+}
+
+Connection* ConnectionPool::Lease::operator->() const
+{
+    return mConnection;
+}
+
+ConnectionPool::ConnectionPool(const std::string& databasePath,
+                               std::size_t readerCount,
+                               const ConnectionOptions& options)
+    : mDatabasePath{databasePath}
+{
+    // WAL is persistent in the DB file, so it only needs to be set by the writer, which is opened first
+    auto writerOptions        = options;
+    writerOptions.readOnly    = false;
+    writerOptions.journalMode = ConnectionOptions::JournalMode::Wal;
+    mWriter                   = std::make_unique<Connection>(databasePath, writerOptions);
+
+    auto readerOptions          = options;
+    readerOptions.journalMode   = std::nullopt;
+    readerOptions.groupCommit   = std::nullopt;
+    readerOptions.threadingMode = ConnectionOptions::ThreadingMode::MultiThread;
+    for (std::size_t i = 0; i < std::max<std::size_t>(readerCount, 1); ++i)
+    {
+        mReaders.emplace_back(std::make_unique<Connection>(databasePath, readerOptions));
+    }
+
+    mStats.readers = mReaders.size();
+}
+
+const std::string& ConnectionPool::getDatabasePath() const
+{
+    return mDatabasePath;
+}
+
+bool ConnectionPool::open()
+{
+    if (!mWriter->open())
+    {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(mReadersMutex);
+    mIdleReaders.clear();
+
+    for (auto& reader : mReaders)
+    {
+        if (!reader->open())
+        {
+            return false;
+        }
+
+        mIdleReaders.emplace_back(reader.get());
+    }
+
+    mOpenedAt = Clock::now();
+    return true;
+}
+
+bool ConnectionPool::isOpen() const
+{
+    return mWriter->isOpen()
+           && std::all_of(mReaders.cbegin(), mReaders.cend(), [](const auto& reader) { return reader->isOpen(); });
+}
+
+void ConnectionPool::applySql(const std::string& sql)
+{
+    mWriter->applySql(sql);
+}
+
+bool ConnectionPool::tableExists(const std::string& table)
+{
+    return acquireReader()->tableExists(table);
+}
+
+void ConnectionPool::beginTransaction(bool enableForeignKeys)
+{
+    mWriter->beginTransaction(enableForeignKeys);
+    mTransactionOwner = std::this_thread::get_id();
+}
+
+void ConnectionPool::beginTransaction(TransactionMode mode, bool enableForeignKeys)
+{
+    mWriter->beginTransaction(mode, enableForeignKeys);
+    mTransactionOwner = std::this_thread::get_id();
+}
+
+void ConnectionPool::commitTransaction()
+{
+    // cleared once committed, as a failed commit leaves the transaction to its owner, but before the write mutex is
+    // released, as the next owner may set it right after
+    mWriter->commitTransaction([this] { mTransactionOwner = std::thread::id{}; });
+}
+
+void ConnectionPool::rollbackTransaction()
+{
+    mTransactionOwner = std::thread::id{};
+    mWriter->rollbackTransaction();
+}
+
+void ConnectionPool::savepoint(const std::string& name)
+{
+    mWriter->savepoint(name);
+}
+
+void ConnectionPool::releaseSavepoint(const std::string& name)
+{
+    mWriter->releaseSavepoint(name);
+}
+
+void ConnectionPool::rollbackToSavepoint(const std::string& name)
+{
+    mWriter->rollbackToSavepoint(name);
+}
+
+Rows ConnectionPool::select(const std::string& table, const KeyValues& filters)
+{
+    return acquireReader()->select(table, filters);
+}
+
+Rows ConnectionPool::select(const std::string& table, const std::string& col, const KeyValues& filters)
+{
+    return acquireReader()->select(table, col, filters);
+}
+
+void ConnectionPool::select(ResultSet& result, const std::string& table, const KeyValues& filters)
+{
+    acquireReader()->select(result, table, filters);
+}
+
+void ConnectionPool::select(ResultSet& result,
+                            const std::string& table,
+                            const std::string& col,
+                            const KeyValues& filters)
+{
+    acquireReader()->select(result, table, col, filters);
+}
+
+SqlRows ConnectionPool::selectTyped(const std::string& table, const KeyValues& filters)
+{
+    return acquireReader()->selectTyped(table, filters);
+}
+
+SqlRows ConnectionPool::selectTyped(const std::string& table, const std::string& col, const KeyValues& filters)
+{
+    return acquireReader()->selectTyped(table, col, filters);
+}
+
+RowCursor ConnectionPool::selectCursor(const std::string& table, const KeyValues& filters)
+{
+    return selectCursor(table, "*", filters);
+}
+
+RowCursor ConnectionPool::selectCursor(const std::string& table, const std::string& col, const KeyValues& filters)
+{
+    // the reader stays checked out until the cursor is closed
+    auto lease  = std::make_shared<Lease>(acquireReader());
+    auto cursor = (*lease)->selectCursor(table, col, filters);
+    cursor.retain(std::move(lease));
+    return cursor;
+}
+
+PrimaryKey ConnectionPool::insert(const std::string& table, const KeyValues& keyValues, bool transaction)
+{
+    return mWriter->insert(table, keyValues, transaction);
+}
+
+PrimaryKeys ConnectionPool::insert(const std::string& table, const Rows& rows, bool transaction)
+{
+    return mWriter->insert(table, rows, transaction);
+}
+
+PrimaryKey ConnectionPool::insertOrReplace(const std::string& table, const KeyValues& keyValues, bool transaction)
+{
+    return mWriter->insertOrReplace(table, keyValues, transaction);
+}
+
+PrimaryKeys ConnectionPool::insertOrReplace(const std::string& table, const Rows& rows, bool transaction)
+{
+    return mWriter->insertOrReplace(table, rows, transaction);
+}
+
+PrimaryKey ConnectionPool::upsert(const std::string& table,
+                                  const KeyValues& keyValues,
+                                  const std::vector<std::string>& conflictColumns,
+                                  const std::vector<std::string>& updateColumns,
+                                  bool transaction)
+{
+    return mWriter->upsert(table, keyValues, conflictColumns, updateColumns, transaction);
+}
+
+PrimaryKeys ConnectionPool::upsert(const std::string& table,
+                                   const Rows& rows,
+                                   const std::vector<std::string>& conflictColumns,
+                                   const std::vector<std::string>& updateColumns,
+                                   bool transaction)
+{
+    return mWriter->upsert(table, rows, conflictColumns, updateColumns, transaction);
+}
+
+void ConnectionPool::update(const std::string& table,
+                            const KeyValues& keyValues,
+                            const KeyValues& filters,
+                            bool transaction)
+{
+    mWriter->update(table, keyValues, filters, transaction);
+}
+
+void ConnectionPool::deleteRows(const std::string& table, const KeyValues& filters, bool transaction)
+{
+    mWriter->deleteRows(table, filters, transaction);
+}
+
+std::size_t ConnectionPool::count(const std::string& table, const KeyValues& filters)
+{
+    return acquireReader()->count(table, filters);
+}
+
+std::size_t ConnectionPool::count(const std::string& table, const std::string& col, const KeyValues& filters)
+{
+    return acquireReader()->count(table, col, filters);
+}
+
+double ConnectionPool::sum(const std::string& table, const std::string& col, const KeyValues& filters)
+{
+    return acquireReader()->sum(table, col, filters);
+}
+
+double ConnectionPool::average(const std::string& table, const std::string& col, const KeyValues& filters)
+{
+    return acquireReader()->average(table, col, filters);
+}
+
+Rows ConnectionPool::select(const std::string& table, const Filter& filter)
+{
+    return acquireReader()->select(table, filter);
+}
+
+Rows ConnectionPool::select(const std::string& table, const std::string& col, const Filter& filter)
+{
+    return acquireReader()->select(table, col, filter);
+}
+
+Rows ConnectionPool::query(const std::string& table, const QueryOptions& options, const Filter& filter)
+{
+    return acquireReader()->query(table, options, filter);
+}
+
+Page ConnectionPool::queryPage(const std::string& table,
+                               const PageOptions& options,
+                               const Filter& filter,
+                               const std::optional<PageToken>& after)
+{
+    return acquireReader()->queryPage(table, options, filter, after);
+}
+
+void ConnectionPool::update(const std::string& table,
+                            const KeyValues& keyValues,
+                            const Filter& filter,
+                            bool transaction)
+{
+    mWriter->update(table, keyValues, filter, transaction);
+}
+
+void ConnectionPool::deleteRows(const std::string& table, const Filter& filter, bool transaction)
+{
+    mWriter->deleteRows(table, filter, transaction);
+}
+
+std::size_t ConnectionPool::count(const std::string& table, const Filter& filter)
+{
+    return acquireReader()->count(table, filter);
+}
+
+std::size_t ConnectionPool::count(const std::string& table, const std::string& col, const Filter& filter)
+{
+    return acquireReader()->count(table, col, filter);
+}
+
+double ConnectionPool::sum(const std::string& table, const std::string& col, const Filter& filter)
+{
+    return acquireReader()->sum(table, col, filter);
+}
+
+double ConnectionPool::average(const std::string& table, const std::string& col, const Filter& filter)
+{
+    return acquireReader()->average(table, col, filter);
+}
+
+SqlRow ConnectionPool::aggregate(const std::string& table, const Aggregates& aggregates, const KeyValues& filters)
+{
+    return acquireReader()->aggregate(table, aggregates, filters);
+}
+
+SqlRows ConnectionPool::aggregate(const std::string& table,
+                                  const std::vector<std::string>& groupBy,
+                                  const Aggregates& aggregates,
+                                  const KeyValues& filters)
+{
+    return acquireReader()->aggregate(table, groupBy, aggregates, filters);
+}
+
+ConnectionPool::Stats ConnectionPool::stats() const
+{
+    std::lock_guard<std::mutex> lock(mReadersMutex);
+
+    auto stats         = mStats;
+    stats.readersInUse = mReaders.size() - mIdleReaders.size();
+
+    const auto elapsed = Clock::now() - mOpenedAt;
+    if (elapsed.count() > 0)
+    {
+        stats.utilization = std::chrono::duration<double>(mBusyTime).count()
+                            / (std::chrono::duration<double>(elapsed).count() * mReaders.size());
+    }
+
+    return stats;
+}
+
+ConnectionPool::Lease ConnectionPool::acquireReader()
+{
+    if (ownsTransaction())
+    {
+        return Lease{nullptr, mWriter.get()};
+    }
+
+    std::unique_lock<std::mutex> lock(mReadersMutex);
+    ++mStats.acquisitions;
+
+    if (mIdleReaders.empty())
+    {
+        const auto start = Clock::now();
+        mReaderReleased.wait(lock, [this] { return !mIdleReaders.empty(); });
+        const auto waited = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start);
+
+        ++mStats.waits;
+        mStats.waitTime += waited;
+        mStats.maxWaitTime = std::max(mStats.maxWaitTime, waited);
+    }
+
+    auto reader = mIdleReaders.back();
+    mIdleReaders.pop_back();
+    return Lease{this, reader};
+}
+
+void ConnectionPool::releaseReader(Connection* reader, Clock::time_point checkedOutAt)
+{
+    {
+        std::lock_guard<std::mutex> lock(mReadersMutex);
+        mIdleReaders.emplace_back(reader);
+        mBusyTime += Clock::now() - checkedOutAt;
+    }
+
+    mReaderReleased.notify_one();
+}
+
+bool ConnectionPool::ownsTransaction() const
+{
+    return mTransactionOwner.load() == std::this_thread::get_id();
+}
+
+} // namespace sqlite_wrapper
@@ -0,0 +1,28 @@
+#include "CycleClock.hpp"
+
+namespace sqlite_wrapper
+{
+
+double CycleClock::Calibrate()
+{
+#if defined(__x86_64__) || defined(_M_X64)
+    using Clock = std::chrono::steady_clock;
+
+    const auto start      = Clock::now();
+    const auto startTicks = Now();
+
+    // busy-wait rather than sleep, so the measurement window is not stretched by scheduling
+    auto elapsed = Clock::now() - start;
+    while (elapsed < std::chrono::milliseconds{1})
+    {
+        elapsed = Clock::now() - start;
+    }
+
+    const auto ticks = Now() - startTicks;
+    return std::chrono::duration<double, std::nano>(elapsed).count() / static_cast<double>(ticks);
+#else
+    return 1.0;
+#endif
+}
+
+} // namespace sqlite_wrapper
@@ -0,0 +1,168 @@
+#include "DelimitedReader.hpp"
+
+#include <stdexcept>
+
+namespace sqlite_wrapper
+{
+
+DelimitedReader::DelimitedReader(std::istream& input, char delimiter, char quote)
+    : mInput{input}
+    , mDelimiter{delimiter}
+    , mQuote{quote}
+{
+}
+
+bool DelimitedReader::next()
+{
+    mFields.clear();
+
+    // blank lines are skipped
+    do
+    {
+        if (!readLine(false))
+        {
+            return false;
+        }
+    } while (mRecord.empty());
+
+    mLineNumber = mLinesRead;
+
+    // unquoted text is compacted towards the start of the record, behind the read position
+    std::size_t read  = 0;
+    std::size_t write = 0;
+
+    while (true)
+    {
+        Field field{write, 0, false};
+
+        if (read < mRecord.size() && mRecord[read] == mQuote)
+        {
+            field.quoted = true;
+            ++read;
+
+            while (true)
+            {
+                if (read == mRecord.size())
+                {
+                    // the line break belongs to the field
+                    if (!readLine(true))
+                    {
+                        throw std::runtime_error("Unterminated quoted field, starting at line "
+                                                 + std::to_string(mLineNumber));
+                    }
+
+                    continue;
+                }
+
+                const auto c = mRecord[read++];
+                if (c == mQuote)
+                {
+                    if (read < mRecord.size() && mRecord[read] == mQuote)
+                    {
+                        mRecord[write++] = mQuote;
+                        ++read;
+                        continue;
+                    }
+
+                    break;
+                }
+
+                mRecord[write++] = c;
+            }
+        }
+
+        // unquoted field, or the remainder of a quoted one up to the delimiter
+        while (read < mRecord.size() && mRecord[read] != mDelimiter)
+        {
+            mRecord[write++] = mRecord[read++];
+        }
+
+        field.length = write - field.offset;
+        mFields.emplace_back(field);
+
+        if (read == mRecord.size())
+        {
+            break;
+        }
+
+        ++read; // delimiter
+    }
+
+    return true;
+}
+
+std::size_t DelimitedReader::size() const
+{
+    return mFields.size();
+}
+
+std::string_view DelimitedReader::field(std::size_t index) const
+{
+    const auto& field = mFields[index];
+    return std::string_view{mRecord}.substr(field.offset, field.length);
+}
+
+bool DelimitedReader::isEmpty(std::size_t index) const
+{
+    return mFields[index].length == 0 && !mFields[index].quoted;
+}
+
+std::size_t DelimitedReader::lineNumber() const
+{
+    return mLineNumber;
+}
+
+bool DelimitedReader::readLine(bool append)
+{
+    if (!append)
+    {
+        mRecord.clear();
+    }
+    else
+    {
+        mRecord.push_back('\n');
+    }
+
+    const auto start = mRecord.size();
+
+    // read straight into the record buffer, so that continuation lines of quoted fields are appended in place
+    auto* buffer = mInput.rdbuf();
+    if (buffer == nullptr || !mInput.good())
+    {
+        return false;
+    }
+
+    bool any = false;
+    while (true)
+    {
+        const auto c = buffer->sbumpc();
+        if (c == std::char_traits<char>::eof())
+        {
+            mInput.setstate(std::ios::eofbit);
+            break;
+        }
+
+        any = true;
+        if (c == '\n')
+        {
+            break;
+        }
+
+        mRecord.push_back(static_cast<char>(c));
+    }
+
+    if (!any)
+    {
+        return false;
+    }
+
+    if (mRecord.size() > start && mRecord.back() == '\r')
+    {
+        mRecord.pop_back();
+    }
+
+    ++mLinesRead;
+    return true;
+}
+
+} // namespace sqlite_wrapper
@@ -0,0 +1,127 @@
+#include "Filter.hpp"
+
+#include <algorithm>
+#include <iterator>
+#include <utility>
+
+namespace sqlite_wrapper
+{
+
+Filter::Filter(Operator op, std::string key, SqlRow values)
+    : mOperator{op}
+    , mKey{std::move(key)}
+    , mValues{std::move(values)}
+{
+}
+
+Filter::Filter(Operator op, std::vector<Filter> operands)
+    : mOperator{op}
+    , mOperands{std::move(operands)}
+{
+}
+
+Filter Filter::All()
+{
+    return {Operator::And, std::vector<Filter>{}};
+}
+
+Filter Filter::Equal(const KeyValues& keyValues)
+{
+    std::vector<Filter> operands;
+    operands.reserve(keyValues.size());
+    for (const auto& kv : keyValues)
+    {
+        operands.push_back({Operator::Equal, kv.key(), {kv.sqlValue()}});
+    }
+
+    return {Operator::And, std::move(operands)};
+}
+
+Filter Filter::Like(const std::string& key, const std::string& pattern)
+{
+    return {Operator::Like, key, {pattern}};
+}
+
+Filter Filter::IsNull(const std::string& key)
+{
+    return {Operator::Equal, key, {nullptr}};
+}
+
+Filter Filter::IsNotNull(const std::string& key)
+{
+    return {Operator::NotEqual, key, {nullptr}};
+}
+
+Filter::Operator Filter::op() const
+{
+    return mOperator;
+}
+
+const std::string& Filter::key() const
+{
+    return mKey;
+}
+
+const SqlRow& Filter::values() const
+{
+    return mValues;
+}
+
+const std::vector<Filter>& Filter::operands() const
+{
+    return mOperands;
+}
+
+bool Filter::empty() const
+{
+    return mOperator == Operator::And && mOperands.empty();
+}
+
+Filter operator&&(Filter lhs, Filter rhs)
+{
+    return Filter::Combine(Filter::Operator::And, std::move(lhs), std::move(rhs));
+}
+
+Filter operator||(Filter lhs, Filter rhs)
+{
+    return Filter::Combine(Filter::Operator::Or, std::move(lhs), std::move(rhs));
+}
+
+Filter operator!(Filter operand)
+{
+    std::vector<Filter> operands;
+    operands.emplace_back(std::move(operand));
+    return {Filter::Operator::Not, std::move(operands)};
+}
+
+Filter Filter::Combine(Operator op, Filter lhs, Filter rhs)
+{
+    // an AND matching all rows is neutral to AND, and absorbs OR
+    if (lhs.empty() || rhs.empty())
+    {
+        if (op == Operator::And)
+        {
+            return lhs.empty() ? std::move(rhs) : std::move(lhs);
+        }
+
+        return All();
+    }
+
+    // flatten chains of the same operator, e.g. a && b && c, into a single list of operands
+    std::vector<Filter> operands;
+    for (auto* filter : {&lhs, &rhs})
+    {
+        if (filter->mOperator == op)
+        {
+            std::move(filter->mOperands.begin(), filter->mOperands.end(), std::back_inserter(operands));
+        }
+        else
+        {
+            operands.emplace_back(std::move(*filter));
+        }
+    }
+
+    return {op, std::move(operands)};
+}
+
+} // namespace sqlite_wrapper
@@ -0,0 +1,104 @@
+#include "GroupCommit.hpp"
+
+#include <algorithm>
+#include <utility>
+
+namespace sqlite_wrapper
+{
+
+GroupCommit::GroupCommit(const GroupCommitOptions& options, Executor executor)
+    : mOptions{options}
+    , mExecutor{std::move(executor)}
+{
+}
+
+PrimaryKey GroupCommit::submit(Operation operation)
+{
+    Request request;
+    request.operation = std::move(operation);
+
+    std::unique_lock<std::mutex> lock(mMutex);
+    mOpenBatch.emplace_back(&request);
+
+    if (mOpenBatch.size() == 1)
+    {
+        lead(lock);
+    }
+    else
+    {
+        if (mOpenBatch.size() >= mOptions.maxBatchSize)
+        {
+            mBatchGrown.notify_one();
+        }
+
+        mBatchDone.wait(lock, [&request] { return request.done; });
+    }
+
+    lock.unlock();
+
+    if (request.error)
+    {
+        std::rethrow_exception(request.error);
+    }
+
+    return request.result.value_or(0);
+}
+
+GroupCommit::Stats GroupCommit::stats() const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    auto stats = mStats;
+    if (stats.batches > 0)
+    {
+        stats.averageBatchSize = static_cast<double>(stats.writes) / static_cast<double>(stats.batches);
+    }
+
+    return stats;
+}
+
+void GroupCommit::lead(std::unique_lock<std::mutex>& lock)
+{
+    const auto deadline = Clock::now() + mOptions.maxDelay;
+    mBatchGrown.wait_until(lock, deadline, [this] { return mOpenBatch.size() >= mOptions.maxBatchSize; });
+
+    // close the batch: later writes start a new one, with a new leader
+    Batch batch;
+    batch.swap(mOpenBatch);
+    lock.unlock();
+
+    const auto start = Clock::now();
+    try
+    {
+        mExecutor(batch);
+    }
+    catch (...)
+    {
+        for (auto request : batch)
+        {
+            if (!request->error)
+            {
+                request->result.reset();
+                request->error = std::current_exception();
+            }
+        }
+    }
+    const auto latency = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start);
+
+    lock.lock();
+
+    ++mStats.batches;
+    mStats.writes += batch.size();
+    mStats.maxBatchSize = std::max(mStats.maxBatchSize, batch.size());
+    mStats.commitLatency += latency;
+    mStats.maxCommitLatency = std::max(mStats.maxCommitLatency, latency);
+
+    for (auto request : batch)
+    {
+        request->done = true;
+    }
+
+    mBatchDone.notify_all();
+}
+
+} // namespace sqlite_wrapper
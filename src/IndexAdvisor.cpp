@@ -0,0 +1,185 @@
+#include "IndexAdvisor.hpp"
+
+#include "StringUtils.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <map>
+#include <utility>
+
+namespace sqlite_wrapper
+{
+
+namespace
+{
+
+void AddColumn(std::vector<std::string>& columns, const std::string& col)
+{
+    if (std::find(columns.cbegin(), columns.cend(), col) == columns.cend())
+    {
+        columns.emplace_back(col);
+    }
+}
+
+bool IsColumnName(const std::string& col)
+{
+    return !col.empty() && std::all_of(col.cbegin(), col.cend(), [](unsigned char ch) {
+        return std::isalnum(ch) || ch == '_';
+    });
+}
+
+} // namespace
+
+IndexAdvisor::IndexAdvisor(const IndexAdvisorOptions& options)
+    : mOptions{options}
+{
+}
+
+bool IndexAdvisor::record(const std::string& sql)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    auto it = mShapes.find(sql);
+    if (it == mShapes.end())
+    {
+        return false;
+    }
+
+    ++it->second.calls;
+    return true;
+}
+
+void IndexAdvisor::learn(const std::string& sql, const std::string& table, Columns columns, bool fullScan)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    // another thread may have learned the shape meanwhile
+    auto [it, inserted] = mShapes.try_emplace(sql);
+    if (inserted)
+    {
+        it->second.table    = table;
+        it->second.columns  = std::move(columns);
+        it->second.fullScan = fullScan;
+    }
+
+    ++it->second.calls;
+}
+
+std::vector<IndexAdvisor::Advice> IndexAdvisor::advice() const
+{
+    std::map<std::pair<std::string, std::vector<std::string>>, std::uint64_t> fullScans;
+
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+
+        for (const auto& [sql, shape] : mShapes)
+        {
+            auto columns = IndexColumns(shape.columns);
+            if (shape.fullScan && shape.calls >= mOptions.minFullScans && !columns.empty())
+            {
+                fullScans[{shape.table, std::move(columns)}] += shape.calls;
+            }
+        }
+    }
+
+    std::vector<Advice> advice;
+    for (auto& [index, calls] : fullScans)
+    {
+        advice.push_back({index.first, index.second, calls, SqlCreateIndex(index.first, index.second)});
+    }
+
+    std::stable_sort(advice.begin(), advice.end(), [](const Advice& lhs, const Advice& rhs) {
+        return lhs.fullScans > rhs.fullScans;
+    });
+    return advice;
+}
+
+void IndexAdvisor::clear()
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    mShapes.clear();
+}
+
+IndexAdvisor::Columns IndexAdvisor::FilterColumns(const Filter& filter, const std::string& col)
+{
+    using Operator = Filter::Operator;
+
+    Columns columns;
+
+    const auto addCondition = [&columns](const Filter& condition) {
+        switch (condition.op())
+        {
+        case Operator::Equal:
+        case Operator::In:
+            AddColumn(columns.equality, condition.key());
+            break;
+        case Operator::Less:
+        case Operator::LessEqual:
+        case Operator::Greater:
+        case Operator::GreaterEqual:
+        case Operator::Between:
+        case Operator::Like:
+            AddColumn(columns.range, condition.key());
+            break;
+        default:
+            break; // not usable by a single index
+        }
+    };
+
+    if (filter.op() == Operator::And)
+    {
+        std::for_each(filter.operands().cbegin(), filter.operands().cend(), addCondition);
+    }
+    else
+    {
+        addCondition(filter);
+    }
+
+    if (IsColumnName(col))
+    {
+        columns.output.emplace_back(col);
+    }
+
+    return columns;
+}
+
+std::vector<std::string> IndexAdvisor::IndexColumns(const Columns& columns)
+{
+    // equality columns first, as an index can only serve one range, on the column after them
+    std::vector<std::string> index = columns.equality;
+
+    for (const auto& col : columns.range)
+    {
+        if (std::find(index.cbegin(), index.cend(), col) == index.cend())
+        {
+            index.emplace_back(col);
+            break;
+        }
+    }
+
+    if (index.empty())
+    {
+        return index; // nothing filtered on: no index avoids the scan
+    }
+
+    for (const auto& col : columns.output)
+    {
+        AddColumn(index, col);
+    }
+
+    return index;
+}
+
+std::string IndexAdvisor::SqlCreateIndex(const std::string& table, const std::vector<std::string>& columns)
+{
+    // SQL statement:
+    //     CREATE INDEX IF NOT EXISTS idx_<table>_<columns> ON <table>(<columns>);
+
+    auto name = "idx_" + table + StringUtils::underscore + StringUtils::Join(columns, StringUtils::underscore);
+    std::replace_if(
+        name.begin(), name.end(), [](unsigned char ch) { return !std::isalnum(ch) && ch != '_'; }, '_');
+
+    return "CREATE INDEX IF NOT EXISTS " + name + " ON " + table + "(" + StringUtils::Join(columns) + ");";
+}
+
+} // namespace sqlite_wrapper
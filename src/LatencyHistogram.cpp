@@ -0,0 +1,141 @@
+#include "LatencyHistogram.hpp"
+
+#include <algorithm>
+
+namespace sqlite_wrapper
+{
+
+namespace
+{
+
+std::size_t HighestBit(std::uint64_t value)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return 63 - static_cast<std::size_t>(__builtin_clzll(value));
+#else
+    std::size_t bit = 0;
+    while (value >>= 1)
+    {
+        ++bit;
+    }
+    return bit;
+#endif
+}
+
+} // namespace
+
+std::chrono::nanoseconds LatencyHistogram::Snapshot::mean() const
+{
+    return count > 0 ? total / static_cast<std::int64_t>(count) : std::chrono::nanoseconds{};
+}
+
+void LatencyHistogram::Snapshot::add(const Snapshot& other)
+{
+    count += other.count;
+    total += other.total;
+    max = std::max(max, other.max);
+
+    buckets.resize(std::max(buckets.size(), other.buckets.size()));
+    for (std::size_t i = 0; i < other.buckets.size(); ++i)
+    {
+        buckets[i] += other.buckets[i];
+    }
+}
+
+std::chrono::nanoseconds LatencyHistogram::Snapshot::percentile(double percentile) const
+{
+    if (count == 0)
+    {
+        return {};
+    }
+
+    const auto rank = std::max<std::uint64_t>(static_cast<std::uint64_t>(percentile / 100.0 * count + 0.5), 1);
+
+    std::uint64_t seen = 0;
+    for (std::size_t i = 0; i < buckets.size(); ++i)
+    {
+        seen += buckets[i];
+        if (seen >= rank)
+        {
+            const auto upperBound = i + 1 < kBucketCount ? BucketLowerBound(i + 1) - 1 : max.count();
+            return std::min(std::chrono::nanoseconds{upperBound}, max);
+        }
+    }
+
+    return max;
+}
+
+void LatencyHistogram::record(std::chrono::nanoseconds duration)
+{
+    const auto value = static_cast<std::uint64_t>(std::max<std::int64_t>(duration.count(), 0));
+
+    mBuckets[BucketIndex(value)].fetch_add(1, std::memory_order_relaxed);
+    mTotal.fetch_add(value, std::memory_order_relaxed);
+
+    auto max = mMax.load(std::memory_order_relaxed);
+    while (value > max && !mMax.compare_exchange_weak(max, value, std::memory_order_relaxed))
+    {
+    }
+}
+
+void LatencyHistogram::recordExclusive(std::chrono::nanoseconds duration)
+{
+    const auto value = static_cast<std::uint64_t>(std::max<std::int64_t>(duration.count(), 0));
+
+    // no other thread writes, so plain loads and stores suffice, with no compare-and-swap loop for the max
+    auto& bucket = mBuckets[BucketIndex(value)];
+    bucket.store(bucket.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    mTotal.store(mTotal.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+
+    if (value > mMax.load(std::memory_order_relaxed))
+    {
+        mMax.store(value, std::memory_order_relaxed);
+    }
+}
+
+LatencyHistogram::Snapshot LatencyHistogram::snapshot() const
+{
+    Snapshot snapshot;
+    snapshot.total = std::chrono::nanoseconds{mTotal.load(std::memory_order_relaxed)};
+    snapshot.max   = std::chrono::nanoseconds{mMax.load(std::memory_order_relaxed)};
+
+    snapshot.buckets.reserve(kBucketCount);
+    for (const auto& bucket : mBuckets)
+    {
+        snapshot.count += snapshot.buckets.emplace_back(bucket.load(std::memory_order_relaxed));
+    }
+
+    return snapshot;
+}
+
+std::uint64_t LatencyHistogram::BucketLowerBound(std::size_t index)
+{
+    if (index < kSubBuckets)
+    {
+        return index;
+    }
+
+    // each run of kSubBuckets buckets splits a power of two, 2^exponent to 2^(exponent + 1)
+    const auto exponent  = index / kSubBuckets + kSubBucketBits - 1;
+    const auto subBucket = index % kSubBuckets;
+    return (kSubBuckets + subBucket) << (exponent - kSubBucketBits);
+}
+
+std::size_t LatencyHistogram::BucketIndex(std::uint64_t nanoseconds)
+{
+    if (nanoseconds < kSubBuckets)
+    {
+        return static_cast<std::size_t>(nanoseconds);
+    }
+
+    const auto exponent = std::min(HighestBit(nanoseconds), kMaxExponent);
+    if (exponent == kMaxExponent)
+    {
+        return kBucketCount - 1;
+    }
+
+    const auto subBucket = (nanoseconds >> (exponent - kSubBucketBits)) & (kSubBuckets - 1);
+    return (exponent - kSubBucketBits + 1) * kSubBuckets + static_cast<std::size_t>(subBucket);
+}
+
+} // namespace sqlite_wrapper
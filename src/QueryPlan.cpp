@@ -0,0 +1,92 @@
+#include "QueryPlan.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <map>
+#include <sstream>
+
+namespace sqlite_wrapper
+{
+
+QueryPlan::Step QueryPlan::ParseStep(const std::string& detail)
+{
+    // e.g.  SCAN t
+    //       SCAN t USING COVERING INDEX idx
+    //       SEARCH t USING INDEX idx (a=? AND b>?)
+    //       SEARCH t USING INTEGER PRIMARY KEY (rowid=?)
+    //       SEARCH t USING AUTOMATIC COVERING INDEX (a=?)
+    //       SCAN TABLE t ...                                  (before SQLite 3.36)
+
+    Step step;
+    step.detail = detail;
+
+    std::istringstream stream{detail};
+    std::vector<std::string> words{std::istream_iterator<std::string>{stream}, std::istream_iterator<std::string>{}};
+
+    if (words.size() < 2 || (words[0] != "SCAN" && words[0] != "SEARCH") || words[1] == "CONSTANT")
+    {
+        return step;
+    }
+
+    std::size_t i = words[1] == "TABLE" ? 2 : 1;
+    if (i >= words.size())
+    {
+        return step;
+    }
+
+    step.access = words[0] == "SCAN" ? Step::Access::Scan : Step::Access::Search;
+    step.table  = words[i];
+
+    const auto usingClause = std::find(words.cbegin() + static_cast<std::ptrdiff_t>(i), words.cend(), "USING");
+    for (auto it = usingClause; it != words.cend(); ++it)
+    {
+        if (*it == "INTEGER" && std::next(it) != words.cend() && *std::next(it) == "PRIMARY")
+        {
+            step.index = "INTEGER PRIMARY KEY";
+            break;
+        }
+
+        step.automaticIndex = step.automaticIndex || *it == "AUTOMATIC";
+        step.coveringIndex  = step.coveringIndex || *it == "COVERING";
+
+        if (*it == "INDEX")
+        {
+            // automatic indexes have no name, only the constraints they serve
+            auto name = std::next(it);
+            if (name != words.cend() && name->front() != '(')
+            {
+                step.index = *name;
+            }
+            break;
+        }
+    }
+
+    return step;
+}
+
+bool QueryPlan::fullScan() const
+{
+    return std::any_of(steps.cbegin(), steps.cend(), [](const Step& step) {
+        return step.access == Step::Access::Scan || step.automaticIndex;
+    });
+}
+
+std::string QueryPlan::toString() const
+{
+    std::map<int, int> depths; // step id -> nesting depth
+    std::ostringstream out;
+
+    for (const auto& step : steps)
+    {
+        const auto parent = depths.find(step.parent);
+        const auto depth  = parent == depths.end() ? 0 : parent->second + 1;
+        depths[step.id]   = depth;
+
+        out << std::string(static_cast<std::size_t>(depth) * 2, ' ') << step.detail << "\n";
+    }
+
+    return out.str();
+}
+
+} // namespace sqlite_wrapper
@@ -0,0 +1,143 @@
+#include "QueryProfiler.hpp"
+
+#include <ctime>
+#include <iomanip>
+
+namespace sqlite_wrapper
+{
+
+QueryProfiler::QueryProfiler(const ProfilerOptions& options)
+    : mOptions{options}
+{
+    mLog.reserve(mOptions.slowQueryLogSize);
+}
+
+void QueryProfiler::attach(sqlite3* db)
+{
+    sqlite3_trace_v2(db, SQLITE_TRACE_PROFILE, &QueryProfiler::TraceCallback, this);
+}
+
+std::vector<QueryProfiler::Entry> QueryProfiler::slowQueries() const
+{
+    std::lock_guard<std::mutex> lock(mLogMutex);
+
+    // once the buffer is full, mNext points at the oldest entry
+    std::vector<Entry> entries;
+    entries.reserve(mLog.size());
+    entries.insert(entries.end(), mLog.cbegin() + static_cast<std::ptrdiff_t>(mNext), mLog.cend());
+    entries.insert(entries.end(), mLog.cbegin(), mLog.cbegin() + static_cast<std::ptrdiff_t>(mNext));
+    return entries;
+}
+
+void QueryProfiler::dump(std::ostream& out) const
+{
+    for (const auto& entry : slowQueries())
+    {
+        const auto time = std::chrono::system_clock::to_time_t(entry.time);
+        std::tm local{};
+        localtime_r(&time, &local);
+
+        out << std::put_time(&local, "%F %T") << " "
+            << std::chrono::duration_cast<std::chrono::microseconds>(entry.duration).count() << " us"
+            << " fullscan=" << entry.fullScanSteps << " sort=" << entry.sorts << " autoindex=" << entry.autoIndexes
+            << " vmstep=" << entry.vmSteps << " " << entry.sql << "\n";
+    }
+}
+
+void QueryProfiler::clear()
+{
+    std::lock_guard<std::mutex> lock(mLogMutex);
+    mLog.clear();
+    mNext = 0;
+}
+
+QueryProfiler::Stats QueryProfiler::stats() const
+{
+    Stats stats;
+    stats.statements    = mStatements.load(std::memory_order_relaxed);
+    stats.totalTime     = std::chrono::nanoseconds{mTotalTime.load(std::memory_order_relaxed)};
+    stats.fullScanSteps = mFullScanSteps.load(std::memory_order_relaxed);
+    stats.sorts         = mSorts.load(std::memory_order_relaxed);
+    stats.autoIndexes   = mAutoIndexes.load(std::memory_order_relaxed);
+    stats.vmSteps       = mVmSteps.load(std::memory_order_relaxed);
+
+    std::lock_guard<std::mutex> lock(mLogMutex);
+    stats.slowStatements = mSlowStatements;
+    return stats;
+}
+
+int QueryProfiler::TraceCallback(unsigned type, void* context, void* statement, void* nanoseconds)
+{
+    if (type == SQLITE_TRACE_PROFILE)
+    {
+        const auto duration = std::chrono::nanoseconds{*static_cast<sqlite3_int64*>(nanoseconds)};
+        static_cast<QueryProfiler*>(context)->profile(static_cast<sqlite3_stmt*>(statement), duration);
+    }
+
+    return 0;
+}
+
+void QueryProfiler::profile(sqlite3_stmt* statement, std::chrono::nanoseconds duration)
+{
+    // counters accumulate over the executions of a statement, so they are reset for the next one
+    const auto takeCounter = [statement](int counter) {
+        return static_cast<std::uint64_t>(sqlite3_stmt_status(statement, counter, 1));
+    };
+
+    Entry entry;
+    entry.duration      = duration;
+    entry.fullScanSteps = takeCounter(SQLITE_STMTSTATUS_FULLSCAN_STEP);
+    entry.sorts         = takeCounter(SQLITE_STMTSTATUS_SORT);
+    entry.autoIndexes   = takeCounter(SQLITE_STMTSTATUS_AUTOINDEX);
+    entry.vmSteps       = takeCounter(SQLITE_STMTSTATUS_VM_STEP);
+
+    mStatements.fetch_add(1, std::memory_order_relaxed);
+    mTotalTime.fetch_add(static_cast<std::uint64_t>(duration.count()), std::memory_order_relaxed);
+    mFullScanSteps.fetch_add(entry.fullScanSteps, std::memory_order_relaxed);
+    mSorts.fetch_add(entry.sorts, std::memory_order_relaxed);
+    mAutoIndexes.fetch_add(entry.autoIndexes, std::memory_order_relaxed);
+    mVmSteps.fetch_add(entry.vmSteps, std::memory_order_relaxed);
+
+    if (duration < mOptions.slowQueryThreshold)
+    {
+        return;
+    }
+
+    entry.time = std::chrono::system_clock::now();
+
+    if (mOptions.expandSql)
+    {
+        // NULL if out of memory, or if the expanded text would exceed SQLITE_LIMIT_LENGTH
+        if (auto* expanded = sqlite3_expanded_sql(statement))
+        {
+            entry.sql = expanded;
+            sqlite3_free(expanded);
+        }
+    }
+
+    if (entry.sql.empty())
+    {
+        entry.sql = sqlite3_sql(statement);
+    }
+
+    std::lock_guard<std::mutex> lock(mLogMutex);
+    ++mSlowStatements;
+
+    if (mOptions.slowQueryLogSize == 0)
+    {
+        return;
+    }
+
+    if (mLog.size() < mOptions.slowQueryLogSize)
+    {
+        mLog.emplace_back(std::move(entry));
+    }
+    else
+    {
+        mLog[mNext] = std::move(entry);
+    }
+
+    mNext = (mNext + 1) % mOptions.slowQueryLogSize;
+}
+
+} // namespace sqlite_wrapper
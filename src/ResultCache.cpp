@@ -0,0 +1,242 @@
+#include "ResultCache.hpp"
+
+#include <cstring>
+#include <iterator>
+#include <type_traits>
+
+namespace sqlite_wrapper
+{
+
+ResultCache::ResultCache(const ResultCacheOptions& options)
+    : mOptions{options}
+{
+    mStats.maxBytes = mOptions.maxBytes;
+}
+
+std::string ResultCache::Key(const ParameterizedSql& sql)
+{
+    std::string key = sql.sql;
+
+    // each value is tagged with its type, and texts and blobs with their size, so distinct params never collide
+    for (const auto& param : sql.params)
+    {
+        key += static_cast<char>(param.index());
+        std::visit(
+            [&key](const auto& value)
+            {
+                using T = std::decay_t<decltype(value)>;
+                if constexpr (std::is_same_v<T, std::int64_t> || std::is_same_v<T, double>)
+                {
+                    char bytes[sizeof(T)];
+                    std::memcpy(bytes, &value, sizeof(T));
+                    key.append(bytes, sizeof(T));
+                }
+                else if constexpr (std::is_same_v<T, std::string> || std::is_same_v<T, Blob>)
+                {
+                    key += std::to_string(value.size()) + ":";
+                    key.append(value.cbegin(), value.cend());
+                }
+            },
+            param);
+    }
+
+    return key;
+}
+
+std::string ResultCache::TableKey(std::string_view table)
+{
+    const auto isQuote = [](char c) { return c == '"' || c == '`' || c == '\'' || c == '['; };
+    const auto closing = [](char c) { return c == '[' ? ']' : c; };
+
+    // the name follows the last dot outside of quotes; a doubled quote closes and reopens them
+    std::size_t start = 0;
+    char quote        = 0;
+    for (std::size_t i = 0; i < table.size(); ++i)
+    {
+        if (quote != 0)
+        {
+            quote = table[i] == quote ? 0 : quote;
+        }
+        else if (isQuote(table[i]))
+        {
+            quote = closing(table[i]);
+        }
+        else if (table[i] == '.')
+        {
+            start = i + 1;
+        }
+    }
+
+    auto name   = table.substr(start);
+    char closer = 0;
+    if (name.size() >= 2 && isQuote(name.front()) && name.back() == closing(name.front()))
+    {
+        closer = name.back();
+        name   = name.substr(1, name.size() - 2);
+    }
+
+    // SQLite folds the case of ASCII letters only
+    std::string key;
+    key.reserve(name.size());
+    for (std::size_t i = 0; i < name.size(); ++i)
+    {
+        const auto c = name[i];
+        key += c >= 'A' && c <= 'Z' ? static_cast<char>(c - 'A' + 'a') : c;
+
+        if (c == closer && closer != ']' && i + 1 < name.size() && name[i + 1] == closer)
+        {
+            ++i;
+        }
+    }
+
+    return key;
+}
+
+ResultCache::Version ResultCache::version(const std::string& table) const
+{
+    const auto tableKey = TableKey(table);
+
+    std::lock_guard<std::mutex> lock(mMutex);
+    return currentVersion(tableKey);
+}
+
+std::optional<ResultCache::Result> ResultCache::get(const std::string& key, const std::string& table)
+{
+    const auto tableKey = TableKey(table);
+
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    auto it = mIndex.find(key);
+    if (it == mIndex.end())
+    {
+        ++mStats.misses;
+        return std::nullopt;
+    }
+
+    auto entry = it->second;
+    if (!(entry->version == currentVersion(tableKey)))
+    {
+        ++mStats.invalidations;
+        ++mStats.misses;
+        erase(entry);
+        return std::nullopt;
+    }
+
+    ++mStats.hits;
+    mEntries.splice(mEntries.begin(), mEntries, entry);
+    return entry->result;
+}
+
+void ResultCache::put(std::string key, const std::string& table, const Version& version, Result result)
+{
+    Entry entry{std::move(key), TableKey(table), version, std::move(result), 0};
+    entry.bytes = EstimateBytes(entry);
+
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    // written meanwhile, or too large to ever fit
+    if (!(version == currentVersion(entry.table)) || entry.bytes > mOptions.maxBytes)
+    {
+        return;
+    }
+
+    auto it = mIndex.find(entry.key);
+    if (it != mIndex.end())
+    {
+        erase(it->second);
+    }
+
+    mStats.bytes += entry.bytes;
+    mEntries.emplace_front(std::move(entry));
+    mIndex.emplace(mEntries.front().key, mEntries.begin());
+    mStats.entries = mEntries.size();
+
+    evict();
+}
+
+void ResultCache::invalidate(const char* table)
+{
+    auto tableKey = TableKey(table);
+
+    std::lock_guard<std::mutex> lock(mMutex);
+    ++mTableVersions[std::move(tableKey)];
+}
+
+void ResultCache::invalidateAll()
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    ++mEpoch;
+}
+
+void ResultCache::checkDataVersion(std::int64_t dataVersion)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    if (mDataVersion && *mDataVersion != dataVersion)
+    {
+        ++mEpoch;
+    }
+
+    mDataVersion = dataVersion;
+}
+
+void ResultCache::clear()
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    mEntries.clear();
+    mIndex.clear();
+    ++mEpoch;
+    mStats          = Stats{};
+    mStats.maxBytes = mOptions.maxBytes;
+}
+
+ResultCache::Stats ResultCache::stats() const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mStats;
+}
+
+std::size_t ResultCache::EstimateBytes(const Entry& entry)
+{
+    std::size_t bytes = sizeof(Entry) + entry.key.size() + entry.table.size();
+
+    if (const auto* rows = std::get_if<Rows>(&entry.result))
+    {
+        for (const auto& row : *rows)
+        {
+            bytes += sizeof(Row) + row.size() * sizeof(Value);
+            for (const auto& value : row)
+            {
+                bytes += value ? value->size() : 0;
+            }
+        }
+    }
+
+    return bytes;
+}
+
+ResultCache::Version ResultCache::currentVersion(const std::string& tableKey) const
+{
+    auto it = mTableVersions.find(tableKey);
+    return Version{mEpoch, it != mTableVersions.end() ? it->second : 0};
+}
+
+void ResultCache::erase(Entries::iterator entry)
+{
+    mStats.bytes -= entry->bytes;
+    mIndex.erase(entry->key);
+    mEntries.erase(entry);
+    mStats.entries = mEntries.size();
+}
+
+void ResultCache::evict()
+{
+    while (mStats.bytes > mOptions.maxBytes && !mEntries.empty())
+    {
+        erase(std::prev(mEntries.end()));
+        ++mStats.evictions;
+    }
+}
+
+} // namespace sqlite_wrapper
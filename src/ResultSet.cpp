@@ -0,0 +1,225 @@
+#include "ResultSet.hpp"
+
+#include <cassert>
+
+namespace sqlite_wrapper
+{
+
+namespace
+{
+
+constexpr std::size_t kBitsPerWord = 64;
+
+} // namespace
+
+RowView::RowView(const ResultSet& resultSet, std::size_t row)
+    : mResultSet{&resultSet}
+    , mRow{row}
+{
+}
+
+std::size_t RowView::size() const
+{
+    return mResultSet->columns();
+}
+
+bool RowView::isNull(std::size_t col) const
+{
+    return mResultSet->isNull(mRow * mResultSet->columns() + col);
+}
+
+std::optional<std::string_view> RowView::operator[](std::size_t col) const
+{
+    if (isNull(col))
+    {
+        return std::nullopt;
+    }
+
+    return text(col);
+}
+
+std::string_view RowView::text(std::size_t col) const
+{
+    return mResultSet->cell(mRow * mResultSet->columns() + col);
+}
+
+Row RowView::toRow() const
+{
+    Row row;
+    row.reserve(size());
+
+    for (std::size_t col = 0; col < size(); ++col)
+    {
+        auto value = (*this)[col];
+        row.emplace_back(value ? Value{std::string{*value}} : std::nullopt);
+    }
+
+    return row;
+}
+
+ResultSet::Iterator::Iterator(const ResultSet& resultSet, std::size_t row)
+    : mResultSet{&resultSet}
+    , mRow{row}
+{
+}
+
+RowView ResultSet::Iterator::operator*() const
+{
+    return RowView{*mResultSet, mRow};
+}
+
+ResultSet::Iterator& ResultSet::Iterator::operator++()
+{
+    ++mRow;
+    return *this;
+}
+
+ResultSet::Iterator ResultSet::Iterator::operator++(int)
+{
+    auto previous = *this;
+    ++mRow;
+    return previous;
+}
+
+ResultSet::Iterator ResultSet::Iterator::operator+(difference_type n) const
+{
+    return Iterator{*mResultSet, static_cast<std::size_t>(static_cast<difference_type>(mRow) + n)};
+}
+
+ResultSet::Iterator::difference_type ResultSet::Iterator::operator-(const Iterator& other) const
+{
+    return static_cast<difference_type>(mRow) - static_cast<difference_type>(other.mRow);
+}
+
+bool ResultSet::Iterator::operator==(const Iterator& other) const
+{
+    return mResultSet == other.mResultSet && mRow == other.mRow;
+}
+
+bool ResultSet::Iterator::operator!=(const Iterator& other) const
+{
+    return !(*this == other);
+}
+
+ResultSet::ResultSet(std::size_t columns)
+    : mColumns{columns}
+{
+}
+
+void ResultSet::reset(std::size_t columns)
+{
+    mColumns = columns;
+    mArena.clear();
+    mOffsets.resize(1);
+    mNulls.clear();
+}
+
+void ResultSet::reserve(std::size_t rows, std::size_t bytes)
+{
+    const auto cells = rows * mColumns;
+
+    mArena.reserve(bytes);
+    mOffsets.reserve(cells + 1);
+    mNulls.reserve((cells + kBitsPerWord - 1) / kBitsPerWord);
+}
+
+void ResultSet::append(const CursorRow& row)
+{
+    assert(static_cast<std::size_t>(row.size()) == mColumns);
+
+    for (std::size_t col = 0; col < mColumns; ++col)
+    {
+        appendCell(row[static_cast<int>(col)]);
+    }
+}
+
+void ResultSet::append(const Row& row)
+{
+    assert(row.size() == mColumns);
+
+    for (const auto& value : row)
+    {
+        appendCell(value ? std::optional<std::string_view>{*value} : std::nullopt);
+    }
+}
+
+std::size_t ResultSet::size() const
+{
+    return mColumns == 0 ? 0 : (mOffsets.size() - 1) / mColumns;
+}
+
+std::size_t ResultSet::columns() const
+{
+    return mColumns;
+}
+
+bool ResultSet::empty() const
+{
+    return size() == 0;
+}
+
+std::size_t ResultSet::bytes() const
+{
+    return mArena.size();
+}
+
+RowView ResultSet::operator[](std::size_t row) const
+{
+    return RowView{*this, row};
+}
+
+ResultSet::Iterator ResultSet::begin() const
+{
+    return Iterator{*this, 0};
+}
+
+ResultSet::Iterator ResultSet::end() const
+{
+    return Iterator{*this, size()};
+}
+
+Rows ResultSet::toRows() const
+{
+    Rows rows;
+    rows.reserve(size());
+
+    for (const auto& row : *this)
+    {
+        rows.emplace_back(row.toRow());
+    }
+
+    return rows;
+}
+
+void ResultSet::appendCell(std::optional<std::string_view> value)
+{
+    const auto cell = mOffsets.size() - 1;
+
+    if (cell % kBitsPerWord == 0)
+    {
+        mNulls.emplace_back(0);
+    }
+
+    if (value)
+    {
+        mArena.insert(mArena.end(), value->begin(), value->end());
+    }
+    else
+    {
+        mNulls.back() |= std::uint64_t{1} << (cell % kBitsPerWord);
+    }
+
+    mOffsets.emplace_back(mArena.size());
+}
+
+bool ResultSet::isNull(std::size_t cell) const
+{
+    return (mNulls[cell / kBitsPerWord] >> (cell % kBitsPerWord)) & 1U;
+}
+
+std::string_view ResultSet::cell(std::size_t cell) const
+{
+    return std::string_view{mArena.data() + mOffsets[cell], mOffsets[cell + 1] - mOffsets[cell]};
+}
+
+} // namespace sqlite_wrapper
@@ -0,0 +1,207 @@
+#include "RowCursor.hpp"
+
+#include <utility>
+
+namespace sqlite_wrapper
+{
+
+CursorRow::CursorRow(sqlite3_stmt* stmt)
+    : mStmt{stmt}
+{
+}
+
+int CursorRow::size() const
+{
+    return sqlite3_column_count(mStmt);
+}
+
+bool CursorRow::isNull(int col) const
+{
+    return sqlite3_column_type(mStmt, col) == SQLITE_NULL;
+}
+
+std::optional<std::string_view> CursorRow::operator[](int col) const
+{
+    if (isNull(col))
+    {
+        return std::nullopt;
+    }
+
+    return text(col);
+}
+
+std::string_view CursorRow::text(int col) const
+{
+    // sqlite3_column_bytes() must be called after sqlite3_column_text(), which may convert the value
+    auto text = reinterpret_cast<const char*>(sqlite3_column_text(mStmt, col)); // NOLINT
+    if (text == nullptr)
+    {
+        return {};
+    }
+
+    return std::string_view{text, static_cast<std::size_t>(sqlite3_column_bytes(mStmt, col))};
+}
+
+std::int64_t CursorRow::integer(int col) const
+{
+    return sqlite3_column_int64(mStmt, col);
+}
+
+double CursorRow::real(int col) const
+{
+    return sqlite3_column_double(mStmt, col);
+}
+
+SqlValue CursorRow::value(int col) const
+{
+    switch (sqlite3_column_type(mStmt, col))
+    {
+    case SQLITE_INTEGER:
+        return integer(col);
+    case SQLITE_FLOAT:
+        return real(col);
+    case SQLITE_TEXT:
+        return std::string{text(col)};
+    case SQLITE_BLOB:
+    {
+        auto data = static_cast<const std::uint8_t*>(sqlite3_column_blob(mStmt, col));
+        return Blob{data, data + sqlite3_column_bytes(mStmt, col)};
+    }
+    default:
+        return nullptr;
+    }
+}
+
+RowCursor::Iterator::Iterator(RowCursor* cursor)
+    : mCursor{cursor}
+{
+}
+
+RowCursor::Iterator::reference RowCursor::Iterator::operator*() const
+{
+    return mCursor->row();
+}
+
+RowCursor::Iterator::pointer RowCursor::Iterator::operator->() const
+{
+    return &mCursor->row();
+}
+
+RowCursor::Iterator& RowCursor::Iterator::operator++()
+{
+    mCursor->next();
+    return *this;
+}
+
+bool RowCursor::Iterator::operator==(const Iterator& other) const
+{
+    if (atEnd() || other.atEnd())
+    {
+        return atEnd() == other.atEnd();
+    }
+
+    return mCursor == other.mCursor;
+}
+
+bool RowCursor::Iterator::operator!=(const Iterator& other) const
+{
+    return !(*this == other);
+}
+
+bool RowCursor::Iterator::atEnd() const
+{
+    return mCursor == nullptr || mCursor->done();
+}
+
+RowCursor::RowCursor(Statement statement)
+    : mStatement{std::move(statement)}
+    , mRow{mStatement.get()}
+    , mDone{!mStatement}
+{
+}
+
+RowCursor::RowCursor(RowCursor&& other) noexcept
+    : mRetained{std::move(other.mRetained)}
+    , mStatement{std::move(other.mStatement)}
+    , mRow{other.mRow}
+    , mStarted{other.mStarted}
+    , mDone{std::exchange(other.mDone, true)}
+{
+}
+
+RowCursor& RowCursor::operator=(RowCursor&& other) noexcept
+{
+    if (this != &other)
+    {
+        close();
+        mStatement = std::move(other.mStatement);
+        mRetained  = std::move(other.mRetained);
+        mRow       = other.mRow;
+        mStarted   = other.mStarted;
+        mDone      = std::exchange(other.mDone, true);
+    }
+
+    return *this;
+}
+
+RowCursor::~RowCursor()
+{
+    close();
+}
+
+bool RowCursor::next()
+{
+    if (mDone || !mStatement)
+    {
+        return false;
+    }
+
+    mStarted = true;
+    if (!mStatement.step())
+    {
+        close();
+        return false;
+    }
+
+    return true;
+}
+
+const CursorRow& RowCursor::row() const
+{
+    return mRow;
+}
+
+void RowCursor::retain(std::shared_ptr<void> resource)
+{
+    mRetained = std::move(resource);
+}
+
+void RowCursor::close()
+{
+    mStatement = Statement{};
+    mRetained.reset();
+    mRow  = CursorRow{};
+    mDone = true;
+}
+
+bool RowCursor::done() const
+{
+    return mDone;
+}
+
+RowCursor::Iterator RowCursor::begin()
+{
+    if (!mStarted)
+    {
+        next();
+    }
+
+    return Iterator{this};
+}
+
+RowCursor::Iterator RowCursor::end()
+{
+    return Iterator{};
+}
+
+} // namespace sqlite_wrapper
@@ -2,8 +2,6 @@
 
 #include "StringUtils.hpp"
 
-#include <algorithm>
-
 namespace sqlite_wrapper
 {
 
@@ -67,14 +65,91 @@ std::string SqliteTraits::SqlInsertWithPlaceholders(const std::string& table, co
     // SQL statement:
     //     INSERT [OR REPLACE] INTO <table> VALUES (<placeholders>);
 
-    std::vector<char> params(count);
-    std::fill(params.begin(), params.end(), '?');
-    auto placeholders = StringUtils::Join(params, ", ");
+    Tokens tokens{"INSERT ", replace ? "OR REPLACE" : "", " INTO ", table, " VALUES (", SqlPlaceholders(count), ");"};
+    return StringUtils::Join(tokens, StringUtils::empty);
+}
+
+std::string SqliteTraits::SqlInsertWithPlaceholders(const std::string& table,
+                                                    const std::vector<std::string>& columns,
+                                                    std::size_t count,
+                                                    ConflictPolicy policy)
+{
+    // SQL statement:
+    //     INSERT [OR REPLACE|OR IGNORE] INTO <table> [(<columns>)] VALUES (<placeholders>);
 
-    Tokens tokens{"INSERT ", replace ? "OR REPLACE" : "", " INTO ", table, " VALUES (", placeholders, ");"};
+    std::string conflict;
+    if (policy == ConflictPolicy::Replace)
+    {
+        conflict = "OR REPLACE";
+    }
+    else if (policy == ConflictPolicy::Ignore)
+    {
+        conflict = "OR IGNORE";
+    }
+
+    const auto columnList = columns.empty() ? std::string{} : "(" + StringUtils::Join(columns) + ")";
+
+    Tokens tokens{"INSERT ", conflict, " INTO ", table, columnList, " VALUES (", SqlPlaceholders(count), ");"};
     return StringUtils::Join(tokens, StringUtils::empty);
 }
 
+std::string SqliteTraits::SqlUpsertWithPlaceholders(const std::string& table,
+                                                    const std::vector<std::string>& columns,
+                                                    std::size_t count,
+                                                    const std::vector<std::string>& conflictColumns,
+                                                    const std::vector<std::string>& updateColumns)
+{
+    // SQL statement:
+    //     INSERT INTO <table> [(<columns>)] VALUES (<placeholders>)
+    //         ON CONFLICT(<conflict columns>) DO UPDATE SET <column>=excluded.<column>, ... RETURNING rowid;
+
+    Tokens assignments;
+    for (const auto& col : updateColumns)
+    {
+        assignments.emplace_back(col + "=excluded." + col);
+    }
+
+    const auto columnList = columns.empty() ? std::string{} : "(" + StringUtils::Join(columns) + ")";
+
+    Tokens tokens{"INSERT INTO ",
+                  table,
+                  columnList,
+                  " VALUES (",
+                  SqlPlaceholders(count),
+                  ") ON CONFLICT(",
+                  StringUtils::Join(conflictColumns),
+                  ") DO UPDATE SET ",
+                  StringUtils::Join(assignments),
+                  " RETURNING rowid;"};
+    return StringUtils::Join(tokens, StringUtils::empty);
+}
+
+std::string SqliteTraits::SqlPragma(const std::string& name, const std::string& value)
+{
+    // SQL statement:
+    //     PRAGMA <name>=<value>;
+
+    Tokens tokens{"PRAGMA ", name, "=", value, ";"};
+    return StringUtils::Join(tokens, StringUtils::empty);
+}
+
+std::string SqliteTraits::SqlBeginTransaction(TransactionMode mode)
+{
+    // SQL statement:
+    //     begin [immediate|exclusive];
+
+    switch (mode)
+    {
+    case TransactionMode::Immediate:
+        return "begin immediate;";
+    case TransactionMode::Exclusive:
+        return "begin exclusive;";
+    case TransactionMode::Deferred:
+    default:
+        return "begin;";
+    }
+}
+
 std::string SqliteTraits::SqlCount(const std::string& table, const std::string& col, const KeyValues& filters)
 {
     // SQL statement:
@@ -111,6 +186,319 @@ std::string SqliteTraits::SqlSelectFunction(const std::string& function,
     return StringUtils::Join(tokens, StringUtils::empty);
 }
 
+ParameterizedSql
+SqliteTraits::SqlSelectParameterized(const std::string& table, const std::string& col, const KeyValues& filters)
+{
+    // SQL statement:
+    //     SELECT <col> FROM <table> <filters>;
+
+    ParameterizedSql statement;
+    Tokens tokens{"SELECT ", col, " FROM ", table, SqlFilters(filters, statement.params), ";"};
+    statement.sql = StringUtils::Join(tokens, StringUtils::empty);
+    return statement;
+}
+
+ParameterizedSql SqliteTraits::SqlInsertParameterized(const std::string& table, const KeyValues& keyValues, bool replace)
+{
+    // SQL statement:
+    //     INSERT [OR REPLACE] INTO <table> (<keys>) VALUES (<placeholders>);
+    //     INSERT [OR REPLACE] INTO <table> DEFAULT VALUES;   (no key-values)
+
+    ParameterizedSql statement;
+
+    if (keyValues.empty())
+    {
+        Tokens tokens{"INSERT ", replace ? "OR REPLACE" : "", " INTO ", table, " DEFAULT VALUES;"};
+        statement.sql = StringUtils::Join(tokens, StringUtils::empty);
+        return statement;
+    }
+
+    Tokens keys;
+    for (const auto& kv : keyValues)
+    {
+        keys.emplace_back(kv.key());
+        statement.params.emplace_back(kv.sqlValue());
+    }
+
+    Tokens tokens{"INSERT ",
+                  replace ? "OR REPLACE" : "",
+                  " INTO ",
+                  table,
+                  "(",
+                  StringUtils::Join(keys),
+                  ") VALUES (",
+                  SqlPlaceholders(keys.size()),
+                  ");"};
+    statement.sql = StringUtils::Join(tokens, StringUtils::empty);
+    return statement;
+}
+
+ParameterizedSql SqliteTraits::SqlUpsertParameterized(const std::string& table,
+                                                      const KeyValues& keyValues,
+                                                      const std::vector<std::string>& conflictColumns,
+                                                      const std::vector<std::string>& updateColumns)
+{
+    // SQL statement:
+    //     INSERT INTO <table> (<keys>) VALUES (<placeholders>)
+    //         ON CONFLICT(<conflict columns>) DO UPDATE SET <column>=excluded.<column>, ... RETURNING rowid;
+
+    ParameterizedSql statement;
+
+    Tokens keys;
+    for (const auto& kv : keyValues)
+    {
+        keys.emplace_back(kv.key());
+        statement.params.emplace_back(kv.sqlValue());
+    }
+
+    statement.sql = SqlUpsertWithPlaceholders(table, keys, keys.size(), conflictColumns, updateColumns);
+    return statement;
+}
+
+ParameterizedSql SqliteTraits::SqlUpdateParameterized(const std::string& table,
+                                                      const KeyValues& keyValues,
+                                                      const KeyValues& filters)
+{
+    // SQL statement:
+    //     UPDATE <table> SET <key-placeholder pairs> <filters>;
+
+    ParameterizedSql statement;
+    auto assignments = SqlAssignments(keyValues, statement.params);
+    Tokens tokens{"UPDATE ", table, " SET ", assignments, SqlFilters(filters, statement.params), ";"};
+    statement.sql = StringUtils::Join(tokens, StringUtils::empty);
+    return statement;
+}
+
+ParameterizedSql SqliteTraits::SqlDeleteParameterized(const std::string& table, const KeyValues& filters)
+{
+    // SQL statement:
+    //     DELETE FROM <table> <filters>;
+
+    ParameterizedSql statement;
+    Tokens tokens{"DELETE FROM ", table, SqlFilters(filters, statement.params), ";"};
+    statement.sql = StringUtils::Join(tokens, StringUtils::empty);
+    return statement;
+}
+
+ParameterizedSql
+SqliteTraits::SqlCountParameterized(const std::string& table, const std::string& col, const KeyValues& filters)
+{
+    return SqlSelectFunctionParameterized("COUNT", col, table, filters);
+}
+
+ParameterizedSql
+SqliteTraits::SqlSumParameterized(const std::string& table, const std::string& col, const KeyValues& filters)
+{
+    return SqlSelectFunctionParameterized("SUM", col, table, filters);
+}
+
+ParameterizedSql
+SqliteTraits::SqlAvgParameterized(const std::string& table, const std::string& col, const KeyValues& filters)
+{
+    return SqlSelectFunctionParameterized("AVG", col, table, filters);
+}
+
+ParameterizedSql SqliteTraits::SqlSelectFunctionParameterized(const std::string& function,
+                                                              const std::string& col,
+                                                              const std::string& table,
+                                                              const KeyValues& filters)
+{
+    // SQL statement:
+    //     SELECT <function>(<column>) FROM <table> <filters>;
+
+    ParameterizedSql statement;
+    Tokens tokens{"SELECT ", function, "(", col, ")", " FROM ", table, SqlFilters(filters, statement.params), ";"};
+    statement.sql = StringUtils::Join(tokens, StringUtils::empty);
+    return statement;
+}
+
+ParameterizedSql
+SqliteTraits::SqlSelectParameterized(const std::string& table, const std::string& col, const Filter& filter)
+{
+    // SQL statement:
+    //     SELECT <col> FROM <table> <filter>;
+
+    ParameterizedSql statement;
+    Tokens tokens{"SELECT ", col, " FROM ", table, SqlFilters(filter, statement.params), ";"};
+    statement.sql = StringUtils::Join(tokens, StringUtils::empty);
+    return statement;
+}
+
+ParameterizedSql
+SqliteTraits::SqlUpdateParameterized(const std::string& table, const KeyValues& keyValues, const Filter& filter)
+{
+    // SQL statement:
+    //     UPDATE <table> SET <key-placeholder pairs> <filter>;
+
+    ParameterizedSql statement;
+    auto assignments = SqlAssignments(keyValues, statement.params);
+    Tokens tokens{"UPDATE ", table, " SET ", assignments, SqlFilters(filter, statement.params), ";"};
+    statement.sql = StringUtils::Join(tokens, StringUtils::empty);
+    return statement;
+}
+
+ParameterizedSql SqliteTraits::SqlDeleteParameterized(const std::string& table, const Filter& filter)
+{
+    // SQL statement:
+    //     DELETE FROM <table> <filter>;
+
+    ParameterizedSql statement;
+    Tokens tokens{"DELETE FROM ", table, SqlFilters(filter, statement.params), ";"};
+    statement.sql = StringUtils::Join(tokens, StringUtils::empty);
+    return statement;
+}
+
+ParameterizedSql
+SqliteTraits::SqlCountParameterized(const std::string& table, const std::string& col, const Filter& filter)
+{
+    return SqlSelectFunctionParameterized("COUNT", col, table, filter);
+}
+
+ParameterizedSql
+SqliteTraits::SqlSumParameterized(const std::string& table, const std::string& col, const Filter& filter)
+{
+    return SqlSelectFunctionParameterized("SUM", col, table, filter);
+}
+
+ParameterizedSql
+SqliteTraits::SqlAvgParameterized(const std::string& table, const std::string& col, const Filter& filter)
+{
+    return SqlSelectFunctionParameterized("AVG", col, table, filter);
+}
+
+ParameterizedSql SqliteTraits::SqlSelectFunctionParameterized(const std::string& function,
+                                                              const std::string& col,
+                                                              const std::string& table,
+                                                              const Filter& filter)
+{
+    // SQL statement:
+    //     SELECT <function>(<column>) FROM <table> <filter>;
+
+    ParameterizedSql statement;
+    Tokens tokens{"SELECT ", function, "(", col, ")", " FROM ", table, SqlFilters(filter, statement.params), ";"};
+    statement.sql = StringUtils::Join(tokens, StringUtils::empty);
+    return statement;
+}
+
+ParameterizedSql
+SqliteTraits::SqlQueryParameterized(const std::string& table, const QueryOptions& options, const Filter& filter)
+{
+    // SQL statement:
+    //     SELECT <columns> FROM <table> <filter> [ORDER BY <col> [DESC], ...] [LIMIT ? [OFFSET ?]];
+
+    ParameterizedSql statement;
+    Tokens tokens{"SELECT ",
+                  options.columns.empty() ? "*" : StringUtils::Join(options.columns),
+                  " FROM ",
+                  table,
+                  SqlFilters(filter, statement.params)};
+
+    if (!options.orderBy.empty())
+    {
+        Tokens orders;
+        for (const auto& order : options.orderBy)
+        {
+            orders.emplace_back(order.col + (order.descending ? " DESC" : ""));
+        }
+
+        tokens.emplace_back(" ORDER BY " + StringUtils::Join(orders));
+    }
+
+    // bound rather than inlined, so that all pages share one statement; a negative LIMIT means none
+    if (options.limit || options.offset > 0)
+    {
+        tokens.emplace_back(" LIMIT ?");
+        statement.params.emplace_back(options.limit ? static_cast<std::int64_t>(*options.limit) : std::int64_t{-1});
+    }
+
+    if (options.offset > 0)
+    {
+        tokens.emplace_back(" OFFSET ?");
+        statement.params.emplace_back(static_cast<std::int64_t>(options.offset));
+    }
+
+    tokens.emplace_back(";");
+    statement.sql = StringUtils::Join(tokens, StringUtils::empty);
+    return statement;
+}
+
+ParameterizedSql SqliteTraits::SqlPageParameterized(const std::string& table,
+                                                    const PageOptions& options,
+                                                    const Filter& filter,
+                                                    const std::optional<PageToken>& after)
+{
+    // SQL statement:
+    //     SELECT <columns>, <seek columns> FROM <table> WHERE (<filter>) AND (<seek columns>) > (<placeholders>)
+    //     ORDER BY <seek column> [DESC], ... LIMIT ?;
+    //
+    // The seek columns are appended to the result, to build the next page token from the last row. One row
+    // more than a page is requested, to tell whether another page follows.
+
+    const auto seekColumns = options.seekColumns();
+    const auto direction   = options.descending ? " DESC" : "";
+
+    ParameterizedSql statement;
+
+    Tokens conditions;
+    if (!filter.empty())
+    {
+        conditions.emplace_back("(" + SqlFilter(filter, statement.params) + ")");
+    }
+
+    if (after)
+    {
+        conditions.emplace_back("(" + StringUtils::Join(seekColumns) + (options.descending ? ") < (" : ") > (")
+                                + SqlPlaceholders(seekColumns.size()) + ")");
+        statement.params.insert(statement.params.end(), after->after.cbegin(), after->after.cend());
+    }
+
+    Tokens orders;
+    for (const auto& col : seekColumns)
+    {
+        orders.emplace_back(col + direction);
+    }
+
+    Tokens tokens{"SELECT ",
+                  options.columns.empty() ? "*" : StringUtils::Join(options.columns),
+                  ", ",
+                  StringUtils::Join(seekColumns),
+                  " FROM ",
+                  table,
+                  conditions.empty() ? "" : " WHERE " + StringUtils::Join(conditions, " AND "),
+                  " ORDER BY ",
+                  StringUtils::Join(orders),
+                  " LIMIT ?;"};
+    statement.params.emplace_back(static_cast<std::int64_t>(options.pageSize + 1));
+    statement.sql = StringUtils::Join(tokens, StringUtils::empty);
+    return statement;
+}
+
+ParameterizedSql SqliteTraits::SqlAggregateParameterized(const std::string& table,
+                                                         const std::vector<std::string>& groupBy,
+                                                         const Aggregates& aggregates,
+                                                         const KeyValues& filters)
+{
+    // SQL statement:
+    //     SELECT <group-by columns>, <function>(<column>), ... FROM <table> <filters> [GROUP BY <group-by columns>];
+
+    Tokens columns{groupBy};
+    for (const auto& aggregate : aggregates)
+    {
+        columns.emplace_back(SqlAggregate(aggregate));
+    }
+
+    ParameterizedSql statement;
+    Tokens tokens{"SELECT ",
+                  StringUtils::Join(columns),
+                  " FROM ",
+                  table,
+                  SqlFilters(filters, statement.params),
+                  groupBy.empty() ? "" : " GROUP BY " + StringUtils::Join(groupBy),
+                  ";"};
+    statement.sql = StringUtils::Join(tokens, StringUtils::empty);
+    return statement;
+}
+
 std::string SqliteTraits::SqlFilters(const KeyValues& keyValues)
 {
     std::string sql;
@@ -153,4 +541,157 @@ std::string SqliteTraits::SqlAssignment(const KeyValue& keyValue)
     return keyValue.key() + "=" + (keyValue.value() ? StringUtils::Quote(*keyValue.value()) : "NULL");
 }
 
+std::string SqliteTraits::SqlFilters(const KeyValues& keyValues, SqlRow& params)
+{
+    std::string sql;
+
+    if (!keyValues.empty())
+    {
+        sql += " WHERE " + SqlFilter(keyValues.front(), params);
+        for (auto it = ++keyValues.begin(); keyValues.end() != it; ++it)
+        {
+            sql += " AND " + SqlFilter(*it, params);
+        }
+    }
+
+    return sql;
+}
+
+std::string SqliteTraits::SqlFilter(const KeyValue& keyValue, SqlRow& params)
+{
+    // NULL never compares equal, so it stays part of the statement shape
+    if (IsNull(keyValue.sqlValue()))
+    {
+        return keyValue.key() + " IS NULL";
+    }
+
+    params.emplace_back(keyValue.sqlValue());
+    return keyValue.key() + "=?";
+}
+
+std::string SqliteTraits::SqlFilters(const Filter& filter, SqlRow& params)
+{
+    return filter.empty() ? std::string{} : " WHERE " + SqlFilter(filter, params);
+}
+
+std::string SqliteTraits::SqlFilter(const Filter& filter, SqlRow& params)
+{
+    using Operator = Filter::Operator;
+
+    const auto& key    = filter.key();
+    const auto& values = filter.values();
+
+    switch (filter.op())
+    {
+    case Operator::Equal:
+        if (IsNull(values.front()))
+        {
+            return key + " IS NULL";
+        }
+
+        params.emplace_back(values.front());
+        return key + "=?";
+    case Operator::NotEqual:
+        if (IsNull(values.front()))
+        {
+            return key + " IS NOT NULL";
+        }
+
+        params.emplace_back(values.front());
+        return key + "!=?";
+    case Operator::Less:
+        params.emplace_back(values.front());
+        return key + "<?";
+    case Operator::LessEqual:
+        params.emplace_back(values.front());
+        return key + "<=?";
+    case Operator::Greater:
+        params.emplace_back(values.front());
+        return key + ">?";
+    case Operator::GreaterEqual:
+        params.emplace_back(values.front());
+        return key + ">=?";
+    case Operator::Between:
+        params.insert(params.end(), values.cbegin(), values.cend());
+        return key + " BETWEEN ? AND ?";
+    case Operator::In:
+        params.insert(params.end(), values.cbegin(), values.cend());
+        return key + " IN (" + SqlPlaceholders(values.size()) + ")";
+    case Operator::Like:
+        params.emplace_back(values.front());
+        return key + " LIKE ?";
+    case Operator::And:
+    case Operator::Or:
+    {
+        const auto& operands = filter.operands();
+        if (operands.empty())
+        {
+            return filter.op() == Operator::And ? "1" : "0";
+        }
+
+        // nested ANDs and ORs are parenthesized, so that precedence is explicit
+        Tokens tokens;
+        for (const auto& operand : operands)
+        {
+            auto sql    = SqlFilter(operand, params);
+            auto nested = (operand.op() == Operator::And || operand.op() == Operator::Or) && !operand.empty();
+            tokens.emplace_back(nested ? "(" + sql + ")" : std::move(sql));
+        }
+
+        return StringUtils::Join(tokens, filter.op() == Operator::And ? " AND " : " OR ");
+    }
+    case Operator::Not:
+        return "NOT (" + SqlFilter(filter.operands().front(), params) + ")";
+    }
+
+    return {};
+}
+
+std::string SqliteTraits::SqlAssignments(const KeyValues& keyValues, SqlRow& params)
+{
+    std::string sql;
+
+    if (!keyValues.empty())
+    {
+        sql += " " + SqlAssignment(keyValues.front(), params);
+        for (auto it = ++keyValues.begin(); keyValues.end() != it; ++it)
+        {
+            sql += ", " + SqlAssignment(*it, params);
+        }
+    }
+
+    return sql;
+}
+
+std::string SqliteTraits::SqlAssignment(const KeyValue& keyValue, SqlRow& params)
+{
+    params.emplace_back(keyValue.sqlValue());
+    return keyValue.key() + "=?";
+}
+
+std::string SqliteTraits::SqlPlaceholders(std::size_t count)
+{
+    std::vector<char> placeholders(count, '?');
+    return StringUtils::Join(placeholders, StringUtils::comma_whitespace);
+}
+
+std::string SqliteTraits::SqlAggregate(const Aggregate& aggregate)
+{
+    switch (aggregate.function)
+    {
+    case Aggregate::Function::Count:
+        return "COUNT(" + aggregate.col + ")";
+    case Aggregate::Function::Sum:
+        return "SUM(" + aggregate.col + ")";
+    case Aggregate::Function::Avg:
+        return "AVG(" + aggregate.col + ")";
+    case Aggregate::Function::Min:
+        return "MIN(" + aggregate.col + ")";
+    case Aggregate::Function::Max:
+        return "MAX(" + aggregate.col + ")";
+    }
+
+    return {};
+}
+
 } // namespace sqlite_wrapper
@@ -0,0 +1,87 @@
+#include "SqliteTypes.hpp"
+
+#include <sqlite3.h>
+
+#include <utility>
+
+namespace sqlite_wrapper
+{
+
+namespace
+{
+
+struct ToValueVisitor
+{
+    Value operator()(std::nullptr_t) const
+    {
+        return std::nullopt;
+    }
+
+    Value operator()(std::int64_t value) const
+    {
+        return std::to_string(value);
+    }
+
+    Value operator()(double value) const
+    {
+        // same format SQLite uses when converting a REAL to TEXT
+        char buffer[32];
+        sqlite3_snprintf(sizeof(buffer), buffer, "%!.15g", value);
+        return std::string{buffer};
+    }
+
+    Value operator()(std::string& value) const
+    {
+        return std::move(value);
+    }
+
+    Value operator()(const std::string& value) const
+    {
+        return value;
+    }
+
+    Value operator()(const Blob& value) const
+    {
+        return std::string{value.begin(), value.end()};
+    }
+};
+
+} // namespace
+
+Value ToValue(const SqlValue& value)
+{
+    return std::visit(ToValueVisitor{}, value);
+}
+
+Value ToValue(SqlValue&& value)
+{
+    return std::visit(ToValueVisitor{}, value);
+}
+
+Row ToRow(SqlRow&& row)
+{
+    Row result;
+    result.reserve(row.size());
+
+    for (auto& value : row)
+    {
+        result.emplace_back(ToValue(std::move(value)));
+    }
+
+    return result;
+}
+
+Rows ToRows(SqlRows&& rows)
+{
+    Rows result;
+    result.reserve(rows.size());
+
+    for (auto& row : rows)
+    {
+        result.emplace_back(ToRow(std::move(row)));
+    }
+
+    return result;
+}
+
+} // namespace sqlite_wrapper
@@ -0,0 +1,210 @@
+#include "Statement.hpp"
+
+#include "BusyPolicy.hpp"
+#include "RowCursor.hpp"
+#include "StatementCache.hpp"
+
+#include "sqlite_modern_cpp.h"
+
+#include <type_traits>
+#include <utility>
+
+namespace sqlite_wrapper
+{
+
+Statement::Statement(sqlite3_stmt* stmt, std::string sql, StatementCache* cache, std::uint64_t generation)
+    : mStmt{stmt}
+    , mSql{std::move(sql)}
+    , mCache{cache}
+    , mGeneration{generation}
+{
+}
+
+Statement::Statement(Statement&& other) noexcept
+    : mStmt{std::exchange(other.mStmt, nullptr)}
+    , mSql{std::move(other.mSql)}
+    , mCache{std::exchange(other.mCache, nullptr)}
+    , mGeneration{other.mGeneration}
+{
+}
+
+Statement& Statement::operator=(Statement&& other) noexcept
+{
+    if (this != &other)
+    {
+        release();
+        mStmt       = std::exchange(other.mStmt, nullptr);
+        mSql        = std::move(other.mSql);
+        mCache      = std::exchange(other.mCache, nullptr);
+        mGeneration = other.mGeneration;
+    }
+
+    return *this;
+}
+
+Statement::~Statement()
+{
+    release();
+}
+
+sqlite3_stmt* Statement::get() const
+{
+    return mStmt;
+}
+
+const std::string& Statement::sql() const
+{
+    return mSql;
+}
+
+void Statement::bind(const Row& params, int firstIndex)
+{
+    for (std::size_t i = 0; i < params.size(); ++i)
+    {
+        const auto index  = firstIndex + static_cast<int>(i);
+        const auto& param = params[i];
+
+        int hresult;
+        if (param)
+        {
+            hresult = sqlite3_bind_text(mStmt, index, param->data(), static_cast<int>(param->size()), SQLITE_TRANSIENT);
+        }
+        else
+        {
+            hresult = sqlite3_bind_null(mStmt, index);
+        }
+
+        if (hresult != SQLITE_OK)
+        {
+            sqlite::errors::throw_sqlite_error(hresult, mSql);
+        }
+    }
+}
+
+void Statement::bind(const SqlRow& params)
+{
+    for (std::size_t i = 0; i < params.size(); ++i)
+    {
+        bind(static_cast<int>(i) + 1, params[i]);
+    }
+}
+
+void Statement::bind(int index, const SqlValue& value)
+{
+    auto hresult = std::visit(
+        [this, index](const auto& v) {
+            using T = std::decay_t<decltype(v)>;
+
+            if constexpr (std::is_same<T, std::nullptr_t>::value)
+            {
+                return sqlite3_bind_null(mStmt, index);
+            }
+            else if constexpr (std::is_same<T, std::int64_t>::value)
+            {
+                return sqlite3_bind_int64(mStmt, index, v);
+            }
+            else if constexpr (std::is_same<T, double>::value)
+            {
+                return sqlite3_bind_double(mStmt, index, v);
+            }
+            else if constexpr (std::is_same<T, std::string>::value)
+            {
+                return sqlite3_bind_text(mStmt, index, v.data(), static_cast<int>(v.size()), SQLITE_TRANSIENT);
+            }
+            else
+            {
+                return sqlite3_bind_blob(mStmt, index, v.data(), static_cast<int>(v.size()), SQLITE_TRANSIENT);
+            }
+        },
+        value);
+
+    if (hresult != SQLITE_OK)
+    {
+        sqlite::errors::throw_sqlite_error(hresult, mSql);
+    }
+}
+
+void Statement::bindText(int index, std::string_view text)
+{
+    auto hresult = sqlite3_bind_text(mStmt, index, text.data(), static_cast<int>(text.size()), SQLITE_TRANSIENT);
+    if (hresult != SQLITE_OK)
+    {
+        sqlite::errors::throw_sqlite_error(hresult, mSql);
+    }
+}
+
+void Statement::bindNull(int index)
+{
+    auto hresult = sqlite3_bind_null(mStmt, index);
+    if (hresult != SQLITE_OK)
+    {
+        sqlite::errors::throw_sqlite_error(hresult, mSql);
+    }
+}
+
+bool Statement::step()
+{
+    BusyTimeoutError::Clear();
+
+    auto hresult = sqlite3_step(mStmt);
+    if (hresult == SQLITE_ROW)
+    {
+        return true;
+    }
+
+    if (hresult != SQLITE_DONE)
+    {
+        BusyTimeoutError::Throw(sqlite3_db_handle(mStmt), hresult, mSql);
+    }
+
+    return false;
+}
+
+void Statement::execute()
+{
+    while (step())
+    {
+    }
+}
+
+void Statement::reset()
+{
+    sqlite3_reset(mStmt);
+}
+
+int Statement::columnCount() const
+{
+    return sqlite3_column_count(mStmt);
+}
+
+SqlValue Statement::column(int index) const
+{
+    return CursorRow{mStmt}.value(index);
+}
+
+Statement::operator bool() const
+{
+    return mStmt != nullptr;
+}
+
+void Statement::release()
+{
+    if (mStmt == nullptr)
+    {
+        return;
+    }
+
+    if (mCache != nullptr)
+    {
+        mCache->release(mStmt, std::move(mSql), mGeneration);
+    }
+    else
+    {
+        sqlite3_finalize(mStmt);
+    }
+
+    mStmt  = nullptr;
+    mCache = nullptr;
+}
+
+} // namespace sqlite_wrapper
@@ -0,0 +1,115 @@
+#include "StatementCache.hpp"
+
+#include "sqlite_modern_cpp.h"
+
+namespace sqlite_wrapper
+{
+
+StatementCache::StatementCache(std::size_t capacity)
+    : mCapacity{capacity}
+{
+    mStats.capacity = capacity;
+}
+
+StatementCache::~StatementCache()
+{
+    clear();
+}
+
+Statement StatementCache::acquire(sqlite3* db, const std::string& sql)
+{
+    std::uint64_t generation;
+
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        generation = mGeneration;
+
+        auto it = mIndex.find(sql);
+        if (it != mIndex.end())
+        {
+            auto stmt = it->second->stmt;
+            mEntries.erase(it->second);
+            mIndex.erase(it);
+            ++mStats.hits;
+            return Statement(stmt, sql, this, generation);
+        }
+
+        ++mStats.misses;
+    }
+
+    sqlite3_stmt* stmt = nullptr;
+    auto hresult       = sqlite3_prepare_v3(db, sql.c_str(), -1, SQLITE_PREPARE_PERSISTENT, &stmt, nullptr);
+    if (hresult != SQLITE_OK)
+    {
+        sqlite3_finalize(stmt);
+        sqlite::errors::throw_sqlite_error(hresult, sql);
+    }
+
+    return Statement(stmt, sql, this, generation);
+}
+
+void StatementCache::clear()
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    for (auto& entry : mEntries)
+    {
+        sqlite3_finalize(entry.stmt);
+    }
+
+    mEntries.clear();
+    mIndex.clear();
+    ++mGeneration;
+}
+
+StatementCache::Stats StatementCache::stats() const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    auto stats = mStats;
+    stats.size = mEntries.size();
+    return stats;
+}
+
+void StatementCache::release(sqlite3_stmt* stmt, std::string sql, std::uint64_t generation)
+{
+    // leave the statement ready to be re-bound and so that it does not hold on to a read transaction
+    sqlite3_reset(stmt);
+    sqlite3_clear_bindings(stmt);
+
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    if (mCapacity == 0 || generation != mGeneration)
+    {
+        sqlite3_finalize(stmt);
+        return;
+    }
+
+    mEntries.push_front(Entry{sql, stmt});
+    mIndex.emplace(std::move(sql), mEntries.begin());
+
+    while (mEntries.size() > mCapacity)
+    {
+        evict();
+    }
+}
+
+void StatementCache::evict()
+{
+    auto last  = std::prev(mEntries.end());
+    auto range = mIndex.equal_range(last->sql);
+    for (auto it = range.first; it != range.second; ++it)
+    {
+        if (it->second == last)
+        {
+            mIndex.erase(it);
+            break;
+        }
+    }
+
+    sqlite3_finalize(last->stmt);
+    mEntries.erase(last);
+    ++mStats.evictions;
+}
+
+} // namespace sqlite_wrapper
@@ -0,0 +1,71 @@
+#include "TaskQueue.hpp"
+
+#include <algorithm>
+#include <utility>
+
+namespace sqlite_wrapper
+{
+
+TaskQueue::TaskQueue(std::size_t threadCount)
+{
+    for (std::size_t i = 0; i < std::max<std::size_t>(threadCount, 1); ++i)
+    {
+        mThreads.emplace_back([this] { run(); });
+    }
+}
+
+TaskQueue::~TaskQueue()
+{
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mStopping = true;
+    }
+
+    mTaskPushed.notify_all();
+
+    for (auto& thread : mThreads)
+    {
+        thread.join();
+    }
+}
+
+void TaskQueue::push(Task task)
+{
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mTasks.emplace_back(std::move(task));
+    }
+
+    mTaskPushed.notify_one();
+}
+
+std::size_t TaskQueue::pending() const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mTasks.size();
+}
+
+void TaskQueue::run()
+{
+    while (true)
+    {
+        Task task;
+
+        {
+            std::unique_lock<std::mutex> lock(mMutex);
+            mTaskPushed.wait(lock, [this] { return mStopping || !mTasks.empty(); });
+
+            if (mTasks.empty())
+            {
+                return; // stopping, and nothing left to do
+            }
+
+            task = std::move(mTasks.front());
+            mTasks.pop_front();
+        }
+
+        task();
+    }
+}
+
+} // namespace sqlite_wrapper
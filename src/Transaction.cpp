@@ -0,0 +1,99 @@
+#include "Transaction.hpp"
+
+#include <exception>
+#include <iostream>
+#include <utility>
+
+namespace sqlite_wrapper
+{
+
+Transaction::Savepoint::Savepoint(IConnection& connection, std::string name)
+    : mConnection{connection}
+    , mName{std::move(name)}
+{
+    mConnection.savepoint(mName);
+}
+
+Transaction::Savepoint::~Savepoint()
+{
+    if (!mActive)
+    {
+        return;
+    }
+
+    try
+    {
+        rollback();
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "Could not roll back to savepoint " << mName << ": " << e.what() << std::endl;
+    }
+}
+
+void Transaction::Savepoint::release()
+{
+    mConnection.releaseSavepoint(mName);
+    mActive = false;
+}
+
+void Transaction::Savepoint::rollback()
+{
+    mActive = false;
+    mConnection.rollbackToSavepoint(mName);
+    mConnection.releaseSavepoint(mName);
+}
+
+const std::string& Transaction::Savepoint::name() const
+{
+    return mName;
+}
+
+Transaction::Transaction(IConnection& connection, TransactionMode mode, bool enableForeignKeys)
+    : mConnection{connection}
+{
+    mConnection.beginTransaction(mode, enableForeignKeys);
+    mActive = true;
+}
+
+Transaction::~Transaction()
+{
+    if (!mActive)
+    {
+        return;
+    }
+
+    try
+    {
+        rollback();
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "Could not roll back transaction: " << e.what() << std::endl;
+    }
+}
+
+void Transaction::commit()
+{
+    mConnection.commitTransaction();
+    mActive = false;
+}
+
+void Transaction::rollback()
+{
+    // the connection gives up the transaction even if the rollback fails
+    mActive = false;
+    mConnection.rollbackTransaction();
+}
+
+Transaction::Savepoint Transaction::savepoint()
+{
+    return Savepoint{mConnection, "savepoint_" + std::to_string(++mSavepoints)};
+}
+
+bool Transaction::active() const
+{
+    return mActive;
+}
+
+} // namespace sqlite_wrapper
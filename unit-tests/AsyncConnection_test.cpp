@@ -0,0 +1,102 @@
+#include "AsyncConnection.hpp"
+
+#include "gtest/gtest.h"
+
+#include <chrono>
+#include <future>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+using namespace ::testing;
+using namespace ::sqlite_wrapper;
+
+struct TestAsyncConnection : public Test
+{
+    static inline const std::string DBPath = "test_async_db.db";
+    static inline const char* TestTable    = "test_table";
+
+    void SetUp() override
+    {
+        sqlite::sqlite_config config;
+        config.flags        = sqlite::OpenFlags::READWRITE | sqlite::OpenFlags::CREATE;
+        sqlite::database db = sqlite::database(DBPath, config);
+
+        db << "DROP TABLE IF EXISTS test_table;";
+        db << "CREATE TABLE test_table (number INTEGER, string TEXT);";
+
+        mConnection = std::make_unique<AsyncConnection>(DBPath, 2);
+        ASSERT_TRUE(mConnection->open());
+    }
+
+    std::unique_ptr<AsyncConnection> mConnection;
+};
+
+TEST_F(TestAsyncConnection, PipelinedWrites_CompleteInOrder)
+{
+    std::vector<std::future<PrimaryKey>> keys;
+    for (auto i = 0; i < 100; ++i)
+    {
+        keys.emplace_back(mConnection->insert(TestTable, KeyValues{{"number", i}, {"string", "value"}}));
+    }
+    auto updated = mConnection->update(TestTable, {{"string", "updated"}}, {{"number", 99}});
+
+    PrimaryKey previous = 0;
+    for (auto& key : keys)
+    {
+        auto current = key.get();
+        EXPECT_GT(current, previous);
+        previous = current;
+    }
+    updated.get();
+
+    EXPECT_EQ(mConnection->count(TestTable).get(), 100);
+    EXPECT_EQ(mConnection->sum(TestTable, "number").get(), 4950.0);
+    EXPECT_EQ(mConnection->select(TestTable, "string", {{"number", 99}}).get()[0][0].value(), "updated");
+}
+
+TEST_F(TestAsyncConnection, ParallelReads_Work)
+{
+    mConnection->insert(TestTable, Rows{{"1", "one"}, {"2", "two"}, {"3", "three"}}).get();
+
+    std::vector<std::future<Rows>> reads;
+    for (auto i = 0; i < 50; ++i)
+    {
+        reads.emplace_back(mConnection->select(TestTable, {{"number", 2}}));
+    }
+
+    for (auto& read : reads)
+    {
+        auto rows = read.get();
+        ASSERT_EQ(rows.size(), 1);
+        EXPECT_EQ(rows[0], (Row{"2", "two"}));
+    }
+}
+
+TEST_F(TestAsyncConnection, Transaction_CommitsOrRollsBack)
+{
+    auto key = mConnection->transaction([&](IConnection& db) {
+        db.insert(TestTable, KeyValues{{"number", 1}}, true);
+        return db.insert(TestTable, KeyValues{{"number", 2}}, true);
+    });
+    EXPECT_EQ(key.get(), 2);
+
+    auto failed = mConnection->transaction([&](IConnection& db) {
+        db.insert(TestTable, KeyValues{{"number", 3}}, true);
+        throw std::runtime_error("abort");
+    });
+    EXPECT_THROW(failed.get(), std::runtime_error);
+
+    EXPECT_EQ(mConnection->count(TestTable).get(), 2);
+}
+
+TEST_F(TestAsyncConnection, Failure_ReportedThroughFuture)
+{
+    EXPECT_THROW(mConnection->update("no_such_table", {{"number", 1}}).get(), sqlite::sqlite_exception);
+    EXPECT_THROW(mConnection->insert("no_such_table", KeyValues{{"number", 1}}).get(), sqlite::sqlite_exception);
+
+    // the failed writes gave the writer's write mutex back, so later writes do not deadlock
+    auto insert = mConnection->insert(TestTable, KeyValues{{"number", 1}});
+    ASSERT_EQ(insert.wait_for(std::chrono::seconds{5}), std::future_status::ready);
+    EXPECT_EQ(insert.get(), 1);
+}
@@ -0,0 +1,152 @@
+#include "ConnectionPool.hpp"
+
+#include "gtest/gtest.h"
+
+#include <cstdio>
+#include <memory>
+#include <thread>
+#include <vector>
+
+using namespace ::testing;
+using namespace ::sqlite_wrapper;
+
+struct TestConnectionPool : public Test
+{
+    static inline const std::string DBPath = "test_pool_db.db";
+    static inline const char* TestTable    = "test_table";
+
+    void SetUp() override
+    {
+        sqlite::sqlite_config config;
+        config.flags        = sqlite::OpenFlags::READWRITE | sqlite::OpenFlags::CREATE;
+        sqlite::database db = sqlite::database(DBPath, config);
+
+        db << "DROP TABLE IF EXISTS test_table;";
+        db << "CREATE TABLE test_table (number INTEGER, string TEXT);";
+    }
+
+    void init(std::size_t readerCount)
+    {
+        mPool = std::make_unique<ConnectionPool>(DBPath, readerCount);
+        ASSERT_TRUE(mPool->open());
+        ASSERT_TRUE(mPool->isOpen());
+    }
+
+    void defaultFillTable()
+    {
+        auto keys = mPool->insert(TestTable, Rows{{"0", "zero"}, {"1", "one"}, {"2", "two"}, {"3", "three"}}, false);
+        EXPECT_EQ(keys.size(), 4);
+    }
+
+    std::unique_ptr<ConnectionPool> mPool;
+};
+
+TEST_F(TestConnectionPool, Open_SwitchesToWal)
+{
+    init(2);
+
+    auto rows = mPool->select("pragma_journal_mode", "journal_mode", {});
+    ASSERT_EQ(rows.size(), 1);
+    EXPECT_EQ(rows[0][0].value(), "wal");
+}
+
+TEST_F(TestConnectionPool, ParallelReadsAndWrites_Works)
+{
+    init(4);
+    defaultFillTable();
+
+    std::vector<std::thread> threads;
+    for (auto t = 0; t < 4; ++t)
+    {
+        threads.emplace_back([&] {
+            for (auto i = 0; i < 50; ++i)
+            {
+                auto rows = mPool->select(TestTable, "string", KeyValues{{"number", 3}});
+                ASSERT_EQ(rows.size(), 1);
+                EXPECT_EQ(rows[0][0].value(), "three");
+            }
+        });
+    }
+    threads.emplace_back([&] {
+        for (auto i = 0; i < 50; ++i)
+        {
+            mPool->insert(TestTable, KeyValues{{"number", 100 + i}, {"string", "new"}}, false);
+        }
+    });
+
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+
+    EXPECT_EQ(mPool->count(TestTable, {}), 54);
+
+    auto stats = mPool->stats();
+    EXPECT_EQ(stats.readers, 4);
+    EXPECT_EQ(stats.readersInUse, 0);
+    EXPECT_GE(stats.acquisitions, 201);
+    EXPECT_GT(stats.utilization, 0.0);
+}
+
+TEST_F(TestConnectionPool, ReadsInsideTransaction_SeeUncommittedChanges)
+{
+    init(1);
+    defaultFillTable();
+
+    mPool->beginTransaction(true);
+    mPool->insert(TestTable, KeyValues{{"number", 4}, {"string", "four"}}, true);
+    EXPECT_EQ(mPool->count(TestTable, {}), 5);
+
+    // other threads read from the pool, and do not see the transaction yet
+    std::size_t otherCount = 0;
+    std::thread reader([&] { otherCount = mPool->count(TestTable, {}); });
+    reader.join();
+    EXPECT_EQ(otherCount, 4);
+
+    mPool->commitTransaction();
+    EXPECT_EQ(mPool->count(TestTable, {}), 5);
+}
+
+TEST_F(TestConnectionPool, CursorKeepsReaderCheckedOut)
+{
+    init(1);
+    defaultFillTable();
+
+    {
+        auto cursor = mPool->selectCursor(TestTable, {});
+        ASSERT_TRUE(cursor.next());
+        EXPECT_EQ(mPool->stats().readersInUse, 1);
+    }
+
+    EXPECT_EQ(mPool->stats().readersInUse, 0);
+}
+
+TEST_F(TestConnectionPool, FailedCommit_KeepsReadsInsideTransaction)
+{
+    init(1);
+
+    mPool->applySql("DROP TABLE IF EXISTS test_child;");
+    mPool->applySql("DROP TABLE IF EXISTS test_parent;");
+    mPool->applySql("CREATE TABLE test_parent (id INTEGER PRIMARY KEY);");
+    mPool->applySql("CREATE TABLE test_child (parent INTEGER REFERENCES test_parent(id) "
+                    "DEFERRABLE INITIALLY DEFERRED);");
+
+    // a deferred foreign key violation fails the commit, which leaves the transaction active
+    mPool->beginTransaction(true);
+    mPool->insert("test_child", KeyValues{{"parent", 5}}, true);
+    EXPECT_THROW(mPool->commitTransaction(), sqlite::sqlite_exception);
+
+    // reads of this thread still go to the writer, within the transaction
+    EXPECT_EQ(mPool->count("test_child", {}), 1);
+
+    mPool->insert("test_parent", KeyValues{{"id", 5}}, true);
+    mPool->commitTransaction();
+
+    std::size_t otherCount = 0;
+    std::thread reader([&] { otherCount = mPool->count("test_child", {}); });
+    reader.join();
+    EXPECT_EQ(otherCount, 1);
+
+    mPool->applySql("DROP TABLE test_child;");
+    mPool->applySql("DROP TABLE test_parent;");
+}
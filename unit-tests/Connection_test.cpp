@@ -1,8 +1,14 @@
 #include "Connection.hpp"
+#include "SqliteTraits.hpp"
+#include "Transaction.hpp"
 
 #include "gtest/gtest.h"
 
+#include <algorithm>
+#include <cstdio>
 #include <memory>
+#include <set>
+#include <sstream>
 #include <thread>
 #include <vector>
 
@@ -22,6 +28,8 @@ struct TestSqliteConcurrency : public Test
         config.flags        = sqlite::OpenFlags::READWRITE | sqlite::OpenFlags::CREATE;
         sqlite::database db = sqlite::database(DBPath, config);
 
+        // a test left in WAL mode must not change the locking behavior of the next ones
+        db << "PRAGMA journal_mode=DELETE;";
         db << "DROP TABLE IF EXISTS test_table;";
         db << "CREATE TABLE test_table (number INTEGER, string TEXT);";
     }
@@ -413,3 +421,1584 @@ TEST_F(TestSqliteConcurrency, MultipleConnections_StressTest_Works)
     t4.join();
     t5.join();
 }
+
+TEST_F(TestSqliteConcurrency, SingleConnection_StatementCache_ReusesStatements)
+{
+    init(1);
+    defaultFillTable();
+
+    auto before = mConnections[0]->statementCacheStats();
+    for (auto i = 0; i < 10; ++i)
+    {
+        EXPECT_EQ(mConnections[0]->count(TestTable, {}), 10);
+    }
+    auto after = mConnections[0]->statementCacheStats();
+
+    EXPECT_EQ(after.misses - before.misses, 1);
+    EXPECT_EQ(after.hits - before.hits, 9);
+    EXPECT_EQ(after.capacity, ConnectionOptions::kDefaultStatementCacheSize);
+}
+
+TEST_F(TestSqliteConcurrency, SingleConnection_StatementCache_EvictsLeastRecentlyUsed)
+{
+    ConnectionOptions options;
+    options.statementCacheSize = 2;
+    auto& connection           = mConnections.emplace_back(std::make_unique<Connection>(DBPath, options));
+    connection->open();
+    defaultFillTable();
+
+    EXPECT_EQ(connection->count(TestTable, {}), 10);
+    EXPECT_EQ(connection->count(TestTable, "string", {}), 10);
+    EXPECT_EQ(connection->sum(TestTable, "number", {}), 45.0);
+    EXPECT_EQ(connection->count(TestTable, {}), 10);
+
+    auto stats = connection->statementCacheStats();
+    EXPECT_EQ(stats.size, 2);
+    EXPECT_GE(stats.evictions, 1);
+}
+
+TEST_F(TestSqliteConcurrency, SingleConnection_StatementCacheDisabled_Works)
+{
+    ConnectionOptions options;
+    options.statementCacheSize = 0;
+    auto& connection           = mConnections.emplace_back(std::make_unique<Connection>(DBPath, options));
+    connection->open();
+    defaultFillTable();
+
+    EXPECT_EQ(connection->count(TestTable, {}), 10);
+    EXPECT_EQ(connection->count(TestTable, {}), 10);
+
+    auto stats = connection->statementCacheStats();
+    EXPECT_EQ(stats.size, 0);
+    EXPECT_EQ(stats.hits, 0);
+}
+
+TEST_F(TestSqliteConcurrency, SingleConnection_QuotedValues_Works)
+{
+    init(1);
+
+    const std::string value = "it's \"quoted\"";
+    mConnections[0]->insert(TestTable, KeyValues{{"number", 1}, {"string", value}}, false);
+    mConnections[0]->update(TestTable, {{"number", 2}}, {{"string", value}}, false);
+
+    auto rows = mConnections[0]->select(TestTable, {{"string", value}});
+    ASSERT_EQ(rows.size(), 1);
+    EXPECT_EQ(rows[0], (Row{"2", value}));
+
+    mConnections[0]->deleteRows(TestTable, {{"string", value}}, false);
+    EXPECT_EQ(mConnections[0]->count(TestTable, {}), 0);
+}
+
+TEST_F(TestSqliteConcurrency, SingleConnection_DifferentFilterValues_ReuseStatement)
+{
+    init(1);
+    defaultFillTable();
+
+    auto before = mConnections[0]->statementCacheStats();
+    for (auto i = 0; i < 10; ++i)
+    {
+        auto rows = mConnections[0]->select(TestTable, "number", {{"number", i}});
+        ASSERT_EQ(rows.size(), 1);
+        EXPECT_EQ(rows[0][0].value(), std::to_string(i));
+    }
+    auto after = mConnections[0]->statementCacheStats();
+
+    EXPECT_EQ(after.misses - before.misses, 1);
+    EXPECT_EQ(after.hits - before.hits, 9);
+}
+
+TEST_F(TestSqliteConcurrency, SingleConnection_TypedValues_Works)
+{
+    init(1);
+
+    const Blob blob{0x00, 0x01, 0xff};
+    mConnections[0]->insert(TestTable, KeyValues{{"number", 42}, {"string", "answer"}}, false);
+    mConnections[0]->insert(TestTable, KeyValues{{"number", 2.5}, {"string", blob}}, false);
+    mConnections[0]->insert(TestTable, KeyValues{{"number", true}, {"string", std::optional<std::string>{}}}, false);
+
+    auto rows = mConnections[0]->selectTyped(TestTable, {});
+    ASSERT_EQ(rows.size(), 3);
+    EXPECT_EQ(rows[0], (SqlRow{std::int64_t{42}, std::string{"answer"}}));
+    EXPECT_EQ(rows[1], (SqlRow{2.5, blob}));
+    EXPECT_EQ(rows[2], (SqlRow{std::int64_t{1}, nullptr}));
+
+    auto numbers = mConnections[0]->selectTyped(TestTable, "number", {{"number", 2.5}});
+    ASSERT_EQ(numbers.size(), 1);
+    EXPECT_EQ(numbers[0][0], SqlValue{2.5});
+
+    // the string-based API keeps returning SQLite's text representation
+    auto legacyRows = mConnections[0]->select(TestTable, {});
+    EXPECT_EQ(legacyRows[0], (Row{"42", "answer"}));
+    EXPECT_EQ(legacyRows[1][0], "2.5");
+    EXPECT_EQ(legacyRows[2], (Row{"1", std::nullopt}));
+}
+
+TEST_F(TestSqliteConcurrency, SingleConnection_SelectCursor_Works)
+{
+    init(1);
+    defaultFillTable();
+
+    std::int64_t sum = 0;
+    std::vector<std::string> strings;
+    for (const auto& row : mConnections[0]->selectCursor(TestTable, {}))
+    {
+        ASSERT_EQ(row.size(), 2);
+        sum += row.integer(0);
+        strings.emplace_back(row.text(1));
+    }
+
+    EXPECT_EQ(sum, 45);
+    ASSERT_EQ(strings.size(), 10);
+    EXPECT_EQ(strings[3], "three");
+
+    auto cursor = mConnections[0]->selectCursor(TestTable, "string", {{"number", 7}});
+    ASSERT_TRUE(cursor.next());
+    EXPECT_EQ(cursor.row()[0], std::optional<std::string_view>{"seven"});
+    EXPECT_FALSE(cursor.next());
+    EXPECT_TRUE(cursor.done());
+
+    // a moved-from cursor is done, like an empty one
+    auto source = mConnections[0]->selectCursor(TestTable, {});
+    auto moved  = std::move(source);
+    EXPECT_TRUE(source.done());
+    EXPECT_FALSE(source.next());
+    EXPECT_TRUE(source.begin() == source.end());
+    EXPECT_TRUE(moved.next());
+}
+
+TEST_F(TestSqliteConcurrency, MultipleConnections_SelectCursorStoppedEarly_ReleasesStatement)
+{
+    init(2);
+    defaultFillTable();
+
+    auto before = mConnections[0]->statementCacheStats();
+    {
+        auto count = 0;
+        for (const auto& row : mConnections[0]->selectCursor(TestTable, {}))
+        {
+            (void)row;
+            if (++count == 3)
+            {
+                break;
+            }
+        }
+    }
+    auto after = mConnections[0]->statementCacheStats();
+    EXPECT_EQ(after.size, before.size + 1);
+
+    // the reader no longer holds its read transaction, so another connection can write
+    mConnections[1]->deleteRows(TestTable, {}, false);
+    EXPECT_EQ(mConnections[0]->count(TestTable, {}), 0);
+}
+
+TEST_F(TestSqliteConcurrency, SingleConnection_SelectResultSet_Works)
+{
+    init(1);
+    defaultFillTable();
+    mConnections[0]->insert(TestTable, KeyValues{{"number", 10}, {"string", std::optional<std::string>{}}}, false);
+
+    ResultSet result;
+    mConnections[0]->select(result, TestTable, {});
+    ASSERT_EQ(result.size(), 11);
+    ASSERT_EQ(result.columns(), 2);
+    EXPECT_EQ(result[3].text(1), "three");
+    EXPECT_TRUE(result[10].isNull(1));
+    EXPECT_EQ(result[10][1], std::nullopt);
+    EXPECT_EQ(result.toRows(), mConnections[0]->select(TestTable, {}));
+
+    // an input range, for the standard algorithms
+    static_assert(
+        std::is_same_v<std::iterator_traits<ResultSet::Iterator>::iterator_category, std::input_iterator_tag>);
+    EXPECT_EQ(std::distance(result.begin(), result.end()), 11);
+    EXPECT_EQ(std::count_if(result.begin(), result.end(), [](const RowView& row) { return row.isNull(1); }), 1);
+    auto it = result.begin();
+    EXPECT_EQ((*it++).text(1), "zero");
+    EXPECT_EQ((*it).text(1), "one");
+
+    // refilling the same result set drops the previous rows
+    mConnections[0]->select(result, TestTable, "string", {{"number", 9}});
+    ASSERT_EQ(result.size(), 1);
+    ASSERT_EQ(result.columns(), 1);
+    EXPECT_EQ(result[0].toRow(), (Row{"nine"}));
+}
+
+TEST_F(TestSqliteConcurrency, SingleConnection_ThroughputOptions_Applied)
+{
+    // WAL mode persists in the DB file, so it is tried on a file of its own
+    const std::string walPath = "test_throughput_db.db";
+
+    {
+        Connection connection{walPath, ConnectionOptions::Throughput()};
+        ASSERT_TRUE(connection.open());
+
+        EXPECT_EQ(connection.select("pragma_journal_mode", "journal_mode", {})[0][0].value(), "wal");
+        EXPECT_EQ(connection.select("pragma_synchronous", "synchronous", {})[0][0].value(), "1");
+        EXPECT_EQ(connection.select("pragma_cache_size", "cache_size", {})[0][0].value(), "-65536");
+        EXPECT_EQ(connection.select("pragma_temp_store", "temp_store", {})[0][0].value(), "2");
+    }
+
+    for (const auto* suffix : {"", "-wal", "-shm"})
+    {
+        std::remove((walPath + suffix).c_str());
+    }
+}
+
+TEST_F(TestSqliteConcurrency, SingleConnection_ReadOnlyOptions_RejectWrites)
+{
+    init(1);
+    defaultFillTable();
+
+    auto& connection
+        = mConnections.emplace_back(std::make_unique<Connection>(DBPath, ConnectionOptions::ReadOnlyAnalytics()));
+    ASSERT_TRUE(connection->open());
+
+    EXPECT_EQ(connection->count(TestTable, {}), 10);
+    EXPECT_THROW(connection->insert(TestTable, KeyValues{{"number", 10}}, false), sqlite::sqlite_exception);
+
+    // the failed write gave the write mutex back
+    EXPECT_THROW(connection->update(TestTable, {{"number", 11}}, {}, false), sqlite::sqlite_exception);
+}
+
+TEST_F(TestSqliteConcurrency, SingleConnection_GroupCommit_BatchesConcurrentInserts)
+{
+    ConnectionOptions options;
+    options.groupCommit = GroupCommitOptions{16, std::chrono::milliseconds{5}};
+
+    auto& connection = mConnections.emplace_back(std::make_unique<Connection>(DBPath, options));
+    ASSERT_TRUE(connection->open());
+
+    const int threadCount      = 8;
+    const int insertsPerThread = 50;
+
+    std::vector<PrimaryKeys> keys(threadCount);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < threadCount; ++t)
+    {
+        threads.emplace_back([&, t] {
+            for (int i = 0; i < insertsPerThread; ++i)
+            {
+                const auto number = t * insertsPerThread + i;
+                keys[t].emplace_back(connection->insert(TestTable, KeyValues{{"number", number}}, false));
+            }
+        });
+    }
+
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+
+    std::set<PrimaryKey> distinctKeys;
+    for (const auto& threadKeys : keys)
+    {
+        distinctKeys.insert(threadKeys.cbegin(), threadKeys.cend());
+    }
+
+    EXPECT_EQ(distinctKeys.size(), threadCount * insertsPerThread);
+    EXPECT_EQ(connection->count(TestTable, {}), threadCount * insertsPerThread);
+
+    const auto stats = connection->groupCommitStats();
+    ASSERT_TRUE(stats.has_value());
+    EXPECT_EQ(stats->writes, threadCount * insertsPerThread);
+    EXPECT_LT(stats->batches, stats->writes);
+    EXPECT_GT(stats->maxBatchSize, 1u);
+}
+
+TEST_F(TestSqliteConcurrency, SingleConnection_GroupCommit_IsolatesFailures)
+{
+    ConnectionOptions options;
+    options.groupCommit = GroupCommitOptions{2, std::chrono::seconds{1}};
+
+    auto& connection = mConnections.emplace_back(std::make_unique<Connection>(DBPath, options));
+    ASSERT_TRUE(connection->open());
+
+    // both writes join the same batch, which is committed as soon as it is full
+    std::thread failing([&] {
+        EXPECT_THROW(connection->update("missing_table", KeyValues{{"number", 1}}, {}, false),
+                     sqlite::sqlite_exception);
+    });
+    std::thread succeeding([&] { EXPECT_GT(connection->insert(TestTable, KeyValues{{"number", 1}}, false), 0); });
+
+    failing.join();
+    succeeding.join();
+
+    EXPECT_EQ(connection->count(TestTable, {}), 1);
+    EXPECT_EQ(connection->groupCommitStats()->writes, 2);
+}
+
+TEST_F(TestSqliteConcurrency, SingleConnection_InsertManyRows_ReturnsAllKeysInOrder)
+{
+    init(1);
+
+    // more rows than fit in a single multi-row INSERT, at SQLite's default placeholder limit
+    const std::size_t rowCount = 40000;
+
+    Rows rows;
+    rows.reserve(rowCount);
+    for (std::size_t i = 0; i < rowCount; ++i)
+    {
+        rows.emplace_back(Row{std::to_string(i), std::nullopt});
+    }
+
+    auto keys = mConnections[0]->insert(TestTable, rows, false);
+    ASSERT_EQ(keys.size(), rowCount);
+    EXPECT_EQ(mConnections[0]->count(TestTable, {}), rowCount);
+
+    for (std::size_t i = 0; i < rowCount; i += 997)
+    {
+        auto selected = mConnections[0]->select(TestTable, "number", KeyValues{{"rowid", keys[i]}});
+        ASSERT_EQ(selected.size(), 1);
+        EXPECT_EQ(selected[0][0].value(), std::to_string(i));
+    }
+}
+
+TEST_F(TestSqliteConcurrency, SingleConnection_InsertRows_WithoutRowidTable)
+{
+    init(1);
+    auto& connection = *mConnections[0];
+    connection.applySql("DROP TABLE IF EXISTS without_rowid;");
+    connection.applySql("CREATE TABLE without_rowid (k TEXT PRIMARY KEY, v TEXT) WITHOUT ROWID;");
+
+    EXPECT_NO_THROW(connection.insert("without_rowid", Rows{{"a", "1"}, {"b", "2"}}, false));
+    EXPECT_EQ(connection.select("without_rowid", {}), (Rows{{"a", "1"}, {"b", "2"}}));
+
+    // a failing row undoes its chunk only
+    EXPECT_THROW(connection.insert("without_rowid", Rows{{"c", "3"}, {"a", "duplicate"}}, false),
+                 sqlite::sqlite_exception);
+    EXPECT_EQ(connection.count("without_rowid", {}), 2);
+}
+
+TEST_F(TestSqliteConcurrency, SingleConnection_InsertRowsInTransaction_RolledBack)
+{
+    init(1);
+    defaultFillTable();
+
+    mConnections[0]->beginTransaction(true);
+    auto keys = mConnections[0]->insert(TestTable, Rows{{"10", "ten"}, {"11", "eleven"}}, true);
+    EXPECT_EQ(keys.size(), 2);
+    EXPECT_EQ(mConnections[0]->count(TestTable, {}), 12);
+    mConnections[0]->rollbackTransaction();
+
+    EXPECT_EQ(mConnections[0]->count(TestTable, {}), 10);
+}
+
+TEST_F(TestSqliteConcurrency, SingleConnection_BulkLoadCsv_Works)
+{
+    init(1);
+
+    std::istringstream csv{"string,number\r\n"
+                           "zero,0\r\n"
+                           "\"one, uno\",1\r\n"
+                           "\"two\nlines \"\"quoted\"\"\",2\r\n"
+                           ",3\r\n"
+                           "\"\",4\r\n"
+                           "\r\n"
+                           "five,5"};
+
+    BulkLoadOptions options;
+    options.header         = true;
+    options.commitInterval = 2;
+
+    auto stats = mConnections[0]->bulkLoad(TestTable, csv, options);
+    EXPECT_EQ(stats.rows, 6);
+    EXPECT_EQ(stats.commits, 3);
+
+    auto rows = mConnections[0]->select(TestTable, {});
+    ASSERT_EQ(rows.size(), 6);
+    EXPECT_EQ(rows[0], (Row{"0", "zero"}));
+    EXPECT_EQ(rows[1], (Row{"1", "one, uno"}));
+    EXPECT_EQ(rows[2], (Row{"2", "two\nlines \"quoted\""}));
+    EXPECT_EQ(rows[3], (Row{"3", std::nullopt}));
+    EXPECT_EQ(rows[4], (Row{"4", ""}));
+    EXPECT_EQ(rows[5], (Row{"5", "five"}));
+}
+
+TEST_F(TestSqliteConcurrency, SingleConnection_BulkLoadTsv_ConflictPolicies)
+{
+    init(1);
+    mConnections[0]->applySql("CREATE UNIQUE INDEX test_table_number ON test_table(number);");
+    defaultFillTable();
+
+    BulkLoadOptions options;
+    options.delimiter = '\t';
+
+    std::istringstream aborted{"10\tten\n1\tuno\n"};
+    EXPECT_THROW(mConnections[0]->bulkLoad(TestTable, aborted, options), sqlite::sqlite_exception);
+    EXPECT_EQ(mConnections[0]->count(TestTable, {}), 10);
+
+    options.conflictPolicy = ConflictPolicy::Ignore;
+    std::istringstream ignored{"10\tten\n1\tuno\n"};
+    EXPECT_EQ(mConnections[0]->bulkLoad(TestTable, ignored, options).rows, 2);
+    EXPECT_EQ(mConnections[0]->select(TestTable, "string", KeyValues{{"number", 1}})[0][0].value(), "one");
+
+    options.conflictPolicy = ConflictPolicy::Replace;
+    std::istringstream replaced{"11\televen\n1\tuno\n"};
+    EXPECT_EQ(mConnections[0]->bulkLoad(TestTable, replaced, options).rows, 2);
+    EXPECT_EQ(mConnections[0]->select(TestTable, "string", KeyValues{{"number", 1}})[0][0].value(), "uno");
+    EXPECT_EQ(mConnections[0]->count(TestTable, {}), 12);
+}
+
+TEST_F(TestSqliteConcurrency, SingleConnection_BulkLoadMalformed_KeepsCommittedBatches)
+{
+    init(1);
+
+    BulkLoadOptions options;
+    options.columns        = {"number"};
+    options.commitInterval = 2;
+
+    std::istringstream csv{"0\n1\n2\n3,extra\n4\n"};
+    EXPECT_THROW(mConnections[0]->bulkLoad(TestTable, csv, options), std::runtime_error);
+    EXPECT_EQ(mConnections[0]->count(TestTable, {}), 2);
+
+    std::istringstream unterminated{"5\n\"6\n"};
+    EXPECT_THROW(mConnections[0]->bulkLoad(TestTable, unterminated, options), std::runtime_error);
+    EXPECT_EQ(mConnections[0]->count(TestTable, {}), 2);
+
+    // the connection is still usable for writes
+    EXPECT_GT(mConnections[0]->insert(TestTable, KeyValues{{"number", 7}}, false), 0);
+}
+
+TEST_F(TestSqliteConcurrency, SingleConnection_BulkLoadInTransaction_UsesSavepoints)
+{
+    init(1);
+
+    BulkLoadOptions options;
+    options.columns        = {"number"};
+    options.commitInterval = 2;
+
+    mConnections[0]->beginTransaction(true);
+
+    std::istringstream csv{"0\n1\n2\n"};
+    EXPECT_EQ(mConnections[0]->bulkLoad(TestTable, csv, options, true).rows, 3);
+
+    // a failed batch is undone alone, leaving the caller's transaction and earlier batches
+    std::istringstream malformed{"3\n4\n5\n6,extra\n"};
+    EXPECT_THROW(mConnections[0]->bulkLoad(TestTable, malformed, options, true), std::runtime_error);
+    EXPECT_EQ(mConnections[0]->count(TestTable, {}), 5);
+
+    mConnections[0]->rollbackTransaction();
+    EXPECT_EQ(mConnections[0]->count(TestTable, {}), 0);
+}
+
+TEST(LatencyHistogram, Percentiles_WithinBucketPrecision)
+{
+    LatencyHistogram histogram;
+    for (std::int64_t i = 1; i <= 1000; ++i)
+    {
+        histogram.record(std::chrono::microseconds{i});
+    }
+
+    const auto snapshot = histogram.snapshot();
+    EXPECT_EQ(snapshot.count, 1000);
+    EXPECT_EQ(snapshot.max, std::chrono::microseconds{1000});
+    EXPECT_EQ(snapshot.mean(), std::chrono::nanoseconds{500500});
+
+    for (auto percentile : {50.0, 90.0, 99.0})
+    {
+        const auto expected = std::chrono::microseconds{static_cast<std::int64_t>(percentile * 10)};
+        EXPECT_GE(snapshot.percentile(percentile), expected);
+        EXPECT_LE(snapshot.percentile(percentile), expected * 9 / 8);
+    }
+
+    EXPECT_EQ(snapshot.percentile(100.0), snapshot.max);
+
+    for (std::uint64_t value : {0ull, 7ull, 8ull, 1000ull, 123456789ull})
+    {
+        const auto index = LatencyHistogram::BucketIndex(value);
+        EXPECT_LE(LatencyHistogram::BucketLowerBound(index), value);
+        EXPECT_GT(LatencyHistogram::BucketLowerBound(index + 1), value);
+    }
+}
+
+TEST(ConnectionMetrics, Snapshot_SumsTheCountersOfThreads)
+{
+    using Operation = ConnectionMetrics::Operation;
+
+    // two metrics, so that each thread caches a shard of both
+    ConnectionMetrics metrics;
+    ConnectionMetrics other;
+
+    const auto record = [&metrics, &other] {
+        for (auto i = 0; i < 100; ++i)
+        {
+            ConnectionMetrics::Scope scope{metrics, Operation::Insert};
+            scope.rows(1);
+            ConnectionMetrics::Scope otherScope{other, Operation::Select};
+        }
+
+        try
+        {
+            ConnectionMetrics::Scope scope{metrics, Operation::Insert};
+            throw std::runtime_error{"failed insert"};
+        }
+        catch (const std::runtime_error&)
+        {
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (auto i = 0; i < 3; ++i)
+    {
+        threads.emplace_back(record);
+    }
+    record();
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+
+    const auto stats = metrics.snapshot();
+    EXPECT_EQ(stats[Operation::Insert].calls, 404);
+    EXPECT_EQ(stats[Operation::Insert].rows, 400);
+    EXPECT_EQ(stats[Operation::Insert].errors, 4);
+    EXPECT_EQ(stats[Operation::Insert].latency.buckets.size(), LatencyHistogram::kBucketCount);
+    EXPECT_EQ(stats[Operation::Select].calls, 0);
+    EXPECT_EQ(other.snapshot()[Operation::Select].calls, 400);
+}
+
+TEST_F(TestSqliteConcurrency, SingleConnection_Stats_CountOperations)
+{
+    init(1);
+    defaultFillTable();
+
+    auto& connection = *mConnections[0];
+    connection.update(TestTable, {{"string", "small"}}, {{"number", 1}}, false);
+    connection.deleteRows(TestTable, {{"number", 9}}, false);
+    auto rows = connection.select(TestTable, {});
+    EXPECT_THROW(connection.selectTyped("missing_table", {}), sqlite::sqlite_exception);
+
+    const auto stats = connection.stats();
+    using Operation  = ConnectionMetrics::Operation;
+
+    EXPECT_EQ(stats[Operation::InsertRows].calls, 1);
+    EXPECT_EQ(stats[Operation::InsertRows].rows, 10);
+    EXPECT_EQ(stats[Operation::Update].rows, 1);
+    EXPECT_EQ(stats[Operation::DeleteRows].rows, 1);
+    EXPECT_EQ(stats[Operation::Select].rows, 9);
+    EXPECT_EQ(stats[Operation::SelectTyped].calls, 1);
+    EXPECT_EQ(stats[Operation::SelectTyped].errors, 1);
+    EXPECT_EQ(stats[Operation::Insert].calls, 0);
+
+    const auto& latency = stats[Operation::Select].latency;
+    EXPECT_EQ(latency.count, 1);
+    EXPECT_GT(latency.max.count(), 0);
+    EXPECT_LE(latency.percentile(50), latency.max);
+
+    EXPECT_GT(stats.prepareTime.count(), 0);
+    EXPECT_GT(stats.bytesMaterialized, 0);
+    EXPECT_EQ(stats.writeLockWaits, 0);
+    EXPECT_EQ(stats.busyRetries, 0);
+}
+
+TEST_F(TestSqliteConcurrency, MultipleConnections_Stats_MeasureLockWaits)
+{
+    init(1);
+
+    // a write waiting for a transaction of another thread, on the same connection
+    mConnections[0]->beginTransaction(true);
+    std::thread writer([this] { mConnections[0]->insert(TestTable, KeyValues{{"number", 1}}, false); });
+    std::this_thread::sleep_for(kSleepBetweenIterations);
+    mConnections[0]->insert(TestTable, KeyValues{{"number", 0}}, true);
+    mConnections[0]->commitTransaction();
+    writer.join();
+
+    auto stats = mConnections[0]->stats();
+    EXPECT_EQ(stats.writeLockWaits, 1);
+    EXPECT_GE(stats.writeLockWaitTime, kSleepBetweenIterations);
+
+    // a write waiting for a transaction of another connection, until its busy timeout expires
+    ConnectionOptions options;
+    options.busyTimeout = std::chrono::milliseconds{50};
+    auto& other         = mConnections.emplace_back(std::make_unique<Connection>(DBPath, options));
+    ASSERT_TRUE(other->open());
+
+    mConnections[0]->beginTransaction(true);
+    mConnections[0]->insert(TestTable, KeyValues{{"number", 2}}, true);
+    EXPECT_THROW(other->insert(TestTable, KeyValues{{"number", 3}}, false), sqlite::sqlite_exception);
+    mConnections[0]->commitTransaction();
+
+    stats = other->stats();
+    EXPECT_GT(stats.busyRetries, 0);
+    EXPECT_GE(stats.busyWaitTime, std::chrono::milliseconds{40});
+    EXPECT_EQ(stats[ConnectionMetrics::Operation::Insert].errors, 1);
+}
+
+TEST_F(TestSqliteConcurrency, SingleConnection_Profiler_LogsSlowQueries)
+{
+    ConnectionOptions options;
+    options.profiler = ProfilerOptions{std::chrono::microseconds{0}, 4, true};
+
+    auto& connection = mConnections.emplace_back(std::make_unique<Connection>(DBPath, options));
+    ASSERT_TRUE(connection->open());
+
+    for (int i = 0; i < 10; ++i)
+    {
+        connection->insert(TestTable, KeyValues{{"number", i}}, false);
+    }
+
+    EXPECT_EQ(connection->select(TestTable, {{"number", 7}}).size(), 1);
+
+    // the log keeps the most recent statements, oldest first, with bound values expanded
+    auto entries = connection->slowQueries();
+    ASSERT_EQ(entries.size(), 4);
+    EXPECT_NE(entries.back().sql.find("7"), std::string::npos);
+    EXPECT_EQ(entries.back().sql.find("?"), std::string::npos);
+    EXPECT_GE(entries.back().fullScanSteps, 9);
+    EXPECT_GT(entries.back().vmSteps, 0);
+
+    auto stats = connection->profilerStats();
+    ASSERT_TRUE(stats);
+    EXPECT_GE(stats->statements, 11);
+    EXPECT_EQ(stats->slowStatements, stats->statements);
+    EXPECT_GE(stats->fullScanSteps, 9);
+
+    std::ostringstream dump;
+    connection->dumpSlowQueries(dump);
+    const auto lines = dump.str();
+    EXPECT_EQ(std::count(lines.cbegin(), lines.cend(), '\n'), 4);
+}
+
+TEST_F(TestSqliteConcurrency, SingleConnection_Profiler_SkipsFastQueries)
+{
+    ConnectionOptions options;
+    options.profiler = ProfilerOptions{std::chrono::seconds{10}, 4, true};
+
+    auto& connection = mConnections.emplace_back(std::make_unique<Connection>(DBPath, options));
+    ASSERT_TRUE(connection->open());
+
+    connection->insert(TestTable, KeyValues{{"number", 1}}, false);
+    connection->select(TestTable, {});
+
+    EXPECT_TRUE(connection->slowQueries().empty());
+    EXPECT_GE(connection->profilerStats()->statements, 2);
+    EXPECT_EQ(connection->profilerStats()->slowStatements, 0);
+
+    auto& unprofiled = mConnections.emplace_back(std::make_unique<Connection>(DBPath));
+    EXPECT_FALSE(unprofiled->profilerStats());
+    EXPECT_TRUE(unprofiled->slowQueries().empty());
+}
+
+TEST_F(TestSqliteConcurrency, SingleConnection_Aggregate_FusesAggregates)
+{
+    init(1);
+
+    Rows rows;
+    for (int i = 1; i <= 10; ++i)
+    {
+        rows.emplace_back(Row{std::to_string(i), i % 2 == 0 ? "even" : "odd"});
+    }
+    mConnections[0]->insert(TestTable, rows, false);
+    mConnections[0]->insert(TestTable, KeyValues{{"string", "even"}}, false);
+
+    auto result = mConnections[0]->aggregate(
+        TestTable, {Count(), Count("number"), Sum("number"), Avg("number"), Min("number"), Max("number")}, {});
+    ASSERT_EQ(result.size(), 6);
+    EXPECT_EQ(std::get<std::int64_t>(result[0]), 11);
+    EXPECT_EQ(std::get<std::int64_t>(result[1]), 10);
+    EXPECT_EQ(std::get<std::int64_t>(result[2]), 55);
+    EXPECT_EQ(std::get<double>(result[3]), 5.5);
+    EXPECT_EQ(std::get<std::int64_t>(result[4]), 1);
+    EXPECT_EQ(std::get<std::int64_t>(result[5]), 10);
+
+    // filtered out rows; aggregates of no values are NULL
+    result = mConnections[0]->aggregate(TestTable, {Count(), Sum("number")}, {{"number", 100}});
+    ASSERT_EQ(result.size(), 2);
+    EXPECT_EQ(std::get<std::int64_t>(result[0]), 0);
+    EXPECT_TRUE(IsNull(result[1]));
+
+    auto groups = mConnections[0]->aggregate(TestTable, {"string"}, {Count(), Sum("number")}, {});
+    ASSERT_EQ(groups.size(), 2);
+    EXPECT_EQ(groups[0], (SqlRow{std::string{"even"}, std::int64_t{6}, std::int64_t{30}}));
+    EXPECT_EQ(groups[1], (SqlRow{std::string{"odd"}, std::int64_t{5}, std::int64_t{25}}));
+
+    EXPECT_EQ(mConnections[0]->stats()[ConnectionMetrics::Operation::Aggregate].calls, 3);
+}
+
+TEST(Filter, CompilesToParameterizedSql)
+{
+    auto filter = Filter::GreaterEqual("number", 2) && Filter::Less("number", 8.5)
+                  && (Filter::In("string", {"a", "b"}) || !Filter::Like("string", "c%") || Filter::IsNull("string"));
+
+    auto sql = SqliteTraits::SqlSelectParameterized("t", "*", filter);
+    EXPECT_EQ(sql.sql, "SELECT * FROM t WHERE number>=? AND number<? AND (string IN (?, ?) OR NOT (string LIKE ?) OR "
+                       "string IS NULL);");
+    EXPECT_EQ(sql.params, (SqlRow{std::int64_t{2}, 8.5, std::string{"a"}, std::string{"b"}, std::string{"c%"}}));
+
+    // a KeyValues filter matches all rows when empty, and is neutral to AND
+    EXPECT_EQ(SqliteTraits::SqlDeleteParameterized("t", Filter::Equal(KeyValues{})).sql, "DELETE FROM t;");
+    auto count = SqliteTraits::SqlCountParameterized("t", "*", Filter::Equal({{"a", 1}}) && Filter::Equal(KeyValues{}));
+    EXPECT_EQ(count.sql, "SELECT COUNT(*) FROM t WHERE a=?;");
+}
+
+TEST_F(TestSqliteConcurrency, SingleConnection_Filter_Works)
+{
+    init(1);
+
+    Rows rows;
+    for (int i = 1; i <= 10; ++i)
+    {
+        rows.emplace_back(Row{std::to_string(i), "row" + std::to_string(i)});
+    }
+    mConnections[0]->insert(TestTable, rows, false);
+    mConnections[0]->insert(TestTable, KeyValues{{"number", 11}}, false);
+
+    auto& db = *mConnections[0];
+    EXPECT_EQ(db.count(TestTable, Filter::Between("number", 3, 6)), 4);
+    EXPECT_EQ(db.count(TestTable, Filter::In("number", std::vector<int>{})), 0);
+    EXPECT_EQ(db.count(TestTable, "string", Filter::NotEqual("number", 5)), 9);
+    EXPECT_EQ(db.count(TestTable, Filter::IsNotNull("string") && !Filter::Like("string", "ROW1%")), 8);
+    EXPECT_EQ(db.sum(TestTable, "number", Filter::Greater("number", 8) || Filter::LessEqual("number", 1)), 31.0);
+    EXPECT_EQ(db.average(TestTable, "number", Filter::In("number", {2, 4})), 3.0);
+
+    auto selected = db.select(TestTable, "string", Filter::Greater("number", 9));
+    ASSERT_EQ(selected.size(), 2);
+    EXPECT_EQ(selected[0][0], "row10");
+    EXPECT_FALSE(selected[1][0]);
+
+    db.update(TestTable, {{"string", "low"}}, Filter::Less("number", 4), false);
+    EXPECT_EQ(db.select(TestTable, Filter::Equal("string", "low")).size(), 3);
+
+    db.deleteRows(TestTable, Filter::IsNull("string") || Filter::Equal("string", "low"), false);
+    EXPECT_EQ(db.count(TestTable, {}), 7);
+}
+
+TEST_F(TestSqliteConcurrency, SingleConnection_Query_ProjectsOrdersAndLimits)
+{
+    init(1);
+
+    Rows rows;
+    for (int i = 1; i <= 10; ++i)
+    {
+        rows.emplace_back(Row{std::to_string(i), i % 2 == 0 ? "even" : "odd"});
+    }
+    mConnections[0]->insert(TestTable, rows, false);
+
+    QueryOptions options;
+    options.columns = {"string", "number"};
+    options.orderBy = {{"string", false}, {"number", true}};
+    options.limit   = 3;
+    options.offset  = 4;
+
+    auto result = mConnections[0]->query(TestTable, options, Filter::Greater("number", 1));
+    ASSERT_EQ(result.size(), 3);
+    EXPECT_EQ(result[0], (Row{"even", "2"}));
+    EXPECT_EQ(result[1], (Row{"odd", "9"}));
+    EXPECT_EQ(result[2], (Row{"odd", "7"}));
+
+    // an offset without a limit
+    options.limit.reset();
+    EXPECT_EQ(mConnections[0]->query(TestTable, options, Filter::All()).size(), 6);
+    EXPECT_EQ(mConnections[0]->stats()[ConnectionMetrics::Operation::Query].calls, 2);
+}
+
+TEST_F(TestSqliteConcurrency, SingleConnection_QueryPage_VisitsEveryRowOnce)
+{
+    init(1);
+
+    // duplicated keys, so that pages must break ties on the rowid
+    Rows rows;
+    for (int i = 0; i < 25; ++i)
+    {
+        rows.emplace_back(Row{std::to_string(i % 7), std::to_string(i)});
+    }
+    mConnections[0]->insert(TestTable, rows, false);
+
+    for (const auto* key : {"rowid", "number"})
+    {
+        for (const auto descending : {false, true})
+        {
+            PageOptions options;
+            options.key        = key;
+            options.descending = descending;
+            options.pageSize   = 10;
+            options.columns    = {"number", "string"};
+
+            std::vector<Row> visited;
+            std::optional<PageToken> after;
+            std::size_t pages = 0;
+            do
+            {
+                auto page = mConnections[0]->queryPage(TestTable, options, Filter::All(), after);
+                visited.insert(visited.end(), page.rows.cbegin(), page.rows.cend());
+                after = page.next;
+                ++pages;
+            } while (after);
+
+            EXPECT_EQ(pages, 3);
+            ASSERT_EQ(visited.size(), 25);
+            EXPECT_EQ(std::set<Row>(visited.cbegin(), visited.cend()).size(), 25);
+
+            // rows come in key order; for the rowid, that is the insertion order of the strings
+            const auto column = std::string{key} == "rowid" ? 1 : 0;
+            for (std::size_t i = 1; i < visited.size(); ++i)
+            {
+                const auto previous = std::stoi(*visited[i - 1][column]);
+                const auto current  = std::stoi(*visited[i][column]);
+                EXPECT_TRUE(descending ? previous >= current : previous <= current);
+            }
+        }
+    }
+
+    // a filter applies to every page
+    PageOptions options;
+    options.pageSize = 2;
+    auto page        = mConnections[0]->queryPage(TestTable, options, Filter::Equal("number", 3), std::nullopt);
+    ASSERT_TRUE(page.next);
+    page = mConnections[0]->queryPage(TestTable, options, Filter::Equal("number", 3), page.next);
+    EXPECT_EQ(page.rows.size(), 2);
+    EXPECT_FALSE(page.next);
+
+    options.pageSize = 0;
+    EXPECT_THROW(mConnections[0]->queryPage(TestTable, options, Filter::All(), std::nullopt), std::invalid_argument);
+}
+
+TEST(QueryPlan, ParseStep_RecognizesScansAndSearches)
+{
+    auto step = QueryPlan::ParseStep("SCAN t");
+    EXPECT_EQ(step.access, QueryPlan::Step::Access::Scan);
+    EXPECT_EQ(step.table, "t");
+    EXPECT_TRUE(step.index.empty());
+
+    step = QueryPlan::ParseStep("SEARCH t USING COVERING INDEX idx_t_a (a=? AND b>?)");
+    EXPECT_EQ(step.access, QueryPlan::Step::Access::Search);
+    EXPECT_EQ(step.index, "idx_t_a");
+    EXPECT_TRUE(step.coveringIndex);
+
+    step = QueryPlan::ParseStep("SEARCH t USING INTEGER PRIMARY KEY (rowid=?)");
+    EXPECT_EQ(step.index, "INTEGER PRIMARY KEY");
+
+    step = QueryPlan::ParseStep("SEARCH TABLE t USING AUTOMATIC COVERING INDEX (a=?)");
+    EXPECT_EQ(step.table, "t");
+    EXPECT_TRUE(step.automaticIndex);
+    EXPECT_TRUE(step.index.empty());
+
+    EXPECT_EQ(QueryPlan::ParseStep("USE TEMP B-TREE FOR ORDER BY").access, QueryPlan::Step::Access::Other);
+    EXPECT_EQ(QueryPlan::ParseStep("SCAN CONSTANT ROW").access, QueryPlan::Step::Access::Other);
+}
+
+TEST_F(TestSqliteConcurrency, SingleConnection_Explain_ReportsScanOrSearch)
+{
+    init(1);
+
+    auto plan = mConnections[0]->explain(TestTable, {{"number", 1}});
+    ASSERT_FALSE(plan.steps.empty());
+    EXPECT_TRUE(plan.fullScan());
+    EXPECT_EQ(plan.steps[0].table, TestTable);
+
+    mConnections[0]->applySql("CREATE INDEX test_table_number ON test_table(number);");
+    plan = mConnections[0]->explain(TestTable, Filter::Between("number", 1, 5));
+    ASSERT_FALSE(plan.steps.empty());
+    EXPECT_FALSE(plan.fullScan());
+    EXPECT_EQ(plan.steps[0].access, QueryPlan::Step::Access::Search);
+    EXPECT_EQ(plan.steps[0].index, "test_table_number");
+    EXPECT_NE(plan.toString().find("SEARCH"), std::string::npos);
+}
+
+TEST_F(TestSqliteConcurrency, SingleConnection_IndexAdvisor_RecommendsAndCreatesIndexes)
+{
+    ConnectionOptions options;
+    options.indexAdvisor = IndexAdvisorOptions{5};
+
+    auto& connection = mConnections.emplace_back(std::make_unique<Connection>(DBPath, options));
+    ASSERT_TRUE(connection->open());
+
+    for (int i = 0; i < 10; ++i)
+    {
+        connection->count(TestTable, "string", Filter::Greater("number", i) && Filter::Equal("string", "x"));
+        connection->deleteRows(TestTable, {{"string", "y"}}, false);
+    }
+
+    // below the threshold, and not filtered
+    for (int i = 0; i < 4; ++i)
+    {
+        connection->select(TestTable, {{"number", i}});
+    }
+    connection->count(TestTable, {});
+    EXPECT_TRUE(connection->tableExists(TestTable));
+
+    auto advice = connection->indexAdvice();
+    ASSERT_EQ(advice.size(), 2);
+    EXPECT_EQ(advice[0].fullScans, 10);
+    EXPECT_EQ(advice[1].fullScans, 10);
+
+    std::set<std::vector<std::string>> columns{advice[0].columns, advice[1].columns};
+    EXPECT_EQ(columns, (std::set<std::vector<std::string>>{{"string", "number"}, {"string"}}));
+
+    EXPECT_EQ(connection->createAdvisedIndexes(), 2);
+    EXPECT_FALSE(connection->explain(TestTable, {{"string", "y"}}).fullScan());
+
+    const auto filter = Filter::Greater("number", 1) && Filter::Equal("string", "x");
+    auto plan         = connection->explain(SqliteTraits::SqlCountParameterized(TestTable, "string", filter));
+    ASSERT_FALSE(plan.steps.empty());
+    EXPECT_FALSE(plan.fullScan());
+    EXPECT_TRUE(plan.steps[0].coveringIndex);
+    EXPECT_TRUE(connection->indexAdvice().empty());
+}
+
+struct TestNumber : Column<std::int64_t>
+{
+    static constexpr std::string_view kName = "number";
+};
+
+struct TestString : Column<std::optional<std::string>>
+{
+    static constexpr std::string_view kName = "string";
+};
+
+struct TestSchema : Table<TestSchema, TestNumber, TestString>
+{
+    static constexpr std::string_view kName = "test_table";
+};
+
+struct TestRecord
+{
+    std::int64_t number;
+    std::optional<std::string> string;
+};
+
+TEST(Table, GeneratesSqlAtCompileTime)
+{
+    static_assert(TestSchema::Text<TestSchema::Insert>().view()
+                  == "INSERT INTO test_table(number, string) VALUES (?, ?);");
+    static_assert(TestSchema::Text<TestSchema::Select<>>().view() == "SELECT number, string FROM test_table;");
+    static_assert(TestSchema::Text<TestSchema::Select<TestNumber, TestString>>().view()
+                  == "SELECT number, string FROM test_table WHERE number=? AND string=?;");
+    static_assert(TestSchema::Text<TestSchema::Update<Set<TestString>, Where<TestNumber>>>().view()
+                  == "UPDATE test_table SET string=? WHERE number=?;");
+    static_assert(TestSchema::Text<TestSchema::Delete<TestNumber>>().view()
+                  == "DELETE FROM test_table WHERE number=?;");
+
+    // interned once
+    EXPECT_EQ(&TestSchema::Sql<TestSchema::Insert>(), &TestSchema::Sql<TestSchema::Insert>());
+}
+
+TEST_F(TestSqliteConcurrency, SingleConnection_Table_MapsRowsToStructs)
+{
+    init(1);
+    auto& connection = *mConnections[0];
+
+    for (std::int64_t i = 1; i <= 5; ++i)
+    {
+        EXPECT_EQ(connection.insert<TestSchema>({i, i % 2 == 0 ? std::optional<std::string>{"even"} : std::nullopt}),
+                  i);
+    }
+
+    auto rows = connection.select<TestSchema>();
+    ASSERT_EQ(rows.size(), 5);
+    EXPECT_EQ(rows[1], (TestSchema::Row{2, "even"}));
+    EXPECT_EQ(rows[2], (TestSchema::Row{3, std::nullopt}));
+
+    EXPECT_EQ(connection.update<TestSchema>(Set<TestString>{"three"}, Where<TestNumber>{3}), 1);
+    auto records = connection.select<TestSchema, TestRecord>(Where<TestNumber>{3});
+    ASSERT_EQ(records.size(), 1);
+    EXPECT_EQ(records[0].number, 3);
+    EXPECT_EQ(records[0].string, "three");
+
+    // written through the typed layer, read back as text
+    EXPECT_EQ(connection.select(TestTable, {{"number", 3}}), (Rows{{"3", "three"}}));
+
+    EXPECT_EQ(connection.deleteRows<TestSchema>(Where<TestString>{"even"}), 2);
+    EXPECT_EQ(connection.count(TestTable, {}), 3);
+    EXPECT_EQ(connection.stats()[ConnectionMetrics::Operation::SelectTyped].calls, 2);
+}
+
+struct TestEntry
+{
+    std::optional<std::string> label;
+    double number{0};
+};
+
+template<>
+struct sqlite_wrapper::RowMapping<TestEntry>
+{
+    static constexpr auto kFields = std::make_tuple(Field{"string", &TestEntry::label},
+                                                    Field{"number", &TestEntry::number});
+};
+
+TEST_F(TestSqliteConcurrency, SingleConnection_RowMapping_InsertsAndSelectsStructs)
+{
+    init(1);
+    auto& connection = *mConnections[0];
+
+    std::vector<TestEntry> entries;
+    for (int i = 1; i <= 4; ++i)
+    {
+        entries.push_back({i % 2 == 0 ? std::optional<std::string>{"even"} : std::nullopt, i * 1.5});
+    }
+
+    EXPECT_EQ(connection.insert(TestTable, entries), (PrimaryKeys{1, 2, 3, 4}));
+    EXPECT_EQ(connection.select(TestTable, {{"number", 3}}), (Rows{{"3", "even"}}));
+
+    auto all = connection.select<TestEntry>(TestTable);
+    ASSERT_EQ(all.size(), 4);
+    EXPECT_FALSE(all[0].label);
+    EXPECT_EQ(all[0].number, 1.5);
+    EXPECT_EQ(all[3].label, "even");
+
+    const auto filter = Filter::Equal("string", "even") && Filter::Greater("number", 4);
+    auto even         = connection.select<TestEntry>(TestTable, filter);
+    ASSERT_EQ(even.size(), 1);
+    EXPECT_EQ(even[0].number, 6);
+
+    // a failing row rolls back the whole insert
+    connection.applySql("CREATE UNIQUE INDEX unique_number ON test_table(number);");
+    const std::vector<TestEntry> conflicting{{"new", 7}, {"again", 6}};
+    EXPECT_THROW(connection.insert(TestTable, conflicting), sqlite::sqlite_exception);
+    EXPECT_EQ(connection.count(TestTable, {}), 4);
+}
+
+TEST_F(TestSqliteConcurrency, SingleConnection_ResultCache_InvalidatesOnWrites)
+{
+    ConnectionOptions options;
+    options.resultCache = ResultCacheOptions{};
+
+    auto& connection = mConnections.emplace_back(std::make_unique<Connection>(DBPath, options));
+    ASSERT_TRUE(connection->open());
+
+    connection->insert(TestTable, {{"number", 1}, {"string", "a"}}, false);
+
+    EXPECT_EQ(connection->select(TestTable, {{"number", 1}}), (Rows{{"1", "a"}}));
+    EXPECT_EQ(connection->select(TestTable, {{"number", 1}}), (Rows{{"1", "a"}}));
+    EXPECT_EQ(connection->count(TestTable, {}), 1);
+    EXPECT_EQ(connection->count(TestTable, {}), 1);
+
+    auto stats = connection->resultCacheStats();
+    ASSERT_TRUE(stats);
+    EXPECT_EQ(stats->hits, 2);
+    EXPECT_EQ(stats->misses, 2);
+    EXPECT_EQ(stats->entries, 2);
+    EXPECT_GT(stats->bytes, 0);
+    EXPECT_DOUBLE_EQ(stats->hitRatio(), 0.5);
+
+    // a write through this connection, reported by the update hook
+    connection->update(TestTable, {{"string", "b"}}, {{"number", 1}}, false);
+    EXPECT_EQ(connection->select(TestTable, {{"number", 1}}), (Rows{{"1", "b"}}));
+
+    // a write by another connection, detected through PRAGMA data_version
+    Connection other{DBPath};
+    ASSERT_TRUE(other.open());
+    other.insert(TestTable, {{"number", 2}}, false);
+    EXPECT_EQ(connection->count(TestTable, {}), 2);
+
+    // a rolled back write
+    connection->beginTransaction(false);
+    connection->insert(TestTable, {{"number", 3}}, true);
+    EXPECT_EQ(connection->count(TestTable, {}), 3);
+    connection->rollbackTransaction();
+    EXPECT_EQ(connection->count(TestTable, {}), 2);
+
+    // deleting every row
+    connection->deleteRows(TestTable, {}, false);
+    EXPECT_EQ(connection->count(TestTable, {}), 0);
+
+    stats = connection->resultCacheStats();
+    EXPECT_EQ(stats->hits, 2);
+    EXPECT_EQ(stats->invalidations, 5);
+}
+
+TEST_F(TestSqliteConcurrency, SingleConnection_ResultCache_MatchesTableSpellings)
+{
+    ConnectionOptions options;
+    options.resultCache = ResultCacheOptions{};
+
+    auto& connection = mConnections.emplace_back(std::make_unique<Connection>(DBPath, options));
+    ASSERT_TRUE(connection->open());
+
+    connection->insert(TestTable, {{"number", 1}}, false);
+
+    const std::vector<std::string> spellings{"TEST_TABLE", "main.test_table", "\"Test_Table\"", "[main].`test_table`"};
+    for (const auto& table : spellings)
+    {
+        EXPECT_EQ(connection->count(table, {}), 1);
+    }
+
+    // the update hook reports the write on test_table, which all spellings name
+    connection->insert(TestTable, {{"number", 2}}, false);
+    for (const auto& table : spellings)
+    {
+        EXPECT_EQ(connection->count(table, {}), 2) << table;
+    }
+}
+
+TEST(ResultCache, TableKey_FoldsCaseAndStripsQuotesAndSchema)
+{
+    EXPECT_EQ(ResultCache::TableKey("Users"), "users");
+    EXPECT_EQ(ResultCache::TableKey("main.users"), "users");
+    EXPECT_EQ(ResultCache::TableKey("\"main\".\"Users\""), "users");
+    EXPECT_EQ(ResultCache::TableKey("[temp].[Users]"), "users");
+    EXPECT_EQ(ResultCache::TableKey("`Users`"), "users");
+    EXPECT_EQ(ResultCache::TableKey("\"my.table\""), "my.table");
+    EXPECT_EQ(ResultCache::TableKey("\"say \"\"hi\"\"\""), "say \"hi\"");
+}
+
+TEST_F(TestSqliteConcurrency, SingleConnection_ResultCache_EvictsLeastRecentlyUsed)
+{
+    ConnectionOptions options;
+    options.resultCache = ResultCacheOptions{1024, false};
+
+    auto& connection = mConnections.emplace_back(std::make_unique<Connection>(DBPath, options));
+    ASSERT_TRUE(connection->open());
+
+    for (int i = 0; i < 20; ++i)
+    {
+        connection->select(TestTable, {{"number", i}});
+    }
+
+    auto stats = connection->resultCacheStats();
+    EXPECT_GT(stats->evictions, 0);
+    EXPECT_LE(stats->bytes, 1024);
+    EXPECT_EQ(stats->entries + stats->evictions, 20);
+
+    // the most recent result is still cached
+    connection->select(TestTable, {{"number", 19}});
+    EXPECT_EQ(connection->resultCacheStats()->hits, 1);
+
+    connection->clearResultCache();
+    EXPECT_EQ(connection->resultCacheStats()->entries, 0);
+}
+
+TEST_F(TestSqliteConcurrency, SingleConnection_ChangeStream_StreamsCommittedChanges)
+{
+    using Operation = ChangeStream::Change::Operation;
+
+    ConnectionOptions options;
+    options.changeStream = ChangeStreamOptions{};
+
+    auto& connection = mConnections.emplace_back(std::make_unique<Connection>(DBPath, options));
+    ASSERT_TRUE(connection->open());
+
+    std::vector<ChangeStream::Change> received;
+    connection->subscribeChanges([&received](const ChangeStream::Change& change) { received.push_back(change); });
+
+    const auto first = connection->insert(TestTable, {{"number", 1}}, false);
+    connection->insert(TestTable, {{"number", 2}}, false);
+    connection->update(TestTable, {{"string", "a"}}, {{"number", 1}}, false);
+
+    // a rolled back transaction streams nothing
+    connection->beginTransaction(false);
+    connection->insert(TestTable, {{"number", 3}}, true);
+    connection->rollbackTransaction();
+
+    // deleting every row streams each of them
+    connection->deleteRows(TestTable, {}, false);
+
+    auto poll = connection->pollChanges(0);
+    EXPECT_FALSE(poll.missed);
+    ASSERT_EQ(poll.changes.size(), 5);
+    EXPECT_EQ(poll.changes[0].operation, Operation::Insert);
+    EXPECT_EQ(poll.changes[0].table, TestTable);
+    EXPECT_EQ(poll.changes[0].rowid, first);
+    EXPECT_EQ(poll.changes[2].operation, Operation::Update);
+    EXPECT_EQ(poll.changes[2].rowid, first);
+    EXPECT_EQ(poll.changes[3].operation, Operation::Delete);
+    EXPECT_EQ(poll.changes[4].operation, Operation::Delete);
+    EXPECT_EQ(poll.changes[3].commit, poll.changes[4].commit);
+    EXPECT_EQ(poll.changes[4].sequence, 5);
+
+    ASSERT_EQ(received.size(), 5);
+    EXPECT_EQ(received.back().sequence, 5);
+
+    // resuming from a sequence number
+    poll = connection->pollChanges(3, 1);
+    ASSERT_EQ(poll.changes.size(), 1);
+    EXPECT_EQ(poll.changes[0].sequence, 4);
+    EXPECT_TRUE(connection->pollChanges(5).changes.empty());
+
+    std::vector<std::uint64_t> replayed;
+    const auto id = connection->subscribeChanges(
+        [&replayed](const ChangeStream::Change& change) { replayed.push_back(change.sequence); }, 3);
+    EXPECT_EQ(replayed, (std::vector<std::uint64_t>{4, 5}));
+
+    connection->unsubscribeChanges(id);
+    connection->insert(TestTable, {{"number", 4}}, false);
+    EXPECT_EQ(replayed.size(), 2);
+    EXPECT_EQ(received.size(), 6);
+}
+
+TEST_F(TestSqliteConcurrency, SingleConnection_ChangeStream_ReportsMissedChanges)
+{
+    ConnectionOptions options;
+    options.changeStream = ChangeStreamOptions{2};
+
+    auto& connection = mConnections.emplace_back(std::make_unique<Connection>(DBPath, options));
+    ASSERT_TRUE(connection->open());
+
+    Rows rows(5, Row{"1", "a"});
+    connection->insert(TestTable, rows, false);
+
+    auto poll = connection->pollChanges(1);
+    EXPECT_TRUE(poll.missed);
+    ASSERT_EQ(poll.changes.size(), 2);
+    EXPECT_EQ(poll.changes[0].sequence, 4);
+
+    poll = connection->pollChanges(3);
+    EXPECT_FALSE(poll.missed);
+    EXPECT_EQ(poll.changes.size(), 2);
+
+    Connection plain{DBPath};
+    ASSERT_TRUE(plain.open());
+    EXPECT_TRUE(plain.pollChanges(0).changes.empty());
+    EXPECT_THROW(plain.subscribeChanges([](const ChangeStream::Change&) {}), std::runtime_error);
+}
+
+TEST(ChangeStream, Settle_PublishesOnlySuccessfulCommits)
+{
+    ChangeStream stream{ChangeStreamOptions{}};
+
+    std::size_t received = 0;
+    stream.subscribe([&received](const ChangeStream::Change&) { ++received; }, 0);
+
+    // a commit that fails after the commit hook staged the changes leaves them pending
+    stream.record(SQLITE_INSERT, "test_table", 1);
+    stream.commit();
+    stream.settle(false);
+    EXPECT_TRUE(stream.poll(0).changes.empty());
+    EXPECT_EQ(stream.savepoint(), 1);
+
+    stream.record(SQLITE_UPDATE, "test_table", 1);
+    stream.commit();
+    stream.settle(true);
+    EXPECT_EQ(stream.poll(0).changes.size(), 2);
+    EXPECT_EQ(stream.lastSequence(), 2);
+    EXPECT_EQ(received, 2);
+
+    // a rollback drops the staged changes too
+    stream.record(SQLITE_DELETE, "test_table", 1);
+    stream.commit();
+    stream.rollback();
+    stream.settle(true);
+    EXPECT_EQ(stream.lastSequence(), 2);
+}
+
+TEST_F(TestSqliteConcurrency, MultipleConnections_ChangeStream_PublishesOnlySuccessfulCommits)
+{
+    ConnectionOptions options;
+    options.busyTimeout  = std::chrono::milliseconds{50};
+    options.changeStream = ChangeStreamOptions{};
+
+    auto& connection = mConnections.emplace_back(std::make_unique<Connection>(DBPath, options));
+    ASSERT_TRUE(connection->open());
+
+    std::vector<ChangeStream::Change> received;
+    connection->subscribeChanges([&received](const ChangeStream::Change& change) { received.push_back(change); });
+
+    Connection reader{DBPath, options};
+    ASSERT_TRUE(reader.open());
+
+    {
+        // a read transaction of another connection keeps a shared lock, so that, with a rollback journal,
+        // COMMIT cannot take the exclusive lock and fails with SQLITE_BUSY, leaving the transaction active
+        Transaction read{reader, TransactionMode::Deferred};
+        EXPECT_EQ(reader.count(TestTable, {}), 0);
+
+        connection->beginTransaction(false);
+        connection->insert(TestTable, {{"number", 1}}, true);
+        EXPECT_THROW(connection->commitTransaction(), BusyTimeoutError);
+        EXPECT_TRUE(connection->pollChanges(0).changes.empty());
+        EXPECT_TRUE(received.empty());
+    }
+
+    // the changes of the failed commit are published by the one that succeeds
+    connection->commitTransaction();
+    auto poll = connection->pollChanges(0);
+    ASSERT_EQ(poll.changes.size(), 1);
+    EXPECT_EQ(poll.changes[0].sequence, 1);
+    EXPECT_EQ(received.size(), 1);
+
+    {
+        // the failed commit of a write outside of a transaction rolls it back
+        Transaction read{reader, TransactionMode::Deferred};
+        EXPECT_EQ(reader.count(TestTable, {}), 1);
+
+        EXPECT_THROW(connection->insert(TestTable, {{"number", 2}}, false), BusyTimeoutError);
+        EXPECT_EQ(connection->pollChanges(1).changes.size(), 0);
+    }
+
+    connection->insert(TestTable, {{"number", 3}}, false);
+    poll = connection->pollChanges(1);
+    ASSERT_EQ(poll.changes.size(), 1);
+    EXPECT_EQ(poll.changes[0].sequence, 2);
+    EXPECT_EQ(received.size(), 2);
+    EXPECT_EQ(connection->count(TestTable, {}), 2);
+}
+
+TEST_F(TestSqliteConcurrency, SingleConnection_TypedDeleteAll_KeepsCacheAndStreamInformed)
+{
+    using Operation = ChangeStream::Change::Operation;
+
+    ConnectionOptions options;
+    options.resultCache  = ResultCacheOptions{};
+    options.changeStream = ChangeStreamOptions{};
+
+    auto& connection = mConnections.emplace_back(std::make_unique<Connection>(DBPath, options));
+    ASSERT_TRUE(connection->open());
+
+    connection->insert<TestSchema>({1, "a"});
+    connection->insert<TestSchema>({2, "b"});
+    EXPECT_EQ(connection->count(TestTable, {}), 2);
+
+    // an empty Where deletes every row, which SQLite does without calling the update hook unless prevented
+    EXPECT_EQ(connection->deleteRows<TestSchema>(Where<>{}), 2);
+    EXPECT_EQ(connection->count(TestTable, {}), 0);
+
+    const auto poll = connection->pollChanges(0);
+    ASSERT_EQ(poll.changes.size(), 4);
+    EXPECT_EQ(poll.changes[2].operation, Operation::Delete);
+    EXPECT_EQ(poll.changes[3].operation, Operation::Delete);
+    EXPECT_EQ(poll.changes[2].commit, poll.changes[3].commit);
+}
+
+TEST_F(TestSqliteConcurrency, SingleConnection_Transaction_RollsBackOnUnwind)
+{
+    init(1);
+    auto& connection = *mConnections[0];
+
+    EXPECT_THROW(
+        {
+            Transaction transaction{connection};
+            connection.insert(TestTable, {{"number", 1}}, true);
+            throw std::runtime_error("failure");
+        },
+        std::runtime_error);
+
+    // the write access was given back
+    connection.insert(TestTable, {{"number", 2}}, false);
+    EXPECT_EQ(connection.select(TestTable, {}), (Rows{{"2", std::nullopt}}));
+
+    {
+        Transaction transaction{connection, TransactionMode::Deferred};
+        connection.insert(TestTable, {{"number", 3}}, true);
+        EXPECT_TRUE(transaction.active());
+        transaction.commit();
+        EXPECT_FALSE(transaction.active());
+    }
+
+    EXPECT_EQ(connection.count(TestTable, {}), 2);
+}
+
+TEST_F(TestSqliteConcurrency, SingleConnection_Transaction_NestsSavepoints)
+{
+    init(1);
+    auto& connection = *mConnections[0];
+
+    Transaction transaction{connection};
+    connection.insert(TestTable, {{"number", 1}}, true);
+    {
+        auto outer = transaction.savepoint();
+        connection.insert(TestTable, {{"number", 2}}, true);
+        {
+            auto inner = transaction.savepoint();
+            EXPECT_NE(inner.name(), outer.name());
+            connection.insert(TestTable, {{"number", 3}}, true);
+            // rolled back on destruction
+        }
+
+        outer.release();
+    }
+
+    {
+        auto discarded = transaction.savepoint();
+        connection.insert(TestTable, {{"number", 4}}, true);
+        discarded.rollback();
+    }
+
+    transaction.commit();
+
+    EXPECT_EQ(connection.select(TestTable, "number", {}), (Rows{{"1"}, {"2"}}));
+    EXPECT_THROW(connection.savepoint("outside"), std::logic_error);
+
+    Transaction other{connection};
+    EXPECT_THROW(connection.savepoint("bad name"), std::invalid_argument);
+}
+
+TEST_F(TestSqliteConcurrency, MultipleConnections_Transaction_ImmediateTakesWriteLockUpFront)
+{
+    ConnectionOptions options;
+    options.busyTimeout = std::chrono::milliseconds{50};
+
+    Connection first{DBPath, options};
+    Connection second{DBPath, options};
+    ASSERT_TRUE(first.open());
+    ASSERT_TRUE(second.open());
+
+    {
+        // a deferred transaction only locks on its first write
+        Transaction transaction{first, TransactionMode::Deferred};
+        EXPECT_NO_THROW(second.insert(TestTable, {{"number", 1}}, false));
+    }
+
+    Transaction transaction{first, TransactionMode::Immediate};
+    EXPECT_THROW(second.insert(TestTable, {{"number", 2}}, false), sqlite::sqlite_exception);
+    EXPECT_THROW(Transaction(second, TransactionMode::Immediate), sqlite::sqlite_exception);
+
+    // the failed begin gave the write access back
+    transaction.commit();
+    EXPECT_NO_THROW(second.insert(TestTable, {{"number", 3}}, false));
+    EXPECT_EQ(second.count(TestTable, {}), 2);
+}
+
+TEST_F(TestSqliteConcurrency, MultipleConnections_BusyPolicy_GivesUpWithinBudgetAndDeadline)
+{
+    using Operation = ConnectionMetrics::Operation;
+
+    ConnectionOptions options;
+    options.busyTimeout            = std::chrono::seconds{10};
+    options.busyBackoff.maxRetries = 3;
+
+    ConnectionOptions deadlineOptions;
+    deadlineOptions.busyTimeout = std::chrono::seconds{10};
+    deadlineOptions.busyBackoff.deadlines[Operation::BeginTransaction] = std::chrono::milliseconds{30};
+
+    Connection first{DBPath};
+    Connection second{DBPath, options};
+    Connection third{DBPath, deadlineOptions};
+    ASSERT_TRUE(first.open());
+    ASSERT_TRUE(second.open());
+    ASSERT_TRUE(third.open());
+
+    Transaction transaction{first, TransactionMode::Immediate};
+
+    // the retry budget is spent long before the timeout
+    try
+    {
+        second.insert(TestTable, {{"number", 1}}, false);
+        FAIL() << "the insert should have given up";
+    }
+    catch (const BusyTimeoutError& e)
+    {
+        EXPECT_EQ(e.wait().operation, Operation::Insert);
+        EXPECT_EQ(e.wait().retries, 3);
+        EXPECT_EQ(e.get_code(), SQLITE_BUSY);
+    }
+
+    // the operation's own deadline applies
+    try
+    {
+        Transaction other{third, TransactionMode::Immediate};
+        FAIL() << "the transaction should have given up";
+    }
+    catch (const BusyTimeoutError& e)
+    {
+        EXPECT_EQ(e.wait().operation, Operation::BeginTransaction);
+        EXPECT_GE(e.wait().elapsed, std::chrono::milliseconds{30});
+        EXPECT_LT(e.wait().elapsed, std::chrono::seconds{1});
+    }
+
+    auto stats = second.stats();
+    EXPECT_EQ(stats[Operation::Insert].busyEvents, 1);
+    EXPECT_EQ(stats[Operation::Insert].busyRetries, 3);
+    EXPECT_EQ(stats[Operation::Insert].busyTimeouts, 1);
+    EXPECT_EQ(stats.busyTimeouts, 1);
+
+    stats = third.stats();
+    EXPECT_EQ(stats[Operation::BeginTransaction].busyTimeouts, 1);
+    EXPECT_GE(stats[Operation::BeginTransaction].busyWaitTime, std::chrono::milliseconds{20});
+
+    // a custom policy, giving up at once
+    struct FailFast : BusyPolicy
+    {
+        std::optional<std::chrono::nanoseconds> delay(const BusyWait& wait) override
+        {
+            ++calls;
+            return wait.retries < 1 ? std::optional<std::chrono::nanoseconds>{std::chrono::milliseconds{1}}
+                                    : std::nullopt;
+        }
+
+        std::atomic<int> calls{0};
+    };
+
+    auto policy = std::make_shared<FailFast>();
+    ConnectionOptions failFast;
+    failFast.busyPolicy = policy;
+
+    Connection fourth{DBPath, failFast};
+    ASSERT_TRUE(fourth.open());
+    EXPECT_THROW(fourth.insert(TestTable, {{"number", 2}}, false), BusyTimeoutError);
+    EXPECT_EQ(policy->calls, 2);
+
+    transaction.commit();
+    EXPECT_NO_THROW(fourth.insert(TestTable, {{"number", 3}}, false));
+    EXPECT_EQ(fourth.count(TestTable, {}), 1);
+}
+
+TEST_F(TestSqliteConcurrency, MultipleConnections_BusyPolicy_ReportsTransactionStatements)
+{
+    using Operation = ConnectionMetrics::Operation;
+
+    ConnectionOptions options;
+    options.busyTimeout = std::chrono::milliseconds{30};
+
+    Connection first{DBPath};
+    Connection second{DBPath, options};
+    ASSERT_TRUE(first.open());
+    ASSERT_TRUE(second.open());
+
+    {
+        // SQL run as is, waiting for the write lock
+        Transaction transaction{first, TransactionMode::Immediate};
+        try
+        {
+            second.applySql("INSERT INTO test_table (number) VALUES (1);");
+            FAIL() << "applySql() should have given up";
+        }
+        catch (const BusyTimeoutError& e)
+        {
+            EXPECT_EQ(e.wait().operation, Operation::ApplySql);
+        }
+    }
+
+    {
+        // the commit of a bulk load batch, waiting for a reader to release its shared lock
+        Transaction transaction{first, TransactionMode::Deferred};
+        EXPECT_EQ(first.count(TestTable, {}), 0);
+
+        std::istringstream csv{"1\n2\n"};
+        BulkLoadOptions bulkOptions;
+        bulkOptions.columns = {"number"};
+        try
+        {
+            second.bulkLoad(TestTable, csv, bulkOptions);
+            FAIL() << "bulkLoad() should have given up";
+        }
+        catch (const BusyTimeoutError& e)
+        {
+            EXPECT_EQ(e.wait().operation, Operation::BulkLoad);
+        }
+    }
+
+    EXPECT_EQ(second.count(TestTable, {}), 0);
+}
+
+TEST_F(TestSqliteConcurrency, SingleConnection_Upsert_UpdatesConflictingRowsInPlace)
+{
+    init(1);
+    auto& connection = *mConnections[0];
+    connection.applySql("CREATE UNIQUE INDEX unique_number ON test_table(number);");
+
+    const std::vector<std::string> conflict{"number"};
+    const std::vector<std::string> update{"string"};
+
+    auto one = connection.upsert(TestTable, {{"number", 1}, {"string", "one"}}, conflict, update, false);
+    auto two = connection.upsert(TestTable, {{"number", 2}, {"string", "two"}}, conflict, update, false);
+
+    // the conflicting row keeps its rowid
+    EXPECT_EQ(connection.upsert(TestTable, {{"number", 1}, {"string", "uno"}}, conflict, update, false), one);
+
+    auto keys
+        = connection.upsert(TestTable, Rows{{"2", "dos"}, {"3", "tres"}, {"3", "three"}}, conflict, update, false);
+    ASSERT_EQ(keys.size(), 3);
+    EXPECT_EQ(keys[0], two);
+    EXPECT_EQ(keys[1], keys[2]);
+    EXPECT_NE(keys[1], one);
+
+    EXPECT_EQ(connection.select(TestTable, {}), (Rows{{"1", "uno"}, {"2", "dos"}, {"3", "three"}}));
+    EXPECT_EQ(connection.stats()[ConnectionMetrics::Operation::UpsertRows].rows, 3);
+
+    // within a transaction, rolled back with it
+    connection.beginTransaction(false);
+    connection.upsert(TestTable, Rows{{"1", "eins"}, {"4", "vier"}}, conflict, update, true);
+    connection.rollbackTransaction();
+    EXPECT_EQ(connection.count(TestTable, {}), 3);
+
+    EXPECT_THROW(connection.upsert(TestTable, {{"number", 1}}, conflict, {}, false), std::invalid_argument);
+}